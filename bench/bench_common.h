@@ -1,46 +1,211 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cctype>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <ctime>
 #include <format>
+#include <fstream>
 #include <limits>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <variant>
 #include <vector>
 
+#if defined(__APPLE__)
 #include <mach/mach.h>
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters per measured run, averaged. Linux only (perf_event_open);
+// `valid` is false elsewhere or when the kernel refuses, e.g. under a strict
+// kernel.perf_event_paranoid. The calling thread and threads it starts
+// after the first measure() are counted.
+struct BenchCounters {
+  double cycles = 0;
+  double instructions = 0;
+  double llc_misses = 0;
+  double branch_misses = 0;
+  bool valid = false;
+
+  double ipc() const { return cycles ? instructions / cycles : 0; }
+};
+
+// Wall time over the measured runs; warmup runs are discarded
+struct BenchStats {
+  double best = 0;
+  double median = 0;
+  double p90 = 0;
+  double p99 = 0;
+  size_t runs = 0;
+  std::vector<double> times;  // every measured run, sorted
+  BenchCounters counters;
+};
 
 struct BenchEntry {
   std::string name;
-  double seconds;
+  double seconds = 0;  // best run: what groups and tables compare
+  BenchStats stats;
+  double bytes = 0;  // moved per run, for GB/s (0: not reported)
+  double flops = 0;  // per run, for GFLOP/s (0: not reported)
+
+  BenchEntry(std::string name, double seconds)
+      : name(std::move(name)), seconds(seconds) {
+    stats.best = stats.median = stats.p90 = stats.p99 = seconds;
+  }
+  BenchEntry(std::string name, const BenchStats& stats)
+      : name(std::move(name)), seconds(stats.best), stats(stats) {}
+
+  double gbps() const { return bytes && seconds ? bytes / seconds / 1e9 : 0; }
+  double gflops() const { return flops && seconds ? flops / seconds / 1e9 : 0; }
 };
 
 using BenchGroup = std::pair<std::string, std::vector<BenchEntry>>;
 
-inline double measure(size_t iters, auto fn) {
+// Work done by every entry of a group (the same shapes for each library)
+inline void set_work(std::vector<BenchEntry>& entries, double bytes,
+                     double flops = 0) {
+  for (auto& e : entries) {
+    e.bytes = bytes;
+    e.flops = flops;
+  }
+}
+
+#if defined(__linux__)
+// Counters opened disabled on first use and toggled for the whole task with
+// prctl, so each run costs two syscalls outside its timed window
+class perf_counters {
+ public:
+  static perf_counters& instance() {
+    static perf_counters p;
+    return p;
+  }
+
+  bool valid() const { return valid_; }
+  void enable() { if (valid_) prctl(PR_TASK_PERF_EVENTS_ENABLE, 0, 0, 0, 0); }
+  void disable() { if (valid_) prctl(PR_TASK_PERF_EVENTS_DISABLE, 0, 0, 0, 0); }
+
+  std::array<uint64_t, 4> read() const {
+    std::array<uint64_t, 4> v{};
+    for (size_t i = 0; valid_ && i < 4; i++) {
+      if (::read(fds_[i], &v[i], sizeof(uint64_t)) != sizeof(uint64_t)) v[i] = 0;
+    }
+    return v;
+  }
+
+ private:
+  std::array<int, 4> fds_{-1, -1, -1, -1};
+  bool valid_ = false;
+
+  perf_counters() {
+    const uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES,
+                                PERF_COUNT_HW_INSTRUCTIONS,
+                                PERF_COUNT_HW_CACHE_MISSES,
+                                PERF_COUNT_HW_BRANCH_MISSES};
+    valid_ = true;
+    for (size_t i = 0; i < 4; i++) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+      valid_ = valid_ && fds_[i] >= 0;
+    }
+  }
+
+  ~perf_counters() {
+    for (int fd : fds_) if (fd >= 0) close(fd);
+  }
+};
+#endif
+
+inline BenchStats measure(size_t iters, auto fn) {
   // Warmup
   for (size_t i = 0; i < std::min(iters, size_t(10)); i++) fn();
 
-  double best = std::numeric_limits<double>::max();
+#if defined(__linux__)
+  auto& perf = perf_counters::instance();
+  auto before = perf.read();
+#endif
+  std::vector<double> times(iters);
   for (size_t i = 0; i < iters; i++) {
+#if defined(__linux__)
+    perf.enable();
+#endif
     auto t0 = std::chrono::high_resolution_clock::now();
     fn();
     auto t1 = std::chrono::high_resolution_clock::now();
-    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+#if defined(__linux__)
+    perf.disable();
+#endif
+    times[i] = std::chrono::duration<double>(t1 - t0).count();
+  }
+
+  BenchStats stats;
+  if (iters == 0) return stats;
+  std::ranges::sort(times);
+  // Nearest-rank percentiles
+  auto pct = [&](double p) {
+    auto rank = static_cast<size_t>(std::ceil(p * iters));
+    return times[std::clamp<size_t>(rank, 1, iters) - 1];
+  };
+  stats.best = times.front();
+  stats.median = pct(0.5);
+  stats.p90 = pct(0.9);
+  stats.p99 = pct(0.99);
+  stats.runs = iters;
+  stats.times = std::move(times);
+
+#if defined(__linux__)
+  if (perf.valid()) {
+    auto after = perf.read();
+    auto per_run = [&](size_t i) { return double(after[i] - before[i]) / iters; };
+    stats.counters = {per_run(0), per_run(1), per_run(2), per_run(3), true};
   }
-  return best;
+#endif
+  return stats;
 }
 
 inline double gflops_gemm(size_t M, size_t N, size_t K, double seconds) {
   return 2.0 * M * N * K / seconds / 1e9;
 }
 
+// High-water mark of the resident set
 inline size_t peak_rss_bytes() {
+#if defined(__APPLE__)
   mach_task_basic_info_data_t info;
   mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
   task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count);
-  return info.resident_size;
+  return info.resident_size_max;
+#elif defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.starts_with("VmHWM:")) return std::stoull(line.substr(6)) * 1024;
+  }
+  return 0;
+#else
+  return 0;
+#endif
 }
 
 inline void print_group(const BenchGroup& group, int name_width = 0) {
@@ -71,8 +236,24 @@ inline void print_group(const BenchGroup& group, int name_width = 0) {
                         ? std::format("{:>9.2f} us", e.seconds * 1e6)
                         : std::format("{:>9.2f} ms", e.seconds * 1e3);
 
-    std::printf("    %-*s %s %s %6.1fx\n", name_width, e.name.c_str(),
-                bar.c_str(), time_str.c_str(), ratio);
+    // Spread and throughput after the ratio, when known
+    std::string extra;
+    if (e.stats.runs > 1) {
+      extra += std::format("  p50 {:.2f} p99 {:.2f} us", e.stats.median * 1e6,
+                           e.stats.p99 * 1e6);
+    }
+    if (e.flops) extra += std::format("  {:.1f} GFLOP/s", e.gflops());
+    if (e.bytes) extra += std::format("  {:.1f} GB/s", e.gbps());
+
+    std::printf("    %-*s %s %s %6.1fx%s\n", name_width, e.name.c_str(),
+                bar.c_str(), time_str.c_str(), ratio, extra.c_str());
+
+    if (auto& c = e.stats.counters; c.valid) {
+      std::printf("    %-*s %.3g cycles  %.2f IPC  %.3g LLC misses  "
+                  "%.3g branch misses\n",
+                  name_width, "", c.cycles, c.ipc(), c.llc_misses,
+                  c.branch_misses);
+    }
   }
   std::puts("");
   std::fflush(stdout);
@@ -106,11 +287,17 @@ inline void print_bar_graphs(const std::vector<BenchGroup>& groups) {
 }
 
 inline void print_csv(const std::vector<BenchGroup>& groups) {
-  std::printf("benchmark,library,best_us\n");
+  // Columns after best_us are 0 when not measured
+  std::printf("benchmark,library,best_us,median_us,p90_us,p99_us,gbps,gflops,"
+              "cycles,instructions,llc_misses,branch_misses\n");
   for (auto& [title, entries] : groups) {
     for (auto& e : entries) {
-      std::printf("%s,%s,%.2f\n", title.c_str(), e.name.c_str(),
-                  e.seconds * 1e6);
+      auto& c = e.stats.counters;
+      std::printf("%s,%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.0f,%.0f,%.0f,%.0f\n",
+                  title.c_str(), e.name.c_str(), e.seconds * 1e6,
+                  e.stats.median * 1e6, e.stats.p90 * 1e6, e.stats.p99 * 1e6,
+                  e.gbps(), e.gflops(), c.cycles, c.instructions,
+                  c.llc_misses, c.branch_misses);
     }
   }
 }
@@ -207,3 +394,475 @@ inline void bench_sil(std::vector<BenchEntry>& entries, size_t iters,
     sil::use_mps();
   }
 }
+
+//-----------------------------------------------------------------------------
+// Result store and regression comparison
+//-----------------------------------------------------------------------------
+
+// --json out.json      write this run's results with host metadata. Each
+//                      program replaces its own entries, so the binaries of
+//                      `make run-micro` can share one file.
+// --compare base.json  report per-benchmark median deltas against a stored
+//                      run and exit with 1 when any is a regression
+// --threshold 5        percent slowdown that counts as a regression
+//
+// A delta is significant when a one-sided exact Mann-Whitney U test over
+// the runs of both sides gives p <= 0.05, so it takes at least 3 runs on
+// each side (all slower) before anything is flagged.
+
+struct BenchOptions {
+  OutputMode mode = OutputMode::bar;
+  std::string json;
+  std::string compare;
+  double threshold = 5.0;  // percent
+  double alpha = 0.05;
+};
+
+inline BenchOptions parse_bench_options(int argc, const char** argv) {
+  BenchOptions opts;
+  opts.mode = parse_output_mode(argc, argv);
+  for (int i = 1; i + 1 < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--json") opts.json = argv[++i];
+    else if (arg == "--compare") opts.compare = argv[++i];
+    else if (arg == "--threshold") opts.threshold = std::stod(argv[++i]);
+  }
+  return opts;
+}
+
+// Enough JSON to read back what write_json produces
+struct JsonValue {
+  using array_type = std::vector<JsonValue>;
+  using object_type = std::map<std::string, JsonValue>;
+  std::variant<std::nullptr_t, bool, double, std::string, array_type,
+               object_type>
+      value;
+
+  const JsonValue* get(const std::string& key) const {
+    auto* obj = std::get_if<object_type>(&value);
+    if (!obj) return nullptr;
+    auto it = obj->find(key);
+    return it != obj->end() ? &it->second : nullptr;
+  }
+  double number(const std::string& key, double fallback = 0) const {
+    auto* v = get(key);
+    auto* d = v ? std::get_if<double>(&v->value) : nullptr;
+    return d ? *d : fallback;
+  }
+  std::string string(const std::string& key) const {
+    auto* v = get(key);
+    auto* str = v ? std::get_if<std::string>(&v->value) : nullptr;
+    return str ? *str : std::string();
+  }
+  const array_type* array(const std::string& key) const {
+    auto* v = get(key);
+    return v ? std::get_if<array_type>(&v->value) : nullptr;
+  }
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const std::string& text) : s_(text) {}
+
+  JsonValue parse() {
+    auto v = value_();
+    ws_();
+    if (pos_ != s_.size()) fail_("trailing characters");
+    return v;
+  }
+
+ private:
+  const std::string& s_;
+  size_t pos_ = 0;
+
+  [[noreturn]] void fail_(const char* what) {
+    throw std::runtime_error(std::format("json: {} at offset {}", what, pos_));
+  }
+  void ws_() {
+    while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_])))
+      pos_++;
+  }
+  bool eat_(char c) {
+    ws_();
+    if (pos_ < s_.size() && s_[pos_] == c) return ++pos_, true;
+    return false;
+  }
+  void expect_(char c) {
+    if (!eat_(c)) fail_("unexpected character");
+  }
+  bool word_(const char* w) {
+    auto n = std::char_traits<char>::length(w);
+    if (s_.compare(pos_, n, w) != 0) return false;
+    pos_ += n;
+    return true;
+  }
+
+  std::string string_() {
+    expect_('"');
+    std::string out;
+    while (pos_ < s_.size() && s_[pos_] != '"') {
+      char c = s_[pos_++];
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ >= s_.size()) break;
+      switch (char e = s_[pos_++]) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u': {
+          if (pos_ + 4 > s_.size()) fail_("truncated escape");
+          auto code = std::stoul(s_.substr(pos_, 4), nullptr, 16);
+          pos_ += 4;
+          out += code < 0x80 ? static_cast<char>(code) : '?';
+          break;
+        }
+        default: out += e;
+      }
+    }
+    expect_('"');
+    return out;
+  }
+
+  JsonValue value_() {
+    ws_();
+    if (pos_ >= s_.size()) fail_("unexpected end");
+    char c = s_[pos_];
+    if (c == '{') {
+      pos_++;
+      JsonValue::object_type obj;
+      if (!eat_('}')) {
+        do {
+          auto key = string_();
+          expect_(':');
+          obj[key] = value_();
+        } while (eat_(','));
+        expect_('}');
+      }
+      return {std::move(obj)};
+    }
+    if (c == '[') {
+      pos_++;
+      JsonValue::array_type arr;
+      if (!eat_(']')) {
+        do arr.push_back(value_());
+        while (eat_(','));
+        expect_(']');
+      }
+      return {std::move(arr)};
+    }
+    if (c == '"') return {string_()};
+    if (word_("true")) return {true};
+    if (word_("false")) return {false};
+    if (word_("null")) return {nullptr};
+    size_t used = 0;
+    double d = 0;
+    try {
+      d = std::stod(s_.substr(pos_, 32), &used);
+    } catch (const std::exception&) {
+      fail_("invalid value");
+    }
+    pos_ += used;
+    return {d};
+  }
+};
+
+inline JsonValue read_json(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("json: cannot open '" + path + "'");
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return JsonParser(ss.str()).parse();
+}
+
+inline std::string json_escape(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out += std::format("\\u{:04x}", static_cast<int>(c));
+    } else {
+      out += c;
+    }
+  }
+  return out + '"';
+}
+
+// Compiler flags as the Makefile passes them, and the tree the run was made
+// from (`git describe`, so a dirty tree is marked)
+#ifndef BENCH_CXXFLAGS
+#define BENCH_CXXFLAGS ""
+#endif
+
+inline std::map<std::string, std::string> host_metadata() {
+  std::map<std::string, std::string> host;
+
+  std::string cpu;
+#if defined(__APPLE__)
+  char brand[256] = {};
+  size_t size = sizeof(brand);
+  if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0)
+    cpu = brand;
+#elif defined(__linux__)
+  std::ifstream info("/proc/cpuinfo");
+  for (std::string line; cpu.empty() && std::getline(info, line);) {
+    if (line.starts_with("model name")) {
+      auto pos = line.find(':');
+      if (pos != std::string::npos) cpu = line.substr(line.find_first_not_of(' ', pos + 1));
+    }
+  }
+#endif
+  host["cpu"] = cpu;
+  host["cores"] = std::to_string(std::thread::hardware_concurrency());
+  host["compiler"] = __VERSION__;
+  host["flags"] = BENCH_CXXFLAGS;
+
+  std::string commit;
+  if (auto* p = popen("git describe --always --dirty 2>/dev/null", "r")) {
+    char buf[128];
+    while (std::fgets(buf, sizeof(buf), p)) commit += buf;
+    pclose(p);
+  }
+  while (!commit.empty() && std::isspace(static_cast<unsigned char>(commit.back())))
+    commit.pop_back();
+  host["commit"] = commit;
+
+  char date[32] = {};
+  auto now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  host["date"] = date;
+  return host;
+}
+
+// Group titles that embed a measured figure ("sgemm 512x512 (812.3 GFLOPS)")
+// are matched without it
+inline std::string bench_key(const std::string& title) {
+  static const std::regex measured(R"([0-9.]+ GFLOPS)");
+  return std::regex_replace(title, measured, "GFLOPS");
+}
+
+// The program name a result belongs to: argv[0] without a leading "./"
+inline std::string bench_program(const char* argv0) {
+  std::string name = argv0;
+  if (name.starts_with("./")) name = name.substr(2);
+  return name;
+}
+
+inline std::string bench_entry_json(const std::string& program,
+                                    const std::string& title,
+                                    const BenchEntry& e) {
+  auto& st = e.stats;
+  auto& c = st.counters;
+  std::string samples;
+  for (auto t : st.times) {
+    samples += std::format("{}{:.3f}", samples.empty() ? "" : ", ", t * 1e6);
+  }
+  return std::format(
+      "{{\"program\": {}, \"benchmark\": {}, \"library\": {}, "
+      "\"best_us\": {:.3f}, \"median_us\": {:.3f}, \"p90_us\": {:.3f}, "
+      "\"p99_us\": {:.3f}, \"gbps\": {:.3f}, \"gflops\": {:.3f}, "
+      "\"cycles\": {:.0f}, \"instructions\": {:.0f}, "
+      "\"llc_misses\": {:.0f}, \"branch_misses\": {:.0f}, "
+      "\"samples_us\": [{}]}}",
+      json_escape(program), json_escape(title), json_escape(e.name),
+      e.seconds * 1e6, st.median * 1e6, st.p90 * 1e6, st.p99 * 1e6, e.gbps(),
+      e.gflops(), c.cycles, c.instructions, c.llc_misses, c.branch_misses,
+      samples);
+}
+
+// Writes `groups` under `program`, keeping other programs' entries already in
+// the file
+inline void write_json(const std::string& path, const std::string& program,
+                       const std::vector<BenchGroup>& groups) {
+  std::vector<std::string> rows;
+  if (std::ifstream(path).good()) {
+    auto old = read_json(path);
+    if (auto* benchmarks = old.array("benchmarks")) {
+      for (auto& b : *benchmarks) {
+        if (b.string("program") == program) continue;
+        std::vector<double> samples;
+        if (auto* arr = b.array("samples_us")) {
+          for (auto& v : *arr) {
+            if (auto* d = std::get_if<double>(&v.value)) samples.push_back(*d * 1e-6);
+          }
+        }
+        BenchStats st;
+        st.best = b.number("best_us") * 1e-6;
+        st.median = b.number("median_us") * 1e-6;
+        st.p90 = b.number("p90_us") * 1e-6;
+        st.p99 = b.number("p99_us") * 1e-6;
+        st.runs = samples.size();
+        st.times = std::move(samples);
+        st.counters = {b.number("cycles"), b.number("instructions"),
+                       b.number("llc_misses"), b.number("branch_misses"),
+                       b.number("cycles") != 0};
+        BenchEntry e(b.string("library"), st);
+        // Stored rates are per best run; recover the work they imply
+        e.bytes = b.number("gbps") * 1e9 * st.best;
+        e.flops = b.number("gflops") * 1e9 * st.best;
+        rows.push_back(bench_entry_json(b.string("program"),
+                                        b.string("benchmark"), e));
+      }
+    }
+  }
+  for (auto& [title, entries] : groups) {
+    for (auto& e : entries) rows.push_back(bench_entry_json(program, title, e));
+  }
+
+  std::string out = "{\n  \"schema\": 1,\n  \"host\": {";
+  bool first = true;
+  for (auto& [key, value] : host_metadata()) {
+    out += std::format("{}\n    {}: {}", first ? "" : ",", json_escape(key),
+                       json_escape(value));
+    first = false;
+  }
+  out += "\n  },\n  \"benchmarks\": [";
+  for (size_t i = 0; i < rows.size(); i++) {
+    out += std::format("{}\n    {}", i ? "," : "", rows[i]);
+  }
+  out += "\n  ]\n}\n";
+
+  std::ofstream file(path, std::ios::trunc);
+  if (!(file << out)) throw std::runtime_error("json: cannot write '" + path + "'");
+}
+
+// P(U <= u) for the Mann-Whitney U statistic of samples of n and m without
+// ties, exactly (counts of rank arrangements) up to 50 runs a side and by
+// the normal approximation beyond
+inline double mann_whitney_cdf(size_t n, size_t m, double u) {
+  if (n == 0 || m == 0) return 1.0;
+  if (n > 50 || m > 50) {
+    double mu = n * m / 2.0;
+    double sigma = std::sqrt(n * m * (n + m + 1) / 12.0);
+    return 0.5 * std::erfc(-(u + 0.5 - mu) / (sigma * std::sqrt(2.0)));
+  }
+  // ways[j][k]: orderings of j runs against mm runs with U = k, built up
+  // one run of the second sample at a time
+  size_t max_u = n * m;
+  std::vector<std::vector<double>> ways(n + 1, std::vector<double>(max_u + 1));
+  for (size_t j = 0; j <= n; j++) ways[j][0] = 1;
+  for (size_t mm = 1; mm <= m; mm++) {
+    for (size_t j = 1; j <= n; j++) {
+      // f(j, mm, k) = f(j - 1, mm, k - mm) + f(j, mm - 1, k)
+      for (size_t k = 0; k <= max_u; k++) {
+        if (k >= mm) ways[j][k] += ways[j - 1][k - mm];
+      }
+    }
+  }
+  auto& dist = ways[n];
+  double total = std::accumulate(dist.begin(), dist.end(), 0.0);
+  double below = 0;
+  for (size_t k = 0; k <= max_u && k <= u; k++) below += dist[k];
+  return below / total;
+}
+
+// One-sided p-value that `after` runs are slower than `before` runs
+inline double slower_p_value(const std::vector<double>& before,
+                             const std::vector<double>& after) {
+  // U counts pairs where the new run is the faster one (ties count half);
+  // a small U means consistently slower
+  double u = 0;
+  for (auto a : after) {
+    for (auto b : before) u += a < b ? 1.0 : a == b ? 0.5 : 0.0;
+  }
+  return mann_whitney_cdf(after.size(), before.size(), u);
+}
+
+// Compares `groups` with the baseline's entries for `program`; returns the
+// number of regressions
+inline size_t compare_json(const JsonValue& baseline, const std::string& program,
+                           const std::vector<BenchGroup>& groups,
+                           const BenchOptions& opts) {
+  struct Base {
+    double median;
+    std::vector<double> times;
+  };
+  std::map<std::pair<std::string, std::string>, Base> base;
+  if (auto* benchmarks = baseline.array("benchmarks")) {
+    for (auto& b : *benchmarks) {
+      if (b.string("program") != program) continue;
+      Base entry{b.number("median_us") * 1e-6, {}};
+      if (auto* arr = b.array("samples_us")) {
+        for (auto& v : *arr) {
+          if (auto* d = std::get_if<double>(&v.value)) entry.times.push_back(*d * 1e-6);
+        }
+      }
+      if (entry.times.empty()) entry.times.push_back(entry.median);
+      base[{bench_key(b.string("benchmark")), b.string("library")}] = entry;
+    }
+  }
+
+  auto* host = baseline.get("host");
+  auto now = host_metadata();
+  std::printf("\n─ compare %s ─────────────────────────────────────\n\n",
+              program.c_str());
+  if (host) {
+    std::printf("  baseline %s on %s\n", host->string("commit").c_str(),
+                host->string("cpu").c_str());
+    if (host->string("cpu") != now["cpu"] ||
+        host->string("flags") != now["flags"]) {
+      std::printf("  warning: baseline host or compiler flags differ\n");
+    }
+  }
+  std::printf("  regression: > %.1f%% slower with p <= %.2f\n\n",
+              opts.threshold, opts.alpha);
+
+  size_t regressions = 0;
+  for (auto& [title, entries] : groups) {
+    for (auto& e : entries) {
+      auto it = base.find({bench_key(title), e.name});
+      if (it == base.end()) {
+        std::printf("  %-40s %-10s  (new)\n", title.c_str(), e.name.c_str());
+        continue;
+      }
+      auto& b = it->second;
+      auto times = e.stats.times.empty() ? std::vector<double>{e.seconds}
+                                         : e.stats.times;
+      double median = e.stats.runs ? e.stats.median : e.seconds;
+      double delta = b.median ? (median / b.median - 1) * 100 : 0;
+      double p_slower = slower_p_value(b.times, times);
+      double p_faster = slower_p_value(times, b.times);
+
+      const char* verdict = "";
+      if (delta > opts.threshold && p_slower <= opts.alpha) {
+        verdict = "REGRESSION";
+        regressions++;
+      } else if (-delta > opts.threshold && p_faster <= opts.alpha) {
+        verdict = "faster";
+      } else if (std::abs(delta) > opts.threshold) {
+        verdict = "noise";
+      }
+      std::printf("  %-40s %-10s %10.2f -> %10.2f us %+7.1f%%  p=%.3f  %s\n",
+                  title.c_str(), e.name.c_str(), b.median * 1e6, median * 1e6,
+                  delta, delta > 0 ? p_slower : p_faster, verdict);
+    }
+  }
+  std::printf("\n  %zu regression%s\n", regressions,
+              regressions == 1 ? "" : "s");
+  std::fflush(stdout);
+  return regressions;
+}
+
+// Handles --json and --compare after a program's groups are done; the
+// result is main's exit code: 1 on a regression, 2 on an unreadable file
+inline int report_results(const std::vector<BenchGroup>& groups, int argc,
+                          const char** argv) {
+  auto program = bench_program(argv[0]);
+  try {
+    auto opts = parse_bench_options(argc, argv);
+    if (!opts.json.empty()) write_json(opts.json, program, groups);
+    if (!opts.compare.empty()) {
+      auto baseline = read_json(opts.compare);
+      if (compare_json(baseline, program, groups, opts)) return 1;
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 2;
+  }
+  return 0;
+}
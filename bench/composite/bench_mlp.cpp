@@ -163,4 +163,5 @@ int main(int argc, const char** argv) {
   bench_mlp(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "MLP Inference", "2-layer MLP (768->2048->768 with sigmoid) forward pass — same network as training benchmark");
+  return report_results(groups, argc, argv);
 }
@@ -199,4 +199,5 @@ int main(int argc, const char** argv) {
   bench_train(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "Training", "Full training step (forward + MSE loss + manual backward + SGD update) for a 2-layer MLP (768->2048->768, sigmoid)");
+  return report_results(groups, argc, argv);
 }
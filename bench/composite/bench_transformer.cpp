@@ -66,9 +66,7 @@ void bench_transformer(std::vector<BenchGroup>& groups, bool csv) {
           auto Q = h.linear(Wq, bq);
           auto K = h.linear(Wk, bk);
           auto V = h.linear(Wv, bv);
-          auto scores = Q.dot(K.transpose()) * scale;
-          auto attn = scores.softmax();
-          auto context = attn.dot(V);
+          auto context = sil::scaled_dot_product_attention(Q, K, V, {}, scale);
           auto attn_out = context.linear(Wo, bo);
           auto r1 = x + attn_out;
           auto h2 = r1.layer_norm(gamma2, beta2);
@@ -331,6 +329,61 @@ void bench_transformer(std::vector<BenchGroup>& groups, bool csv) {
   }
 }
 
+// Token-by-token decode of the attention step: project one token, extend
+// K/V, attend over the whole prefix. "copy" rebuilds (t, d) K/V arrays each
+// step; "kv_cache" appends into preallocated storage.
+void bench_decode(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("decode (single-head attention, CPU)");
+
+  constexpr size_t steps = 256;
+  for (size_t d_model : {512, 1024}) {
+    std::vector<BenchEntry> entries;
+    auto scale = 1.0f / sqrtf(static_cast<float>(d_model));
+    auto x = sil::random({steps, d_model});
+    auto Wq = sil::random({d_model, d_model}) * scale;
+    auto Wk = sil::random({d_model, d_model}) * scale;
+    auto Wv = sil::random({d_model, d_model}) * scale;
+
+    sil::use_cpu();
+    entries.push_back({"sil-copy", measure(3, [&] {
+      auto K = sil::array<float>();
+      auto V = sil::array<float>();
+      for (size_t t = 0; t < steps; t++) {
+        auto h = x.rows(t, t + 1);
+        auto k = h.dot(Wk), v = h.dot(Wv);
+        auto K2 = sil::array<float>({t + 1, d_model}, 0.0f);
+        auto V2 = sil::array<float>({t + 1, d_model}, 0.0f);
+        if (t) {
+          std::copy_n(K.buffer_data(), t * d_model, K2.buffer_data());
+          std::copy_n(V.buffer_data(), t * d_model, V2.buffer_data());
+        }
+        std::copy_n(k.buffer_data(), d_model, K2.buffer_data() + t * d_model);
+        std::copy_n(v.buffer_data(), d_model, V2.buffer_data() + t * d_model);
+        K = K2;
+        V = V2;
+        auto ctx = sil::scaled_dot_product_attention(h.dot(Wq), K, V, {}, scale);
+      }
+    })});
+
+    sil::kv_cache cache(steps, d_model);
+    entries.push_back({"sil-kv_cache", measure(3, [&] {
+      cache.clear();
+      for (size_t t = 0; t < steps; t++) {
+        auto h = x.rows(t, t + 1);
+        cache.append(h.dot(Wk), h.dot(Wv));
+        auto ctx = cache.attention(h.dot(Wq), scale);
+      }
+    })});
+    sil::use_mps();
+
+    auto group = BenchGroup{
+        std::format("decode ({} tokens, d={})", steps, d_model),
+        std::move(entries)};
+    if (!csv) print_group(group);
+    groups.push_back(std::move(group));
+  }
+}
+
 int main(int argc, const char** argv) {
   auto mode = parse_output_mode(argc, argv);
   bool csv = (mode != OutputMode::bar);
@@ -339,6 +392,8 @@ int main(int argc, const char** argv) {
   ggml_metal_backend();  // warm up once (logs suppressed internally)
 #endif
   bench_transformer(groups, csv);
+  bench_decode(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "Transformer", "Single transformer block (multi-head self-attention + FFN) inference at various sequence lengths and model dimensions");
+  return report_results(groups, argc, argv);
 }
@@ -120,4 +120,5 @@ int main(int argc, const char** argv) {
   bench_broadcast(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "Broadcast", "Bias-add broadcast pattern `(N,M) + (M)` at various matrix sizes");
+  return report_results(groups, argc, argv);
 }
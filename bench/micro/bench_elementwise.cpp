@@ -94,6 +94,7 @@ void bench_op(std::vector<BenchGroup>& groups, bool csv, const char* op_name,
     }
 #endif
 
+    set_work(entries, 4.0 * 3 * n, n);
     auto group = BenchGroup{std::format("{} ({})", op_name, n), std::move(entries)};
     if (!csv) print_group(group);
     groups.push_back(std::move(group));
@@ -212,4 +213,5 @@ int main(int argc, const char** argv) {
 
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "Elementwise", "Per-element vector operations (add/mul/div/pow) throughput from 100K to 10M elements");
+  return report_results(groups, argc, argv);
 }
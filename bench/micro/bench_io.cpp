@@ -0,0 +1,236 @@
+#include <silarray.h>
+
+#include "../bench_common.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+// Weight loading: mmap-backed views against an eager read into a fresh
+// buffer. Files are in the page cache after the first pass, so these are
+// warm-cache times; the view costs page faults only for what is touched.
+
+namespace {
+
+constexpr size_t kElements = size_t(16) << 20;  // 64 MB of float
+
+std::filesystem::path temp_file(const char* name) {
+  return std::filesystem::temp_directory_path() / name;
+}
+
+float touch(const sil::array<float>& a) {
+  const float* p = a.buffer_data();
+  float acc = 0;
+  for (size_t i = 0; i < a.element_count(); i += 1024) acc += p[i];
+  return acc;
+}
+
+}  // namespace
+
+void bench_npy(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("npy (64 MB float32)");
+
+  auto path = temp_file("sil_bench_io.npy");
+  auto a = sil::random({kElements / 1024, 1024});
+  sil::save_npy(path, a);
+  std::vector<BenchEntry> entries;
+
+  volatile float sink = 0;
+  entries.push_back({"sil-load_npy", measure(20, [&] {
+    auto b = sil::load_npy<float>(path);
+  })});
+  entries.push_back({"sil-load_npy+touch", measure(20, [&] {
+    sink = touch(sil::load_npy<float>(path));
+  })});
+  entries.push_back({"ifstream-read", measure(20, [&] {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<float> buf(kElements);
+    in.seekg(-std::streamoff(kElements * sizeof(float)), std::ios::end);
+    in.read(reinterpret_cast<char*>(buf.data()), kElements * sizeof(float));
+    sink = buf[0];
+  })});
+  entries.push_back({"sil-save_npy", measure(10, [&] {
+    sil::save_npy(path, a);
+  })});
+
+  auto group = BenchGroup{"load/save 64 MB npy", std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+  std::filesystem::remove(path);
+}
+
+void bench_safetensors(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("safetensors (64 layers, 64 MB)");
+
+  auto path = temp_file("sil_bench_io.safetensors");
+  constexpr size_t layers = 64;
+  auto w = sil::random({kElements / layers / 1024, 1024});
+  std::vector<sil::weights_entry> layout;
+  for (size_t l = 0; l < layers; l++) {
+    layout.push_back({std::format("layer{}.f32", l), w.shape()});
+    layout.push_back({std::format("layer{}.bf16", l), w.shape(), "BF16"});
+  }
+
+  std::vector<BenchEntry> entries;
+  auto write = [&] {
+    sil::weights_writer out(path, layout);
+    for (size_t l = 0; l < layers; l++) {
+      out.write(std::format("layer{}.f32", l), w);
+      out.write(std::format("layer{}.bf16", l), w);
+    }
+    out.close();
+  };
+  entries.push_back({"sil-weights_writer", measure(5, write)});
+
+  volatile float sink = 0;
+  entries.push_back({"sil-open", measure(20, [&] {
+    sil::weights_file f(path);
+  })});
+  entries.push_back({"sil-get-f32", measure(20, [&] {
+    sil::weights_file f(path);
+    for (size_t l = 0; l < layers; l++) {
+      sink = touch(f.get(std::format("layer{}.f32", l)));
+    }
+  })});
+  entries.push_back({"sil-get-bf16", measure(10, [&] {
+    sil::weights_file f(path);
+    for (size_t l = 0; l < layers; l++) {
+      sink = touch(f.get(std::format("layer{}.bf16", l)));
+    }
+  })});
+
+  auto group = BenchGroup{"64 x 1 MB f32 + 64 x 0.5 MB bf16 tensors",
+                          std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+  std::filesystem::remove(path);
+}
+
+void bench_csv(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("csv (1M x 16 float32)");
+
+  auto path = temp_file("sil_bench_io.csv");
+  auto a = sil::random({size_t(1) << 20, 16});
+  sil::save_csv(path, a);
+  auto mb = std::filesystem::file_size(path) / 1e6;
+  std::vector<BenchEntry> entries;
+
+  entries.push_back({"sil-load_csv", measure(5, [&] {
+    auto b = sil::load_csv(path);
+  })});
+  entries.push_back({"getline-stof", measure(2, [&] {
+    std::ifstream in(path);
+    std::vector<float> values;
+    std::string line, field;
+    while (std::getline(in, line)) {
+      std::istringstream fields(line);
+      while (std::getline(fields, field, ',')) values.push_back(std::stof(field));
+    }
+  })});
+  entries.push_back({"sil-save_csv", measure(5, [&] {
+    sil::save_csv(path, a);
+  })});
+
+  auto group = BenchGroup{std::format("load/save {:.0f} MB csv", mb),
+                          std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+  std::filesystem::remove(path);
+}
+
+void bench_idx(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("idx (60000 x 784 u8, MNIST-sized)");
+
+  // Synthetic MNIST-shaped image file
+  auto path = temp_file("sil_bench_io.idx");
+  constexpr uint32_t records = 60000, rows = 28, cols = 28;
+  constexpr size_t pixels = size_t(records) * rows * cols;
+  std::vector<uint8_t> bytes(pixels);
+  for (size_t i = 0; i < pixels; i++) bytes[i] = uint8_t(i * 131);
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write("\0\0\x08\x03", 4);
+    for (uint32_t d : {records, rows, cols}) {
+      d = std::byteswap(d);
+      out.write(reinterpret_cast<const char*>(&d), 4);
+    }
+    out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+  sil::idx_file images(path);
+  std::vector<float> out(pixels);
+  std::vector<BenchEntry> entries;
+
+  volatile float sink = 0;
+  entries.push_back({"sil-read/255", measure(20, [&] {
+    images.read(0, records, out.data(), 1.0f / 255);
+    sink = out[0];
+  })});
+  entries.push_back({"scalar-/255", measure(20, [&] {
+    for (size_t i = 0; i < pixels; i++) out[i] = bytes[i] / 255.0f;
+    sink = out[0];
+  })});
+  entries.push_back({"sil-batch-100", measure(20, [&] {
+    for (uint32_t i = 0; i < records; i += 100) {
+      sink = images.read(i, i + 100, 1.0f / 255).at(0);
+    }
+  })});
+
+  auto group = BenchGroup{"normalize 47 MB of u8 pixels", std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+  std::filesystem::remove(path);
+}
+
+void bench_checkpoint(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("checkpoint (8 x 8 MB training state)");
+
+  auto path = temp_file("sil_bench_io.ckpt");
+  std::vector<std::pair<std::string, sil::npy_value>> state;
+  for (size_t i = 0; i < 8; i++) {
+    state.push_back({std::format("p{}", i), sil::random({kElements / 8 / 1024, 1024})});
+  }
+  std::vector<BenchEntry> entries;
+
+  // save() returns once the arrays are captured: time that, not the write
+  sil::checkpoint ckpt;
+  auto capture = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < 10; i++) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    ckpt.save(path, state);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    capture = std::min(capture, std::chrono::duration<double>(t1 - t0).count());
+    ckpt.wait();
+  }
+  entries.push_back({"sil-checkpoint-save", capture});
+  entries.push_back({"sil-checkpoint+wait", measure(10, [&] {
+    ckpt.save(path, state);
+    ckpt.wait();
+  })});
+  entries.push_back({"sil-save_npz", measure(10, [&] {
+    sil::save_npz(path, state);
+  })});
+  entries.push_back({"sil-load_checkpoint", measure(10, [&] {
+    auto restored = sil::load_checkpoint(path);
+  })});
+
+  auto group = BenchGroup{"async capture vs synchronous save", std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+  std::filesystem::remove(path);
+}
+
+int main(int argc, const char** argv) {
+  auto mode = parse_output_mode(argc, argv);
+  bool csv = (mode != OutputMode::bar);
+  std::vector<BenchGroup> groups;
+
+  bench_npy(groups, csv);
+  bench_safetensors(groups, csv);
+  bench_csv(groups, csv);
+  bench_idx(groups, csv);
+  bench_checkpoint(groups, csv);
+  if (mode == OutputMode::csv) print_csv(groups);
+  if (mode == OutputMode::table) print_table(groups, "I/O", "Weight loading: mmap-backed npy/safetensors views bf16 conversion parallel CSV parsing, fused IDX u8 normalization and async checkpoints against eager ifstream/getline reads and scalar loops (warm page cache)");
+  return report_results(groups, argc, argv);
+}
@@ -1,5 +1,10 @@
 #include <silarray.h>
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+
 #include "../bench_common.h"
 
 #ifdef BENCH_HAS_MLX
@@ -143,7 +148,7 @@ void bench_layernorm(std::vector<BenchGroup>& groups, bool csv) {
   }
 }
 
-// Conv2d — sil lacks native conv2d, not benchmarked
+// Conv2d — sil runs on the CPU (im2col + GEMM)
 void bench_conv2d(std::vector<BenchGroup>& groups, bool csv) {
   if (!csv) print_section("conv2d");
 
@@ -162,6 +167,16 @@ void bench_conv2d(std::vector<BenchGroup>& groups, bool csv) {
     size_t iters = (h >= 224) ? 10 : 20;
     std::vector<BenchEntry> entries;
 
+    {
+      auto x = sil::random({size_t(batch), size_t(in_ch), size_t(h), size_t(w)});
+      auto weight = sil::random({size_t(out_ch), size_t(in_ch), size_t(k), size_t(k)});
+      auto pad = size_t(k / 2);
+      auto y = sil::array<float>();
+      entries.push_back({"sil-cpu", measure(iters, [&] {
+        y = sil::conv2d(x, weight, {.pad_h = pad, .pad_w = pad});
+      })});
+    }
+
 #ifdef BENCH_HAS_MLX
     {
       auto x = mx::random::normal({(int)batch, (int)h, (int)w, (int)in_ch});
@@ -196,6 +211,268 @@ void bench_conv2d(std::vector<BenchGroup>& groups, bool csv) {
   }
 }
 
+// Minibatch assembly: 256 random rows of a 60000 x 784 dataset
+void bench_index_select(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("index_select");
+
+  constexpr size_t rows = 60000, cols = 784, batch = 256;
+  auto data = sil::random({rows, cols});
+  std::vector<int> ids(batch);
+  for (size_t i = 0; i < batch; i++) ids[i] = static_cast<int>((i * 7919) % rows);
+  auto idx = sil::array<int>({batch}, ids.data());
+
+  std::vector<BenchEntry> entries;
+  sil::use_cpu();
+  sil::array<float> y;
+  entries.push_back({"sil-cpu", measure(200, [&] {
+    y = sil::index_select(data, 0, idx);
+  })});
+  std::vector<float> dst(batch * cols);
+  const float* src = data.buffer_data();
+  entries.push_back({"memcpy", measure(200, [&] {
+    for (size_t i = 0; i < batch; i++)
+      std::memcpy(dst.data() + i * cols, src + ids[i] * cols, cols * sizeof(float));
+  })});
+  sil::use_mps();
+
+  auto group = BenchGroup{
+      std::format("index_select ({} of {}x{} rows)", batch, rows, cols),
+      std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+}
+
+// Weight init and dropout masks: Philox fills vs a sequential mt19937 loop
+void bench_random(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("random");
+
+  constexpr size_t rows = 4096, cols = 4096;
+  std::vector<BenchEntry> entries;
+  sil::use_cpu();
+  sil::array<float> y;
+  entries.push_back({"sil-uniform", measure(10, [&] {
+    y = sil::random_uniform({rows, cols});
+  })});
+  entries.push_back({"sil-normal", measure(10, [&] {
+    y = sil::random_normal({rows, cols});
+  })});
+  auto x = sil::ones<float>({rows, cols});
+  entries.push_back({"sil-dropout", measure(10, [&] {
+    y = sil::dropout(x, 0.1f);
+  })});
+  std::vector<float> dst(rows * cols);
+  std::mt19937 gen(42);
+  std::normal_distribution<float> dist;
+  entries.push_back({"mt19937-normal", measure(3, [&] {
+    for (auto& v : dst) v = dist(gen);
+  })});
+  sil::use_mps();
+
+  auto group = BenchGroup{std::format("random ({}x{})", rows, cols),
+                          std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+}
+
+// Unary math: NEON polynomial kernels vs a <cmath> loop, and a scalar chain
+// fused around the op vs evaluating each step
+// Forward with saved statistics plus backward, the per-step cost in training
+void bench_norm_training(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("norm forward + backward");
+  for (auto [rows, cols] : {std::pair{1024ul, 1024ul}, {4096ul, 2048ul}}) {
+    auto x = sil::random({rows, cols});
+    auto dout = sil::random({rows, cols});
+    auto gamma = sil::ones<float>({cols});
+    auto beta = sil::zeros<float>({cols});
+    sil::norm_stats stats;
+    std::vector<BenchEntry> entries;
+    sil::use_cpu();
+    entries.push_back({"sil-layer_norm", measure(50, [&] {
+      auto y = sil::layer_norm(x, gamma, beta, stats);
+      auto g = sil::layer_norm_backward(dout, x, gamma, stats);
+    })});
+    entries.push_back({"sil-rms_norm", measure(50, [&] {
+      auto y = sil::rms_norm(x, gamma, stats);
+      auto g = sil::rms_norm_backward(dout, x, gamma, stats);
+    })});
+
+    // Backward composed from primitives, with the temporaries that implies
+    entries.push_back({"sil-composed", measure(10, [&] {
+      auto y = sil::layer_norm(x, gamma, beta, stats);
+      auto mu = x.mean(1);
+      mu.reshape({rows, 1});
+      auto rstd = stats.rstd.clone();
+      rstd.reshape({rows, 1});
+      auto xhat = (x - mu) * rstd;
+      auto g = dout * gamma;
+      auto dgamma = (dout * xhat).sum(0);
+      auto dbeta = dout.sum(0);
+      auto mg = g.mean(1);
+      mg.reshape({rows, 1});
+      auto mgx = (g * xhat).mean(1);
+      mgx.reshape({rows, 1});
+      auto dx = (g - mg - xhat * mgx) * rstd;
+      dx.buffer_data();
+    })});
+    sil::use_mps();
+
+    auto group = BenchGroup{
+        std::format("norm fwd+bwd ({}x{})", rows, cols), std::move(entries)};
+    if (!csv) print_group(group);
+    groups.push_back(std::move(group));
+  }
+}
+
+// Softmax cross-entropy loss + gradient from integer labels
+void bench_cross_entropy(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("cross entropy");
+  for (auto [rows, classes] : {std::pair{100ul, 10ul}, {8192ul, 1000ul}}) {
+    size_t iters = rows * classes <= 1'000'000 ? 200 : 20;
+    auto logits = sil::random({rows, classes}) * 8.0f;
+    auto labels = sil::array<int>({rows}, 0);
+    for (size_t i = 0; i < rows; i++) labels.at(i) = static_cast<int>(i % classes);
+    auto float_labels = labels.clone<float>();
+    std::vector<BenchEntry> entries;
+    sil::use_cpu();
+    entries.push_back({"sil-fused", measure(iters, [&] {
+      auto ce = sil::cross_entropy(logits, labels);
+    })});
+    entries.push_back({"sil-composed", measure(iters, [&] {
+      auto p = logits.softmax();
+      auto Y = float_labels.one_hot<float>(classes);
+      auto grad = (p - Y) / float(rows);
+      auto loss = -((p + 1e-12f).log() * Y).sum() / float(rows);
+      grad.buffer_data();
+    })});
+    sil::use_mps();
+
+    auto group = BenchGroup{std::format("cross_entropy ({}x{})", rows, classes),
+                            std::move(entries)};
+    if (!csv) print_group(group);
+    groups.push_back(std::move(group));
+  }
+}
+
+// Top-5 of classifier outputs, e.g. for top-5 accuracy
+void bench_topk(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("top-k");
+
+  constexpr size_t rows = 10000, classes = 1000, k = 5;
+  auto logits = sil::random({rows, classes});
+  std::vector<BenchEntry> entries;
+  entries.push_back({"sil-topk", measure(20, [&] {
+    auto t = sil::topk(logits, k, 1);
+  })});
+  entries.push_back({"sil-argsort", measure(3, [&] {
+    auto order = sil::argsort(logits, 1, true);
+  })});
+
+  const float* src = logits.buffer_data();
+  std::vector<int> idx(classes), best(rows * k);
+  entries.push_back({"std-partial_sort", measure(3, [&] {
+    for (size_t r = 0; r < rows; r++) {
+      const float* row = src + r * classes;
+      std::iota(idx.begin(), idx.end(), 0);
+      std::partial_sort(idx.begin(), idx.begin() + k, idx.end(),
+                        [&](int a, int b) { return row[a] > row[b]; });
+      std::copy_n(idx.begin(), k, best.begin() + r * k);
+    }
+  })});
+
+  auto group = BenchGroup{
+      std::format("top-{} ({}x{})", k, rows, classes), std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+}
+
+void bench_scan(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("cumulative scans");
+
+  // A copy of the same bytes is the bandwidth floor for a scan
+  constexpr size_t n = 100'000'000;
+  auto x = sil::random({n});
+  const float* src = x.buffer_data();
+  std::vector<BenchEntry> entries;
+  entries.push_back({"sil-cumsum", measure(5, [&] {
+    auto y = sil::cumsum(x, 0);
+  })});
+  entries.push_back({"sil-cumprod", measure(5, [&] {
+    auto y = sil::cumprod(x, 0);
+  })});
+  std::vector<float> dst(n);
+  entries.push_back({"std-inclusive_scan", measure(3, [&] {
+    std::inclusive_scan(src, src + n, dst.begin());
+  })});
+  entries.push_back({"memcpy", measure(5, [&] {
+    std::memcpy(dst.data(), src, n * sizeof(float));
+  })});
+
+  auto group = BenchGroup{std::format("cumsum ({}M)", n / 1'000'000),
+                          std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+
+  // Scan down the rows of a matrix: slice-wise vector adds
+  constexpr size_t rows = 4096, cols = 4096;
+  auto m = sil::random({rows, cols});
+  std::vector<BenchEntry> axis0;
+  axis0.push_back({"sil-cumsum-axis0", measure(10, [&] {
+    auto y = sil::cumsum(m, 0);
+  })});
+  axis0.push_back({"sil-cumsum-axis1", measure(10, [&] {
+    auto y = sil::cumsum(m, 1);
+  })});
+  axis0.push_back({"sil-logcumsumexp-axis1", measure(3, [&] {
+    auto y = sil::logcumsumexp(m, 1);
+  })});
+
+  auto group2 = BenchGroup{std::format("cumsum ({}x{})", rows, cols),
+                           std::move(axis0)};
+  if (!csv) print_group(group2);
+  groups.push_back(std::move(group2));
+}
+
+void bench_unary(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("unary math");
+
+  constexpr size_t rows = 4096, cols = 4096;
+  auto x = sil::random({rows, cols}) * 8.0f - 4.0f;
+  std::vector<BenchEntry> entries;
+  sil::use_cpu();
+  sil::array<float> y;
+  entries.push_back({"sil-gelu", measure(10, [&] {
+    y = x.gelu();
+    y.buffer_data();
+  })});
+  entries.push_back({"sil-tanh-fused", measure(10, [&] {
+    y = (x * 0.5f).tanh() * 0.5f + 0.5f;
+    y.buffer_data();
+  })});
+  entries.push_back({"sil-tanh-steps", measure(10, [&] {
+    auto a = x * 0.5f;
+    a.buffer_data();
+    auto b = a.tanh();
+    b.buffer_data();
+    y = b * 0.5f + 0.5f;
+    y.buffer_data();
+  })});
+  const float* src = x.buffer_data();
+  std::vector<float> dst(rows * cols);
+  entries.push_back({"cmath-gelu", measure(3, [&] {
+    for (size_t i = 0; i < dst.size(); i++) {
+      auto v = src[i];
+      dst[i] = 0.5f * v *
+               (1.0f + std::tanh(0.7978845608f * (v + 0.044715f * v * v * v)));
+    }
+  })});
+  sil::use_mps();
+
+  auto group = BenchGroup{std::format("unary ({}x{})", rows, cols),
+                          std::move(entries)};
+  if (!csv) print_group(group);
+  groups.push_back(std::move(group));
+}
+
 // Batch matmul — sil uses loop over individual dot calls
 void bench_batch_matmul(std::vector<BenchGroup>& groups, bool csv) {
   if (!csv) print_section("batch matmul");
@@ -316,8 +593,16 @@ int main(int argc, const char** argv) {
 
   bench_softmax(groups, csv);
   bench_layernorm(groups, csv);
+  bench_norm_training(groups, csv);
+  bench_cross_entropy(groups, csv);
+  bench_topk(groups, csv);
+  bench_scan(groups, csv);
   bench_conv2d(groups, csv);
+  bench_index_select(groups, csv);
+  bench_random(groups, csv);
+  bench_unary(groups, csv);
   bench_batch_matmul(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
-  if (mode == OutputMode::table) print_table(groups, "NN Ops", "Neural network primitives: softmax, layer normalization, 2D convolution, and batched matrix multiply");
+  if (mode == OutputMode::table) print_table(groups, "NN Ops", "Neural network primitives: softmax, layer normalization (forward and backward), cross entropy, top-k, cumulative scans, 2D convolution, row gather, random fills, unary math, and batched matrix multiply");
+  return report_results(groups, argc, argv);
 }
@@ -89,6 +89,7 @@ void bench_reduction(std::vector<BenchGroup>& groups, bool csv) {
     }
 #endif
 
+    set_work(entries, 4.0 * n, n);
     auto group = BenchGroup{
         std::format("sum ({})", n), std::move(entries)};
     if (!csv) print_group(group);
@@ -293,4 +294,5 @@ int main(int argc, const char** argv) {
   bench_argmax(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "Reduction", "Reduction operations (sum, min, max, argmax) on 1D vectors and 2D matrices");
+  return report_results(groups, argc, argv);
 }
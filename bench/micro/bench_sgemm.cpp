@@ -93,6 +93,7 @@ void bench_sgemm(std::vector<BenchGroup>& groups, bool csv) {
     }
 #endif
 
+    set_work(entries, 4.0 * 3 * m * m, 2.0 * m * m * m);
     auto best = std::ranges::min_element(entries, {}, &BenchEntry::seconds)
                     ->seconds;
 
@@ -181,6 +182,7 @@ void bench_sgemm_rect(std::vector<BenchGroup>& groups, bool csv) {
     }
 #endif
 
+    set_work(entries, 4.0 * (M * K + K * N + M * N), 2.0 * M * N * K);
     auto best = std::ranges::min_element(entries, {}, &BenchEntry::seconds)->seconds;
     auto group = BenchGroup{
         std::format("{}x{}x{} ({}, {:.1f} GFLOPS)", M, N, K, desc,
@@ -204,4 +206,5 @@ int main(int argc, const char** argv) {
   bench_sgemm_rect(groups, csv);
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "SGEMM", "Single-precision matrix multiplication (GFLOPS) for square matrices (128-8192) and real-world shapes");
+  return report_results(groups, argc, argv);
 }
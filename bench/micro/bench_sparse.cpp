@@ -0,0 +1,112 @@
+#include <silarray.h>
+
+#include "../bench_common.h"
+
+#ifdef BENCH_HAS_EIGEN
+#include <eigen3/Eigen/Sparse>
+#endif
+
+// Sparse x dense products against the dense dot path at several densities.
+// The sparse side should scale with nnz; the dense side doesn't change.
+
+namespace {
+
+sil::array<float> sparse_matrix(size_t rows, size_t cols, float density) {
+  auto a = sil::random({rows, cols});
+  float* p = a.buffer_data();
+  for (size_t i = 0; i < a.element_count(); i++) {
+    p[i] = p[i] < density ? p[i] / density : 0.0f;
+  }
+  return a;
+}
+
+}  // namespace
+
+void bench_spmm(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("spmm (sparse 4096x4096 x dense 4096x64)");
+
+  constexpr size_t m = 4096, k = 4096, n = 64;
+  auto b = sil::random({k, n});
+  for (auto density : {0.1f, 0.01f, 0.001f}) {
+    auto dense = sparse_matrix(m, k, density);
+    auto s = sil::csr_array<float>(dense);
+    std::vector<BenchEntry> entries;
+
+    entries.push_back({"sil-spmm", measure(50, [&] {
+      auto c = sil::spmm(s, b);
+    })});
+    entries.push_back({"sil-spmm-trans", measure(20, [&] {
+      auto c = sil::spmm(s, b, true);
+    })});
+    bench_sil(entries, 20,
+              [&] { auto c = dense.dot(b); c.buffer_data(); },
+              [&] { auto c = dense.dot(b); c.buffer_data(); });
+
+#ifdef BENCH_HAS_EIGEN
+    {
+      std::vector<Eigen::Triplet<float>> triplets;
+      const auto& ptr = s.row_offsets();
+      for (size_t r = 0; r < m; r++) {
+        for (auto i = ptr[r]; i < ptr[r + 1]; i++) {
+          triplets.emplace_back(r, s.col_indices()[i], s.values()[i]);
+        }
+      }
+      Eigen::SparseMatrix<float, Eigen::RowMajor> es(m, k);
+      es.setFromTriplets(triplets.begin(), triplets.end());
+      Eigen::MatrixXf eb = Eigen::MatrixXf::Random(k, n);
+      Eigen::MatrixXf ec(m, n);
+      entries.push_back({"eigen-sparse", measure(20, [&] { ec = es * eb; })});
+    }
+#endif
+
+    auto csr_mb = (s.nnz() * (sizeof(float) + sizeof(int)) +
+                   (m + 1) * sizeof(size_t)) / 1e6;
+    auto group = BenchGroup{
+        std::format("spmm {:g}% ({} nnz, {:.1f} MB vs {:.1f} MB dense)",
+                    density * 100, s.nnz(), csr_mb, m * k * sizeof(float) / 1e6),
+        std::move(entries)};
+    if (!csv) print_group(group);
+    groups.push_back(std::move(group));
+  }
+}
+
+void bench_spmv(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("spmv (sparse 16384x16384 x vector)");
+
+  constexpr size_t m = 16384, k = 16384;
+  auto x = sil::random({k});
+  auto x_col = sil::random({k, 1});
+  for (auto density : {0.01f, 0.001f}) {
+    auto dense = sparse_matrix(m, k, density);
+    auto s = sil::csr_array<float>(dense);
+    std::vector<BenchEntry> entries;
+
+    entries.push_back({"sil-spmv", measure(50, [&] {
+      auto y = sil::spmv(s, x);
+    })});
+    sil::use_cpu();
+    entries.push_back({"sil-dot-cpu", measure(5, [&] {
+      auto y = dense.dot(x_col);
+      y.buffer_data();
+    })});
+    sil::use_mps();
+
+    auto group = BenchGroup{
+        std::format("spmv {:g}% ({} nnz)", density * 100, s.nnz()),
+        std::move(entries)};
+    if (!csv) print_group(group);
+    groups.push_back(std::move(group));
+  }
+}
+
+int main(int argc, const char** argv) {
+  auto mode = parse_output_mode(argc, argv);
+  bool csv = (mode != OutputMode::bar);
+  std::vector<BenchGroup> groups;
+
+  bench_spmm(groups, csv);
+  bench_spmv(groups, csv);
+  if (mode == OutputMode::csv) print_csv(groups);
+  if (mode == OutputMode::table) print_table(groups, "Sparse", "CSR sparse x dense products (spmm, transposed spmm, spmv) against dense dot at 10%, 1% and 0.1% density");
+  return report_results(groups, argc, argv);
+}
@@ -269,4 +269,5 @@ int main(int argc, const char** argv) {
   if (mode == OutputMode::csv) print_csv(groups);
   if (mode == OutputMode::table) print_table(groups, "MNIST Autoencoder",
       "784->512->256->64->256->512->784 (sigmoid, MSE loss, SGD). Training: 1 epoch, batch=100. Inference: 10000 images.");
+  return report_results(groups, argc, argv);
 }
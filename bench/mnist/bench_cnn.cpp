@@ -0,0 +1,203 @@
+#include <silarray.h>
+
+#include "../bench_common.h"
+#include "mnist_data.h"
+
+// MNIST CNN vs MLP on the sil CPU backend
+//   CNN: conv3x3(1->8) -> relu -> maxpool2 -> conv3x3(8->16) -> relu
+//        -> maxpool2 -> 784 -> 10 -> sigmoid
+//   MLP: 784 -> 50 -> sigmoid -> 10 -> sigmoid (same as bench_classifier)
+// Training: 100 batches x 100 images, SGD, MSE loss
+// Inference: 10000 test images
+
+static const char* kTrainImages = "../test/train-images-idx3-ubyte";
+static const char* kTrainLabels = "../test/train-labels-idx1-ubyte";
+static const char* kTestImages  = "../test/t10k-images-idx3-ubyte";
+static const char* kTestLabels  = "../test/t10k-labels-idx1-ubyte";
+
+constexpr size_t D = 784, H = 50, C = 10, batch = 100;
+constexpr size_t kTrainImagesUsed = 10000;
+
+struct cnn_model {
+  sil::array<float> K1 = (sil::random({8, 1, 3, 3}) * 2.0f - 1.0f) * (1.0f / 3.0f);
+  sil::array<float> c1 = sil::zeros<float>({8});
+  sil::array<float> K2 = (sil::random({16, 8, 3, 3}) * 2.0f - 1.0f) * (1.0f / sqrtf(72.0f));
+  sil::array<float> c2 = sil::zeros<float>({16});
+  sil::array<float> W3 = (sil::random({D, C}) * 2.0f - 1.0f) * (1.0f / sqrtf(float(D)));
+  sil::array<float> b3 = sil::zeros<float>({C});
+};
+
+static const sil::conv2d_params kSame{.pad_h = 1, .pad_w = 1};
+
+static sil::array<float> relu_mask(const sil::array<float>& z) {
+  return sil::where(z > 0.0f, 1.0f, 0.0f);
+}
+
+static void cnn_train_step(cnn_model& m, const sil::array<float>& x,
+                           const sil::array<float>& Y, float lr) {
+  auto z1 = sil::conv2d(x, m.K1, m.c1, kSame);
+  auto a1 = z1.relu();
+  auto p1 = sil::max_pool2d(a1);
+  auto z2 = sil::conv2d(p1, m.K2, m.c2, kSame);
+  auto a2 = z2.relu();
+  auto p2 = sil::max_pool2d(a2);
+  auto f = p2;
+  f.reshape({batch, D});
+  auto n3 = f.linear(m.W3, m.b3);
+  auto o3 = n3.sigmoid();
+
+  auto dout = (2.0f * (o3 - Y)) / float(batch * C);
+  dout = n3.sigmoid_backward(dout);
+  auto dW3 = f.transpose().dot(dout);
+  auto db3 = dout.sum(0);
+  auto df = dout.dot(m.W3.transpose());
+  df.reshape(p2.shape());
+
+  auto dz2 = sil::max_pool2d_backward(df, a2) * relu_mask(z2);
+  auto g2 = sil::conv2d_backward(dz2, p1, m.K2, kSame);
+  auto dz1 = sil::max_pool2d_backward(g2.dx, a1) * relu_mask(z1);
+  auto g1 = sil::conv2d_backward(dz1, x, m.K1, kSame);
+
+  m.K1 -= g1.dw * lr; m.c1 -= g1.db * lr;
+  m.K2 -= g2.dw * lr; m.c2 -= g2.db * lr;
+  m.W3 -= dW3 * lr;   m.b3 -= db3 * lr;
+}
+
+static sil::array<float> cnn_forward(const cnn_model& m,
+                                     const sil::array<float>& x) {
+  auto p1 = sil::max_pool2d(sil::conv2d(x, m.K1, m.c1, kSame).relu());
+  auto p2 = sil::max_pool2d(sil::conv2d(p1, m.K2, m.c2, kSame).relu());
+  p2.reshape({x.shape()[0], D});
+  return p2.linear(m.W3, m.b3).sigmoid();
+}
+
+static void print_throughput(const BenchGroup& group, size_t images) {
+  for (auto& e : group.second)
+    std::printf("    %-10s %10.0f images/s\n", e.name.c_str(), images / e.seconds);
+}
+
+void bench_train(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("training (10000 images, batch=100)");
+
+  mnist_data train;
+  if (!train.load(kTrainImages, kTrainLabels)) return;
+
+  auto n_images = std::min(train.count, kTrainImagesUsed);
+  float lr = 0.5f;
+
+  auto batch_of = [&](size_t i, const sil::shape_type& shape) {
+    auto x = sil::array<float>(shape, &train.images[i * D]);
+    auto labels = sil::array<float>({batch}, std::vector<float>(
+        train.labels.begin() + i, train.labels.begin() + i + batch).data());
+    return std::pair{x, labels.template one_hot<float>(C)};
+  };
+
+  std::vector<BenchEntry> entries;
+
+  // --- MLP ---
+  {
+    auto W1 = (sil::random({D, H}) * 2.0f - 1.0f) * (1.0f / sqrtf(float(D)));
+    auto b1 = sil::zeros<float>({H});
+    auto W2 = (sil::random({H, C}) * 2.0f - 1.0f) * (1.0f / sqrtf(float(H)));
+    auto b2 = sil::zeros<float>({C});
+
+    entries.push_back({"sil-mlp", measure(3, [&] {
+      for (size_t i = 0; i + batch <= n_images; i += batch) {
+        auto [x, Y] = batch_of(i, {batch, D});
+
+        auto n1 = x.linear(W1, b1);
+        auto o1 = n1.sigmoid();
+        auto n2 = o1.linear(W2, b2);
+        auto o2 = n2.sigmoid();
+
+        auto dout = (2.0f * (o2 - Y)) / float(batch * C);
+        dout = n2.sigmoid_backward(dout);
+        auto dW2 = o1.transpose().dot(dout);
+        auto db2 = dout.sum(0);
+        auto dout1 = dout.dot(W2.transpose());
+        dout1 = n1.sigmoid_backward(dout1);
+        auto dW1 = x.transpose().dot(dout1);
+        auto db1 = dout1.sum(0);
+
+        W1 -= dW1 * lr; b1 -= db1 * lr;
+        W2 -= dW2 * lr; b2 -= db2 * lr;
+      }
+    })});
+  }
+
+  // --- CNN ---
+  {
+    cnn_model m;
+    entries.push_back({"sil-cnn", measure(1, [&] {
+      for (size_t i = 0; i + batch <= n_images; i += batch) {
+        auto [x, Y] = batch_of(i, {batch, 1, 28, 28});
+        cnn_train_step(m, x, Y, lr);
+      }
+    })});
+  }
+
+  auto group = BenchGroup{"train (10000 images)", std::move(entries)};
+  if (!csv) {
+    print_group(group);
+    print_throughput(group, n_images);
+  }
+  groups.push_back(std::move(group));
+}
+
+void bench_inference(std::vector<BenchGroup>& groups, bool csv) {
+  if (!csv) print_section("inference (10000 images)");
+
+  mnist_data test;
+  if (!test.load(kTestImages, kTestLabels)) return;
+
+  std::vector<BenchEntry> entries;
+
+  {
+    auto W1 = sil::random({D, H});
+    auto b1 = sil::zeros<float>({H});
+    auto W2 = sil::random({H, C});
+    auto b2 = sil::zeros<float>({C});
+    auto x = sil::array<float>({test.count, D}, test.images.data());
+
+    entries.push_back({"sil-mlp", measure(20, [&] {
+      auto o1 = x.linear(W1, b1).sigmoid();
+      auto o2 = o1.linear(W2, b2).sigmoid();
+      o2.buffer_data();
+    })});
+  }
+
+  {
+    cnn_model m;
+    auto x = sil::array<float>({test.count, 1, 28, 28}, test.images.data());
+
+    entries.push_back({"sil-cnn", measure(3, [&] {
+      auto o = cnn_forward(m, x);
+      o.buffer_data();
+    })});
+  }
+
+  auto group = BenchGroup{"inference (10000 images)", std::move(entries)};
+  if (!csv) {
+    print_group(group);
+    print_throughput(group, test.count);
+  }
+  groups.push_back(std::move(group));
+}
+
+int main(int argc, const char** argv) {
+  auto mode = parse_output_mode(argc, argv);
+  bool csv = (mode != OutputMode::bar);
+  std::vector<BenchGroup> groups;
+
+  // Spatial ops are CPU-only; run both models on the CPU backend
+  sil::use_cpu();
+
+  bench_train(groups, csv);
+  bench_inference(groups, csv);
+
+  if (mode == OutputMode::csv) print_csv(groups);
+  if (mode == OutputMode::table) print_table(groups, "MNIST CNN vs MLP (CPU)",
+      "CNN: conv3x3(1->8)-relu-pool-conv3x3(8->16)-relu-pool-784->10. "
+      "MLP: 784->50->10. Training: 10000 images, batch=100. Inference: 10000 images.");
+  return report_results(groups, argc, argv);
+}
@@ -2,10 +2,13 @@
 
 #include <cpu.h>
 #include <gpu.h>
+#include <philox.h>
 
 #include <algorithm>
 #include <concepts>
+#include <cstring>
 #include <format>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <limits>
@@ -178,10 +181,13 @@ auto operator/(float l, const R &r) { return binary<op_div, scalar, R>{{l}, r};
 namespace detail {
 
 struct lazy_node {
-  enum class op { add, sub, mul, div };
+  enum class op { add, sub, mul, div, unary };
 
   op operation;
-  std::shared_ptr<lazy_node> lhs, rhs;
+  std::shared_ptr<lazy_node> lhs, rhs;  // unary: lhs only
+
+  unary_op fn = unary_op::exp;
+  float lo = 0.0f, hi = 0.0f;  // clamp bounds
 
   storage data;
   shape_type shape;
@@ -212,6 +218,19 @@ struct lazy_node {
     n->strides = st;
     return n;
   }
+
+  static std::shared_ptr<lazy_node> make_unary(unary_op f, float lo, float hi,
+                                               std::shared_ptr<lazy_node> in) {
+    auto n = std::make_shared<lazy_node>();
+    n->operation = op::unary;
+    n->fn = f;
+    n->lo = lo;
+    n->hi = hi;
+    n->shape = in->shape;
+    n->strides = contiguous_strides(in->shape);
+    n->lhs = std::move(in);
+    return n;
+  }
 };
 
 }  // namespace detail
@@ -250,6 +269,18 @@ class array {
   array(std::ranges::input_range auto &&r);
   array(T val);
 
+  // Adopts external memory without copying. `strides` are in elements
+  // (empty: row-major). `deleter(ptr)` runs once no array references the
+  // memory; omit it for memory that outlives them. The const overload
+  // borrows read-only memory (e.g. a PROT_READ mapping): ops read it, but
+  // in-place updates are undefined. A range Metal can't map is copied once
+  // into a pool buffer instead (and released right away).
+  static array wrap(T *ptr, const shape_type &shape,
+                    const strides_type &strides = {},
+                    std::function<void(T *)> deleter = {});
+  static array wrap(const T *ptr, const shape_type &shape,
+                    const strides_type &strides = {});
+
   array(nested_initializer_list<T, 1> l);
   array(nested_initializer_list<T, 2> l);
   array(nested_initializer_list<T, 3> l);
@@ -273,6 +304,10 @@ class array {
 
   size_t buffer_element_count() const;
   size_t buffer_bytes() const;
+  // Arrays, views and pending lazy results sharing this buffer (0 if none)
+  long use_count() const;
+  // Identity of that buffer, the same for all of them (null if none)
+  const void *buffer_id() const;
 
   auto *buffer_data(this auto &&self);
   auto buffer_span(this auto &&self);
@@ -285,6 +320,7 @@ class array {
   size_t dimension() const;
   const shape_type &shape() const;
   const strides_type &strides() const;
+  bool is_contiguous() const;
 
   void reshape(const shape_type &shape);
 
@@ -308,6 +344,12 @@ class array {
   //----------------------------------------------------------------------------
 
   array operator[](size_t row) const;
+  array rows(size_t begin, size_t end) const;  // zero-copy [begin, end)
+
+  // Zero-copy [begin, end) along `axis`. Like transpose(), views along an
+  // inner axis are strided: at()/clone()/dot() follow the strides, and
+  // arithmetic, reductions and elementwise ops work on a packed copy.
+  array slice(size_t axis, size_t begin, size_t end) const;
 
   //----------------------------------------------------------------------------
 
@@ -375,6 +417,32 @@ class array {
   array<float> sigmoid_backward(const array<float> &dout) const;
   array<float> linear_sigmoid(const array &W, const array &b) const;
   array<float> relu() const;
+
+  // Element-wise math; see cpu_kernels.h for the accuracy of the NEON
+  // kernels. Float results are deferred like scalar arithmetic, so
+  // `(x * 0.5f).tanh() * 2.0f + 1.0f` is evaluated in a single pass.
+  array<float> exp() const;
+  array<float> log() const;
+  array<float> tanh() const;
+  array<float> gelu() const;  // tanh approximation
+  array<float> silu() const;
+  array<float> sqrt() const;
+  array<float> rsqrt() const;
+  array<float> abs() const;
+  array<float> clamp(float lo, float hi) const;
+
+  // dx = dout * f'(x), called on the forward input x
+  array<float> exp_backward(const array<float> &dout) const;
+  array<float> log_backward(const array<float> &dout) const;
+  array<float> tanh_backward(const array<float> &dout) const;
+  array<float> gelu_backward(const array<float> &dout) const;
+  array<float> silu_backward(const array<float> &dout) const;
+  array<float> sqrt_backward(const array<float> &dout) const;
+  array<float> rsqrt_backward(const array<float> &dout) const;
+  array<float> abs_backward(const array<float> &dout) const;
+  array<float> clamp_backward(const array<float> &dout, float lo,
+                              float hi) const;
+
   array<float> layer_norm(const array<float> &gamma, const array<float> &beta,
                           float eps = 1e-5f) const;
 
@@ -422,6 +490,9 @@ class array {
 
   void ensure_evaluated_() const;
   static void evaluate_node_(const std::shared_ptr<lazy_node> &node);
+  static void evaluate_unary_(lazy_node &node, const lazy_node &u,
+                              float post_scale, float post_offset);
+  static std::shared_ptr<lazy_node> to_node_(const array &a);
   static array make_lazy_op_(lazy_node::op o, const array &lhs, const array &rhs);
 
   static array from_node_(const std::shared_ptr<lazy_node> &n) {
@@ -437,6 +508,11 @@ class array {
   static array make_uninit_(const shape_type &shape);
 
   array materialize_() const;
+  // Swaps a buffer a checkpoint is still writing for a private copy
+  void detach_captured_();
+  // Strided views (inner-axis slices, transposes, broadcasts) as a packed
+  // copy, for kernels that read storage_ linearly
+  array packed_() const { return is_contiguous() ? *this : clone(); }
 
   //----------------------------------------------------------------------------
 
@@ -501,8 +577,9 @@ class array {
   static array mps_dot_operation_(const array &lhs, const array &rhs);
   static bool steel_eligible_(size_t M, size_t N, size_t K, bool tL, bool tR) {
     // STEEL supports edge tiles and K remainder. NN only.
-    // Minimum size: at least one full tile dimension for meaningful work.
-    return !tL && !tR && M >= 8 && N >= 8 && K >= 8;
+    // Minimum size (tuned, default 8): below it the simple kernel wins.
+    auto min_dim = tuning().steel_min_dim;
+    return !tL && !tR && M >= min_dim && N >= min_dim && K >= min_dim;
   }
   template <typename U>
   array dot_operation_(const array &rhs, U fn) const;
@@ -510,6 +587,10 @@ class array {
   template <typename CpuFn, typename GpuFn>
   array<float> unary_float_dispatch_(uint32_t op_id, CpuFn cpu_fn,
                                      GpuFn gpu_fn) const;
+
+  array<float> unary_(unary_op op, float lo = 0.0f, float hi = 0.0f) const;
+  array<float> unary_backward_(unary_op op, const array<float> &dout,
+                               float lo = 0.0f, float hi = 0.0f) const;
 };
 
 //----------------------------------------------------------------------------
@@ -563,6 +644,24 @@ auto ones(const shape_type &shape);
 
 auto random(const shape_type &shape);
 
+// Philox fills: reproducible for a given generator state, any thread count
+array<float> random_uniform(const shape_type &shape, float lo = 0.0f,
+                            float hi = 1.0f, philox &gen = default_generator());
+array<float> random_normal(const shape_type &shape, float mean = 0.0f,
+                           float stddev = 1.0f,
+                           philox &gen = default_generator());
+array<float> random_truncated_normal(const shape_type &shape,
+                                     float mean = 0.0f, float stddev = 1.0f,
+                                     philox &gen = default_generator());
+array<float> random_bernoulli(const shape_type &shape, float p,
+                              philox &gen = default_generator());
+
+// Zeroes each element with probability p and scales the rest by 1 / (1 - p);
+// the mask is generated on the fly. For the backward pass, restore the
+// generator's offset and apply dropout to dout.
+array<float> dropout(const array<float> &x, float p,
+                     philox &gen = default_generator());
+
 //-----------------------------------------------------------------------------
 // Implementation
 //-----------------------------------------------------------------------------
@@ -602,6 +701,56 @@ inline array<T>::array(T val) : array(shape_type({}), T{}) {
   *buffer_data() = val;
 }
 
+template <value_type T>
+inline array<T> array<T>::wrap(T *ptr, const shape_type &shape,
+                               const strides_type &strides,
+                               std::function<void(T *)> deleter) {
+  array tmp;
+  tmp.reshape(shape);
+  if (!strides.empty()) {
+    // 1D views are addressed as contiguous, so they need unit stride
+    if (strides.size() != shape.size() ||
+        (shape.size() == 1 && shape[0] > 1 && strides[0] != 1)) {
+      throw std::runtime_error("array: wrap strides don't match the shape.");
+    }
+    tmp.strides_ = strides;
+  }
+  if (!ptr || reinterpret_cast<uintptr_t>(ptr) % alignof(T)) {
+    throw std::runtime_error("array: wrap requires an aligned, non-null pointer.");
+  }
+
+  // Elements spanned from the first to the last addressed one
+  size_t span = tmp.element_count() ? 1 : 0;
+  for (size_t d = 0; span && d < shape.size(); d++) {
+    span += (shape[d] - 1) * tmp.strides_[d];
+  }
+
+  std::function<void()> release;
+  if (deleter) release = [ptr, deleter = std::move(deleter)] { deleter(ptr); };
+  if (!span) {
+    if (release) release();
+    tmp.allocate_buffer_();
+    return tmp;
+  }
+
+  tmp.storage_ = storage::adopt(ptr, span * sizeof(T), std::move(release));
+  if (tmp.storage_.mtl_buf) {
+    tmp.storage_.off = ptr - static_cast<T *>(tmp.storage_.data);
+  } else {
+    auto owned = storage::make(span * sizeof(T));
+    std::memcpy(owned.data, ptr, span * sizeof(T));
+    tmp.storage_ = owned;
+  }
+  tmp.storage_.len = span;
+  return tmp;
+}
+
+template <value_type T>
+inline array<T> array<T>::wrap(const T *ptr, const shape_type &shape,
+                               const strides_type &strides) {
+  return wrap(const_cast<T *>(ptr), shape, strides);
+}
+
 template <typename T>
 struct depth_ {
   static constexpr size_t value = 0;
@@ -732,12 +881,25 @@ inline size_t array<T>::buffer_bytes() const {
   return storage_.len * sizeof(T);
 }
 
+template <value_type T>
+inline long array<T>::use_count() const {
+  return storage_.buf.use_count();
+}
+
+template <value_type T>
+inline const void *array<T>::buffer_id() const {
+  return storage_.buf.get();
+}
+
 template <value_type T>
 inline auto *array<T>::buffer_data(this auto &&self) {
   self.ensure_evaluated_();
   if (gpu_pending_) gpu_context::instance().flush();
   constexpr bool is_const =
       std::is_const_v<std::remove_reference_t<decltype(self)>>;
+  // Every mutable access (at(), operator[], set(), kernels writing through
+  // the pointer) lands here, so this is where captured buffers are detached
+  if constexpr (!is_const) self.detach_captured_();
   using ptr_type = std::conditional_t<is_const, const T *, T *>;
   return static_cast<ptr_type>(self.storage_.data) + self.storage_.off;
 }
@@ -781,6 +943,16 @@ inline const strides_type &array<T>::strides() const {
   return strides_;
 }
 
+template <value_type T>
+inline bool array<T>::is_contiguous() const {
+  size_t expected = 1;
+  for (size_t d = dimension(); d-- > 0;) {
+    if (shape_[d] != 1 && strides_[d] != expected) return false;
+    expected *= shape_[d];
+  }
+  return true;
+}
+
 template <value_type T>
 inline void array<T>::reshape(const shape_type &shape) {
   shape_ = shape;
@@ -847,7 +1019,7 @@ inline array<T> array<T>::transpose() const {
       tmp.strides_ = {1};
       return tmp;
     }
-    // Zero-copy: cblas_sgemm / MPS handle transposed strides natively
+    // Zero-copy: cpu::sgemm / MPS handle transposed strides natively
     auto tmp = *this;
     tmp.node_.reset();
     tmp.shape_ = {shape_[1], shape_[0]};
@@ -887,11 +1059,14 @@ inline auto &array<T>::at(this auto &&self) {
 template <value_type T>
 inline auto &array<T>::at(this auto &&self, size_t i) {
   self.bounds_check_(i);
-  // Transposed 2D views have non-contiguous strides
-  if (self.dimension() == 2 && self.strides_[0] != self.shape_[1]) {
-    auto row = i / self.shape_[1];
-    auto col = i % self.shape_[1];
-    return self.buffer_data()[row * self.strides_[0] + col * self.strides_[1]];
+  // Transposed, sliced and broadcast views map through their strides
+  if (self.dimension() >= 2 && !self.is_contiguous()) {
+    size_t off = 0;
+    for (size_t d = self.dimension(); d-- > 0;) {
+      off += (i % self.shape_[d]) * self.strides_[d];
+      i /= self.shape_[d];
+    }
+    return self.buffer_data()[off];
   }
   return self.buffer_data()[i % self.buffer_element_count()];
 }
@@ -953,6 +1128,32 @@ inline array<T> array<T>::operator[](size_t row) const {
   return tmp;
 }
 
+template <value_type T>
+inline array<T> array<T>::rows(size_t begin, size_t end) const {
+  return slice(0, begin, end);
+}
+
+template <value_type T>
+inline array<T> array<T>::slice(size_t axis, size_t begin, size_t end) const {
+  if (axis >= dimension() || begin > end || end > shape_[axis]) {
+    throw std::runtime_error("array: slice is out of bounds.");
+  }
+
+  ensure_evaluated_();
+  array tmp(*this);
+  tmp.node_.reset();
+  tmp.shape_[axis] = end - begin;
+  tmp.storage_.off = storage_.off + strides_[axis] * begin;
+
+  // Elements spanned from the first to the last addressed one
+  size_t span = tmp.element_count() ? 1 : 0;
+  for (size_t d = 0; span && d < dimension(); d++) {
+    span += (tmp.shape_[d] - 1) * strides_[d];
+  }
+  tmp.storage_.len = span;
+  return tmp;
+}
+
 //----------------------------------------------------------------------------
 
 template <value_type T, bool IsConst>
@@ -1194,6 +1395,20 @@ inline auto array<T>::rows() const {
 
 template <value_type T>
 inline void array<T>::set(std::input_iterator auto it) {
+  using It = decltype(it);
+  if (is_contiguous()) {
+    // Straight into the buffer: one memcpy for matching contiguous sources,
+    // otherwise a converting loop over raw pointers instead of at()
+    T *p = buffer_data();
+    auto n = element_count();
+    if constexpr (std::contiguous_iterator<It> &&
+                  std::same_as<std::iter_value_t<It>, T>) {
+      if (n) std::memcpy(p, std::to_address(it), n * sizeof(T));
+    } else {
+      for (size_t i = 0; i < n; i++, ++it) p[i] = static_cast<T>(*it);
+    }
+    return;
+  }
 
   for (size_t i = 0; i < element_count(); i++) {
     at(i) = *it++;
@@ -1224,9 +1439,14 @@ inline void array<T>::ones() {
 
 template <value_type T>
 inline void array<T>::random() {
-  thread_local std::mt19937 gen(std::random_device{}());
-  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-  std::ranges::generate(buffer_span(), [&]() { return dist(gen); });
+  if constexpr (std::same_as<T, float>) {
+    default_generator().uniform(buffer_data(), buffer_element_count());
+  } else {
+    std::vector<float> tmp(buffer_element_count());
+    default_generator().uniform(tmp.data(), tmp.size());
+    std::ranges::transform(tmp, buffer_data(),
+                           [](float v) { return static_cast<T>(v); });
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -1334,6 +1554,7 @@ inline array<float> array<T>::unary_float_dispatch_(uint32_t op_id,
 
 template <value_type T>
 inline array<float> array<T>::sigmoid() const {
+  if (!is_contiguous()) return packed_().sigmoid();
   auto cpu_fn = [&] {
     auto tmp = array<float>::make_uninit_(shape_);
     if constexpr (std::same_as<T, float>) {
@@ -1356,6 +1577,9 @@ template <value_type T>
 inline array<float> array<T>::sigmoid_backward(const array<float> &dout) const {
   ensure_evaluated_();
   dout.ensure_evaluated_();
+  if (!is_contiguous() || !dout.is_contiguous()) {
+    return packed_().sigmoid_backward(dout.is_contiguous() ? dout : dout.clone());
+  }
 
   auto cpu_fn = [&] {
     auto tmp = array<float>::make_uninit_(shape_);
@@ -1426,6 +1650,7 @@ inline array<float> array<T>::linear_sigmoid(const array &W, const array &b) con
 
 template <value_type T>
 inline array<float> array<T>::relu() const {
+  if (!is_contiguous()) return packed_().relu();
   auto cpu_fn = [&] {
     auto tmp = array<float>::make_uninit_(shape_);
     if constexpr (std::same_as<T, float>) {
@@ -1444,6 +1669,154 @@ inline array<float> array<T>::relu() const {
   return unary_float_dispatch_(103, cpu_fn, gpu_fn);
 }
 
+template <value_type T>
+inline array<float> array<T>::unary_(unary_op op, float lo, float hi) const {
+  if constexpr (!std::same_as<T, float>) {
+    auto src = this->template clone<float>();
+    auto tmp = array<float>(shape_, 0.0f);
+    cpu::unary(op, src.buffer_data(), tmp.buffer_data(), tmp.element_count(),
+               {.lo = lo, .hi = hi});
+    return tmp;
+  } else {
+    // Deferred; evaluate_node_ folds scalar ops on either side into the
+    // kernel. Views that don't cover their storage in order are copied.
+    auto node = lazy_node::make_unary(
+        op, lo, hi, to_node_(is_contiguous() ? *this : clone()));
+    array a;
+    a.shape_ = node->shape;
+    a.strides_ = node->strides;
+    a.node_ = std::move(node);
+    return a;
+  }
+}
+
+template <value_type T>
+inline array<float> array<T>::unary_backward_(unary_op op,
+                                              const array<float> &dout,
+                                              float lo, float hi) const {
+  if (dout.shape() != shape_) {
+    throw std::runtime_error("array: backward gradient shape mismatch.");
+  }
+  auto args = unary_args{.lo = lo, .hi = hi};
+  auto g = dout.is_contiguous() ? dout : dout.clone();
+
+  if constexpr (!std::same_as<T, float>) {
+    auto src = this->template clone<float>();
+    auto tmp = array<float>(shape_, 0.0f);
+    cpu::unary_backward(op, g.buffer_data(), src.buffer_data(),
+                        tmp.buffer_data(), tmp.element_count(), args);
+    return tmp;
+  } else {
+    auto x = is_contiguous() ? *this : clone();
+    x.ensure_evaluated_();
+    g.ensure_evaluated_();
+    auto tmp = make_uninit_(shape_);
+    auto n = tmp.element_count();
+    switch (device_) {
+      case Device::CPU:
+        cpu::unary_backward(op, g.buffer_data(), x.buffer_data(),
+                            tmp.buffer_data(), n, args);
+        break;
+      case Device::MPS:
+        gpu::unary_backward(op, g.storage_, x.storage_, tmp.storage_, n, args);
+        break;
+    }
+    return tmp;
+  }
+}
+
+template <value_type T>
+inline array<float> array<T>::exp() const {
+  return unary_(unary_op::exp);
+}
+
+template <value_type T>
+inline array<float> array<T>::log() const {
+  return unary_(unary_op::log);
+}
+
+template <value_type T>
+inline array<float> array<T>::tanh() const {
+  return unary_(unary_op::tanh);
+}
+
+template <value_type T>
+inline array<float> array<T>::gelu() const {
+  return unary_(unary_op::gelu);
+}
+
+template <value_type T>
+inline array<float> array<T>::silu() const {
+  return unary_(unary_op::silu);
+}
+
+template <value_type T>
+inline array<float> array<T>::sqrt() const {
+  return unary_(unary_op::sqrt);
+}
+
+template <value_type T>
+inline array<float> array<T>::rsqrt() const {
+  return unary_(unary_op::rsqrt);
+}
+
+template <value_type T>
+inline array<float> array<T>::abs() const {
+  return unary_(unary_op::abs);
+}
+
+template <value_type T>
+inline array<float> array<T>::clamp(float lo, float hi) const {
+  if (lo > hi) throw std::runtime_error("array: clamp requires lo <= hi.");
+  return unary_(unary_op::clamp, lo, hi);
+}
+
+template <value_type T>
+inline array<float> array<T>::exp_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::exp, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::log_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::log, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::tanh_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::tanh, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::gelu_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::gelu, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::silu_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::silu, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::sqrt_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::sqrt, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::rsqrt_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::rsqrt, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::abs_backward(const array<float> &dout) const {
+  return unary_backward_(unary_op::abs, dout);
+}
+
+template <value_type T>
+inline array<float> array<T>::clamp_backward(const array<float> &dout,
+                                             float lo, float hi) const {
+  return unary_backward_(unary_op::clamp, dout, lo, hi);
+}
+
 template <value_type T>
 inline array<float> array<T>::layer_norm(const array<float> &gamma,
                                          const array<float> &beta,
@@ -1492,6 +1865,7 @@ inline array<float> array<T>::layer_norm(const array<float> &gamma,
 template <value_type T>
 inline T array<T>::sum() const {
   ensure_evaluated_();
+  if (!is_contiguous()) return packed_().sum();
   auto cpu_sum = [&]() -> T {
     auto sp = buffer_span();
     if (sp.size() == element_count()) {
@@ -1512,10 +1886,12 @@ inline T array<T>::sum() const {
       return cpu::sum<float>(partial.buffer_data(), actual_tg);
     };
 
-    constexpr size_t kGpuSumThreshold = 5'000'000;
     switch (device_) {
       case Device::CPU: return cpu_sum();
-      case Device::MPS: return gpu_sum();
+      case Device::MPS:
+        // Small inputs: dispatch + sync costs more than a CPU reduction
+        if (element_count() < tuning().gpu_sum_threshold) return cpu_sum();
+        return gpu_sum();
     }
   }
 }
@@ -1527,7 +1903,7 @@ inline array<T> array<T>::sum(size_t axis) const {
 
   auto tmp = array(s, T{});
 
-  if (dimension() == 2 && axis == 0 &&
+  if (dimension() == 2 && axis == 0 && is_contiguous() &&
       buffer_element_count() == element_count()) {
     cpu::sum_axis0<T>(buffer_data(), tmp.buffer_data(),
                       shape_[0], shape_[1]);
@@ -1561,11 +1937,9 @@ inline array<float> array<T>::mean(size_t axis) const {
 template <value_type T>
 inline T array<T>::min() const {
   ensure_evaluated_();
+  if (!is_contiguous()) return packed_().min();
   if constexpr (std::same_as<T, float>) {
-    float result;
-    vDSP_Length index;
-    vDSP_minvi(buffer_data(), 1, &result, &index, buffer_element_count());
-    return result;
+    return cpu::min(buffer_data(), buffer_element_count());
   } else {
     return *std::ranges::min_element(buffer_span());
   }
@@ -1574,11 +1948,9 @@ inline T array<T>::min() const {
 template <value_type T>
 inline T array<T>::max() const {
   ensure_evaluated_();
+  if (!is_contiguous()) return packed_().max();
   if constexpr (std::same_as<T, float>) {
-    float result;
-    vDSP_Length index;
-    vDSP_maxvi(buffer_data(), 1, &result, &index, buffer_element_count());
-    return result;
+    return cpu::max(buffer_data(), buffer_element_count());
   } else {
     return *std::ranges::max_element(buffer_span());
   }
@@ -1586,23 +1958,27 @@ inline T array<T>::max() const {
 
 template <value_type T>
 inline size_t array<T>::count() const {
+  if (!is_contiguous()) return packed_().count();
   return std::ranges::count_if(buffer_span(), [](T v) { return !!v; });
 }
 
 template <value_type T>
 inline bool array<T>::all(arithmetic auto val) const {
+  if (!is_contiguous()) return packed_().all(val);
   return std::ranges::all_of(buffer_span(), [val](T v) { return v == val; });
 }
 
 template <value_type T>
 template <typename U>
 inline bool array<T>::all(U fn) const {
+  if (!is_contiguous()) return packed_().all(fn);
   return std::ranges::all_of(buffer_span(), fn);
 }
 
 template <value_type T>
 inline array<float> array<T>::softmax() const {
   ensure_evaluated_();
+  if (!is_contiguous()) return packed_().softmax();
   if (dimension() == 1) {
     auto c = min();
     auto tmp = array<float>(shape_, 0.0);
@@ -1633,6 +2009,12 @@ inline array<float> array<T>::softmax() const {
     if constexpr (!std::same_as<T, float>) {
       return cpu_softmax();
     } else {
+      auto cpu_fast_softmax = [&] {
+        auto src = strides_[0] == shape_[1] ? *this : clone();
+        auto tmp = array<float>::make_uninit_(shape_);
+        cpu::softmax(src.buffer_data(), tmp.buffer_data(), shape_[0], shape_[1]);
+        return tmp;
+      };
       auto gpu_softmax = [&] {
         auto tmp = array<float>::make_uninit_(shape_);
         gpu::softmax(storage_, tmp.storage_,
@@ -1642,7 +2024,7 @@ inline array<float> array<T>::softmax() const {
       };
 
       switch (device_) {
-        case Device::CPU: return cpu_softmax();
+        case Device::CPU: return cpu_fast_softmax();
         case Device::MPS: return gpu_softmax();
       }
     }
@@ -1657,9 +2039,10 @@ inline auto array<T>::argmax() const {
   if (dimension() == 2) {
     auto row_count = shape_[0];
     auto tmp = array<int>({row_count}, 0);
+    auto src = packed_();
 
     for (size_t i = 0; i < row_count; i++) {
-      const auto row = (*this)[i];
+      const auto row = src[i];
 
       size_t max_index = 0;
       {
@@ -1683,6 +2066,17 @@ inline auto array<T>::argmax() const {
 
 template <value_type T>
 inline float array<T>::mean_square_error(const array &rhs) const {
+  if constexpr (std::same_as<T, float>) {
+    // Same shape: one reduction pass instead of two temporaries
+    if (shape_ == rhs.shape_ && element_count() > 0) {
+      auto a = is_contiguous() ? *this : clone();
+      auto b = rhs.is_contiguous() ? rhs : rhs.clone();
+      auto n = element_count();
+      return static_cast<float>(
+          cpu::squared_error(a.buffer_data(), b.buffer_data(), nullptr, n,
+                             0.0f) / n);
+    }
+  }
   return (*this - rhs).pow(2).mean();
 }
 
@@ -1691,8 +2085,13 @@ template <value_type U>
 inline array<U> array<T>::one_hot(size_t class_count) const {
   if (dimension() == 1) {
     auto tmp = array<U>({shape_[0], class_count}, U{});
+    auto *p = tmp.buffer_data();
     for (size_t i = 0; i < element_count(); i++) {
-      tmp[i, at(i)] = 1;
+      auto v = at(i);
+      if (v < 0 || static_cast<size_t>(v) >= class_count) {
+        throw std::runtime_error("array: one_hot label is out of range.");
+      }
+      p[i * class_count + static_cast<size_t>(v)] = U(1);
     }
     return tmp;
   }
@@ -1815,16 +2214,13 @@ inline float scalar_val(const storage &s) {
   return static_cast<const float *>(s.data)[s.off];
 }
 
-// Reduce a chain of scalar ops on a vector to out[i] = vec[i] * scale + offset.
-// Returns false if the tree contains non-scalar operands (falls back to per-node).
-inline bool try_affine_reduce(const lazy_node &node,
-                              const float *&vec_ptr, size_t &vec_len,
-                              const storage *&vec_storage,
+// Reduce a chain of scalar ops to out[i] = base[i] * scale + offset, where
+// base is an evaluated vector or a deferred unary op. Returns false if the
+// tree contains non-scalar operands (falls back to per-node).
+inline bool try_affine_reduce(const lazy_node &node, const lazy_node *&base,
                               float &scale, float &offset) {
-  if (node.evaluated) {
-    vec_ptr = static_cast<const float *>(node.data.data) + node.data.off;
-    vec_len = node.data.len;
-    vec_storage = &node.data;
+  if (node.evaluated || node.operation == lazy_node::op::unary) {
+    base = &node;
     scale = 1.0f;
     offset = 0.0f;
     return true;
@@ -1834,27 +2230,27 @@ inline bool try_affine_reduce(const lazy_node &node,
   auto lhs_scalar = node.lhs->evaluated && node.lhs->data.len == 1;
 
   if (rhs_scalar) {
-    if (!try_affine_reduce(*node.lhs, vec_ptr, vec_len, vec_storage, scale, offset))
-      return false;
+    if (!try_affine_reduce(*node.lhs, base, scale, offset)) return false;
     auto r = scalar_val(node.rhs->data);
     switch (node.operation) {
       case lazy_node::op::add: offset += r; break;
       case lazy_node::op::sub: offset -= r; break;
       case lazy_node::op::mul: scale *= r; offset *= r; break;
       case lazy_node::op::div: scale /= r; offset /= r; break;
+      case lazy_node::op::unary: return false;
     }
     return true;
   }
 
   if (lhs_scalar) {
-    if (!try_affine_reduce(*node.rhs, vec_ptr, vec_len, vec_storage, scale, offset))
-      return false;
+    if (!try_affine_reduce(*node.rhs, base, scale, offset)) return false;
     auto l = scalar_val(node.lhs->data);
     switch (node.operation) {
       case lazy_node::op::add: offset += l; break;
       case lazy_node::op::sub: scale = -scale; offset = l - offset; break;
       case lazy_node::op::mul: scale *= l; offset *= l; break;
       case lazy_node::op::div: return false;  // scalar / chain is not affine
+      case lazy_node::op::unary: return false;
     }
     return true;
   }
@@ -1868,34 +2264,33 @@ template <value_type T>
 inline void array<T>::evaluate_node_(const std::shared_ptr<lazy_node> &node) {
   if (node->evaluated) return;
 
-  // Affine fusion for float: chain of scalar ops → single vDSP/NEON pass
+  // Affine fusion for float: chain of scalar ops → single affine kernel pass
   if constexpr (std::same_as<T, float>) {
-    const float *vec_ptr = nullptr;
-    auto vec_len = size_t{0};
-    const storage *vec_st = nullptr;
+    if (node->operation == lazy_node::op::unary) {
+      evaluate_unary_(*node, *node, 1.0f, 0.0f);
+      return;
+    }
+
+    const lazy_node *base = nullptr;
     auto scale = 1.0f, offset = 0.0f;
 
-    if (detail::try_affine_reduce(*node, vec_ptr, vec_len, vec_st, scale, offset)) {
+    if (detail::try_affine_reduce(*node, base, scale, offset)) {
+      // A unary op at the bottom of the chain takes it as its epilogue
+      if (!base->evaluated) {
+        evaluate_unary_(*node, *base, scale, offset);
+        return;
+      }
+
       auto result = make_uninit_(node->shape);
       auto n = result.element_count();
+      auto &vec = base->data;
 
       // GPU path: avoid CPU-GPU sync when GPU commands are pending
-      if (gpu_pending_ && vec_st->mtl_buf) {
-        gpu::affine(*vec_st, result.storage_, n, scale, offset);
+      if (gpu_pending_ && vec.mtl_buf) {
+        gpu::affine(vec, result.storage_, n, scale, offset);
       } else {
-        auto *out = result.buffer_data();
-        constexpr size_t kNeonAffineThreshold = 5'000'000;
-        if (n >= kNeonAffineThreshold) {
-          cpu::affine(vec_ptr, out, n, scale, offset);
-        } else if (scale == 1.0f && offset == 0.0f) {
-          memcpy(out, vec_ptr, n * sizeof(float));
-        } else if (offset == 0.0f) {
-          vDSP_vsmul(vec_ptr, 1, &scale, out, 1, n);
-        } else if (scale == 1.0f) {
-          vDSP_vsadd(vec_ptr, 1, &offset, out, 1, n);
-        } else {
-          vDSP_vsmsa(vec_ptr, 1, &scale, &offset, out, 1, n);
-        }
+        cpu::affine(static_cast<const float *>(vec.data) + vec.off,
+                    result.buffer_data(), n, scale, offset);
       }
 
       node->data = result.storage_;
@@ -1918,6 +2313,7 @@ inline void array<T>::evaluate_node_(const std::shared_ptr<lazy_node> &node) {
     case lazy_node::op::sub: ope = ArithmeticOperation::Sub; break;
     case lazy_node::op::mul: ope = ArithmeticOperation::Mul; break;
     case lazy_node::op::div: ope = ArithmeticOperation::Div; break;
+    case lazy_node::op::unary: break;  // float only, handled above
   }
 
   auto result = arithmetic_operation_(lhs, rhs, ope);
@@ -1929,18 +2325,56 @@ inline void array<T>::evaluate_node_(const std::shared_ptr<lazy_node> &node) {
   node->evaluated = true;
 }
 
+// node = f(u's input) * post_scale + post_offset in one kernel pass; node is
+// u itself or the top of a scalar chain over u
+template <value_type T>
+inline void array<T>::evaluate_unary_(lazy_node &node, const lazy_node &u,
+                                      float post_scale, float post_offset) {
+  // A scalar chain feeding the op becomes its prologue
+  auto args = unary_args{.post_scale = post_scale,
+                         .post_offset = post_offset,
+                         .lo = u.lo,
+                         .hi = u.hi};
+  const lazy_node *base = nullptr;
+  if (!detail::try_affine_reduce(*u.lhs, base, args.scale, args.offset) ||
+      !base->evaluated) {
+    evaluate_node_(u.lhs);
+    base = u.lhs.get();
+    args.scale = 1.0f;
+    args.offset = 0.0f;
+  }
+
+  auto result = make_uninit_(node.shape);
+  auto n = result.element_count();
+  auto &in = base->data;
+  if ((device_ == Device::MPS || gpu_pending_) && in.mtl_buf) {
+    gpu::unary(u.fn, in, result.storage_, n, args);
+  } else {
+    cpu::unary(u.fn, static_cast<const float *>(in.data) + in.off,
+               result.buffer_data(), n, args);
+  }
+
+  node.data = result.storage_;
+  node.strides = result.strides_;
+  node.lhs.reset();  // u is node or one of its descendants
+  node.rhs.reset();
+  node.evaluated = true;
+}
+
+template <value_type T>
+inline std::shared_ptr<lazy_node> array<T>::to_node_(const array &a) {
+  if (a.node_ && !a.node_->evaluated) return a.node_;
+  // storage_ may be stale if node was evaluated via another copy of this array
+  if (a.node_ && a.node_->evaluated)
+    return lazy_node::leaf(a.node_->data, a.node_->shape, a.node_->strides);
+  return lazy_node::leaf(a.storage_, a.shape_, a.strides_);
+}
+
 template <value_type T>
 inline array<T> array<T>::make_lazy_op_(lazy_node::op o, const array &lhs,
                                         const array &rhs) {
-  auto to_node = [](const array &a) {
-    if (a.node_ && !a.node_->evaluated) return a.node_;
-    // storage_ may be stale if node was evaluated via another copy of this array
-    if (a.node_ && a.node_->evaluated)
-      return lazy_node::leaf(a.node_->data, a.node_->shape, a.node_->strides);
-    return lazy_node::leaf(a.storage_, a.shape_, a.strides_);
-  };
-  auto lnode = to_node(lhs);
-  auto rnode = to_node(rhs);
+  auto lnode = to_node_(lhs.packed_());
+  auto rnode = to_node_(rhs.packed_());
 
   auto out_shape = broadcast_shape(lhs.shape_, rhs.shape_);
   auto out_strides = contiguous_strides(out_shape);
@@ -1990,6 +2424,19 @@ inline array<T> array<T>::materialize_() const {
   return tmp;
 }
 
+template <value_type T>
+inline void array<T>::detach_captured_() {
+  if (use_count() <= 1 ||
+      !detail::capture_set::instance().contains(buffer_id())) {
+    return;
+  }
+  auto copy = storage::make(storage_.len * sizeof(T));
+  std::memcpy(copy.data, static_cast<const T *>(storage_.data) + storage_.off,
+              storage_.len * sizeof(T));
+  copy.len = storage_.len;
+  storage_ = copy;
+}
+
 //----------------------------------------------------------------------------
 
 template <typename T>
@@ -2083,8 +2530,13 @@ template <value_type T>
 inline auto array<T>::broadcast_(const array &lhs, const array &rhs, auto cb) {
   lhs.ensure_evaluated_();
   rhs.ensure_evaluated_();
-  if (lhs.shape() == rhs.shape()) {
+  auto packed = lhs.is_contiguous() && rhs.is_contiguous();
+  if (packed && lhs.shape() == rhs.shape()) {
     return cb(lhs, rhs);
+  } else if (!packed) {
+    // Kernels index storage linearly (modulo the shorter operand), so
+    // strided operands are packed before they are broadcast
+    return broadcast_(lhs.packed_(), rhs.packed_(), cb);
   } else if (lhs.dimension() < rhs.dimension()) {
     return cb(lhs.broadcast(rhs.shape()), rhs);
   } else if (lhs.dimension() > rhs.dimension()) {
@@ -2171,7 +2623,12 @@ inline auto array<T>::cpu_arithmetic_operation_(const array &lhs,
 template <value_type T>
 inline void array<T>::cpu_arithmetic_inplace_(const array &rhs,
                                                     ArithmeticOperation ope) {
-  if (shape() == rhs.shape() || rhs.element_count() <= element_count()) {
+  // A buffer a checkpoint is still writing gets replaced, not overwritten;
+  // so is a strided view, which the kernels can't write through
+  auto captured = use_count() > 1 &&
+                  detail::capture_set::instance().contains(buffer_id());
+  if (!captured && is_contiguous() && rhs.is_contiguous() &&
+      (shape() == rhs.shape() || rhs.element_count() <= element_count())) {
     cpu_arithmetic_dispatch_(storage_, rhs.storage_, storage_, ope);
   } else {
     *this = cpu_arithmetic_operation_(*this, rhs, ope);
@@ -2239,17 +2696,16 @@ inline array<T> array<T>::cpu_dot_operation_(const array &lhs,
   auto tmp = make_uninit_({M, N});
 
   if constexpr (std::same_as<T, float>) {
-    auto tA = lhs.strides_[0] < lhs.strides_[1] ? CblasTrans : CblasNoTrans;
-    auto tB = rhs.strides_[0] < rhs.strides_[1] ? CblasTrans : CblasNoTrans;
-    // For NoTrans: lda = cols (K or N). For Trans: lda = physical row width.
-    auto ldA = static_cast<int>(tA == CblasTrans ? lhs.strides_[1] : K);
-    auto ldB = static_cast<int>(tB == CblasTrans ? rhs.strides_[1] : N);
+    auto tA = lhs.strides_[0] < lhs.strides_[1];
+    auto tB = rhs.strides_[0] < rhs.strides_[1];
+    // lda is the physical row width: cols, or wider for column slices.
+    auto ldA = tA ? lhs.strides_[1] : std::max(lhs.strides_[0], K);
+    auto ldB = tB ? rhs.strides_[1] : std::max(rhs.strides_[0], N);
 
     auto *a = static_cast<const float *>(lhs.storage_.data) + lhs.storage_.off;
     auto *b = static_cast<const float *>(rhs.storage_.data) + rhs.storage_.off;
     auto *c = static_cast<float *>(tmp.storage_.data) + tmp.storage_.off;
-    cblas_sgemm(CblasRowMajor, tA, tB, M, N, K, 1.0f,
-                a, ldA, b, ldB, 0.0f, c, N);
+    cpu::sgemm(tA, tB, M, N, K, a, ldA, b, ldB, c, N);
   } else {
     cpu::dot<T>(lhs.storage_, rhs.storage_, tmp.storage_, K, M, N);
   }
@@ -2433,4 +2889,40 @@ inline auto random(const shape_type &shape) {
   return tmp;
 }
 
+inline array<float> random_uniform(const shape_type &shape, float lo,
+                                   float hi, philox &gen) {
+  auto tmp = array<float>(shape, 0.0f);
+  gen.uniform(tmp.buffer_data(), tmp.element_count(), lo, hi);
+  return tmp;
+}
+
+inline array<float> random_normal(const shape_type &shape, float mean,
+                                  float stddev, philox &gen) {
+  auto tmp = array<float>(shape, 0.0f);
+  gen.normal(tmp.buffer_data(), tmp.element_count(), mean, stddev);
+  return tmp;
+}
+
+inline array<float> random_truncated_normal(const shape_type &shape,
+                                            float mean, float stddev,
+                                            philox &gen) {
+  auto tmp = array<float>(shape, 0.0f);
+  gen.truncated_normal(tmp.buffer_data(), tmp.element_count(), mean, stddev);
+  return tmp;
+}
+
+inline array<float> random_bernoulli(const shape_type &shape, float p,
+                                     philox &gen) {
+  auto tmp = array<float>(shape, 0.0f);
+  gen.bernoulli(tmp.buffer_data(), tmp.element_count(), p);
+  return tmp;
+}
+
+inline array<float> dropout(const array<float> &x, float p, philox &gen) {
+  auto src = x.is_contiguous() ? x : x.clone();
+  auto tmp = array<float>(x.shape(), 0.0f);
+  gen.dropout(src.buffer_data(), tmp.buffer_data(), tmp.element_count(), p);
+  return tmp;
+}
+
 };  // namespace sil
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Attention
+//-----------------------------------------------------------------------------
+
+// Optional additive bias (seq_q, seq_k) or (heads, seq_q, seq_k) — use
+// -infinity to hide a key — and/or a causal mask. With seq_k > seq_q (e.g.
+// decoding against a cache) query i sits at position seq_k - seq_q + i.
+struct attention_mask {
+  array<float> bias;
+  bool is_causal = false;
+
+  attention_mask() = default;
+  attention_mask(array<float> b) : bias(std::move(b)) {}
+
+  static attention_mask causal() {
+    attention_mask m;
+    m.is_causal = true;
+    return m;
+  }
+
+  bool has_bias() const { return bias.dimension() > 0; }
+};
+
+// softmax(Q Kᵀ · scale + mask) V for Q (seq_q, d), K (seq_k, d), V (seq_k, d_v)
+// or the same with a leading heads axis. scale = 0 means 1 / sqrt(d).
+// On the CPU this is a tiled online-softmax kernel that never materializes
+// the score matrix; on MPS non-causal 2D inputs (bias included) run as
+// dot/softmax/dot.
+array<float> scaled_dot_product_attention(const array<float> &Q,
+                                          const array<float> &K,
+                                          const array<float> &V,
+                                          const attention_mask &mask = {},
+                                          float scale = 0.0f);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+constexpr size_t kAttentionBlockQ = 32;
+constexpr size_t kAttentionBlockK = 64;
+
+struct attention_shape_ {
+  size_t heads, seq_q, seq_k, d, dv;
+};
+
+// Rows of the causal/bias-masked score block for queries [q0, q0 + bq) and
+// keys [k0, k0 + bk) of one head, accumulated into (o, m, l). `k` and `v`
+// point at key row k0.
+inline void attention_block_(const float *q, const float *k, const float *v,
+                             const float *bias, size_t bias_ld, bool causal,
+                             const attention_shape_ &s, float scale,
+                             size_t q0, size_t bq, size_t k0, size_t bk,
+                             float *scores, float *pv, float *o, float *m,
+                             float *l) {
+  constexpr auto kNegInf = -std::numeric_limits<float>::infinity();
+  auto offset = s.seq_k - s.seq_q;
+
+  // S = Q_blk · K_blkᵀ
+  cpu::sgemm(false, true, bq, bk, s.d, q + q0 * s.d, s.d, k, s.d, scores, bk);
+
+  for (size_t i = 0; i < bq; i++) {
+    float *row = scores + i * bk;
+    cpu::affine(row, row, bk, scale, 0.0f);
+    if (bias) {
+      const float *b = bias + (q0 + i) * bias_ld + k0;
+      for (size_t j = 0; j < bk; j++) row[j] += b[j];
+    }
+    if (causal) {
+      auto last = offset + q0 + i;  // last visible key
+      for (size_t j = 0; j < bk; j++)
+        if (k0 + j > last) row[j] = kNegInf;
+    }
+
+    // Online softmax: rescale the running sum and output by exp(m - m_new)
+    auto m_new = std::max(m[i], cpu::max(row, bk));
+    if (m_new == kNegInf) {
+      std::fill(row, row + bk, 0.0f);
+      continue;
+    }
+    // exp(row - m_new) through the active tier's kernel
+    cpu::kernels().unary(unary_op::exp, row, row, bk, {.offset = -m_new});
+
+    auto corr = std::exp(m[i] - m_new);
+    l[i] = l[i] * corr + cpu::sum<float>(row, bk);
+    m[i] = m_new;
+    if (corr != 1.0f) cpu::affine(o + i * s.dv, o + i * s.dv, s.dv, corr, 0.0f);
+  }
+
+  // O_blk += P · V_blk
+  cpu::sgemm(false, false, bq, s.dv, bk, scores, bk, v, s.dv, pv, s.dv);
+  cpu::kernels().add(o, bq * s.dv, pv, bq * s.dv, o, bq * s.dv);
+}
+
+// Contiguous run of key/value rows starting at some key index
+struct attention_kv_run_ {
+  const float *k;
+  const float *v;
+  size_t rows;
+};
+
+// Queries [q0, q0 + bq) of one head against all visible keys. `kv_at(k0)`
+// returns the run of rows holding key k0, so keys may live in separate
+// blocks (see kv_cache).
+template <typename KVAt>
+inline void attention_query_block_(const float *q, const float *bias,
+                                   bool causal, const attention_shape_ &s,
+                                   float scale, size_t q0, size_t bq,
+                                   KVAt &&kv_at, float *o) {
+  thread_local std::vector<float> scratch;
+  scratch.resize(kAttentionBlockQ * (kAttentionBlockK + s.dv + 2));
+  float *scores = scratch.data();
+  float *pv = scores + kAttentionBlockQ * kAttentionBlockK;
+  float *m = pv + kAttentionBlockQ * s.dv;
+  float *l = m + kAttentionBlockQ;
+
+  std::fill(o, o + bq * s.dv, 0.0f);
+  std::fill(m, m + bq, -std::numeric_limits<float>::infinity());
+  std::fill(l, l + bq, 0.0f);
+
+  // Causal: keys past the block's last query are never visible
+  auto offset = s.seq_k - s.seq_q;
+  auto k_end = causal ? std::min(s.seq_k, offset + q0 + bq) : s.seq_k;
+  for (size_t k0 = 0; k0 < k_end;) {
+    attention_kv_run_ run = kv_at(k0);
+    auto bk = std::min({kAttentionBlockK, k_end - k0, run.rows});
+    attention_block_(q, run.k, run.v, bias, s.seq_k, causal, s, scale, q0, bq,
+                     k0, bk, scores, pv, o, m, l);
+    k0 += bk;
+  }
+
+  for (size_t i = 0; i < bq; i++) {
+    auto inv = l[i] > 0.0f ? 1.0f / l[i] : 0.0f;
+    cpu::affine(o + i * s.dv, o + i * s.dv, s.dv, inv, 0.0f);
+  }
+}
+
+inline void attention_forward_(const float *Q, const float *K, const float *V,
+                               const float *bias, bool bias_per_head,
+                               bool causal, const attention_shape_ &s,
+                               float scale, float *out) {
+  auto q_blocks = (s.seq_q + kAttentionBlockQ - 1) / kAttentionBlockQ;
+
+  // One task per (head, query block); each owns its slice of `out`
+  parallel_for(s.heads * q_blocks, [&](size_t task) {
+    auto h = task / q_blocks;
+    auto q0 = (task % q_blocks) * kAttentionBlockQ;
+    auto bq = std::min(kAttentionBlockQ, s.seq_q - q0);
+
+    const float *k = K + h * s.seq_k * s.d;
+    const float *v = V + h * s.seq_k * s.dv;
+    const float *b = bias && bias_per_head ? bias + h * s.seq_q * s.seq_k : bias;
+    auto kv_at = [&](size_t k0) {
+      return attention_kv_run_{k + k0 * s.d, v + k0 * s.dv, s.seq_k - k0};
+    };
+    attention_query_block_(Q + h * s.seq_q * s.d, b, causal, s, scale, q0, bq,
+                           kv_at, out + (h * s.seq_q + q0) * s.dv);
+  });
+}
+
+inline array<float> attention_contiguous_(const array<float> &a) {
+  return a.is_contiguous() ? a : a.clone();
+}
+
+}  // namespace detail
+
+inline array<float> scaled_dot_product_attention(const array<float> &Q,
+                                                 const array<float> &K,
+                                                 const array<float> &V,
+                                                 const attention_mask &mask,
+                                                 float scale) {
+  auto dim = Q.dimension();
+  if ((dim != 2 && dim != 3) || K.dimension() != dim || V.dimension() != dim) {
+    throw std::runtime_error(
+        "array: scaled_dot_product_attention requires 2D or 3D Q, K and V.");
+  }
+
+  auto &qs = Q.shape(), &ks = K.shape(), &vs = V.shape();
+  auto s = dim == 2
+               ? detail::attention_shape_{1, qs[0], ks[0], qs[1], vs[1]}
+               : detail::attention_shape_{qs[0], qs[1], ks[1], qs[2], vs[2]};
+  auto kd = ks[dim - 1], kseq = vs[dim - 2];
+  auto same_heads = dim == 2 || (ks[0] == s.heads && vs[0] == s.heads);
+  if (kd != s.d || kseq != s.seq_k || !same_heads ||
+      (mask.is_causal && s.seq_k < s.seq_q)) {
+    throw std::runtime_error(
+        "array: scaled_dot_product_attention shape mismatch.");
+  }
+  if (scale == 0.0f) scale = 1.0f / std::sqrt(static_cast<float>(s.d));
+
+  auto bias_per_head = false;
+  if (mask.has_bias()) {
+    auto &bs = mask.bias.shape();
+    auto plane = bs.size() >= 2 && bs[bs.size() - 2] == s.seq_q &&
+                 bs[bs.size() - 1] == s.seq_k;
+    bias_per_head = bs.size() == 3 && dim == 3 && bs[0] == s.heads;
+    if (!plane || (bs.size() == 3 && !bias_per_head) || bs.size() > 3) {
+      throw std::runtime_error(
+          "array: scaled_dot_product_attention mask shape mismatch.");
+    }
+  }
+
+  // MPS: keep non-causal 2D attention, with or without a bias, on the GPU
+  // as three dispatches
+  if (device_ == Device::MPS && dim == 2 && !mask.is_causal) {
+    auto scores = Q.dot(K.transpose()) * scale;
+    if (mask.has_bias()) scores = scores + mask.bias;
+    return scores.softmax().dot(V);
+  }
+
+  auto q = detail::attention_contiguous_(Q);
+  auto k = detail::attention_contiguous_(K);
+  auto v = detail::attention_contiguous_(V);
+  auto bias = mask.has_bias() ? detail::attention_contiguous_(mask.bias)
+                              : array<float>();
+
+  auto out = array<float>(dim == 2 ? shape_type{s.seq_q, s.dv}
+                                   : shape_type{s.heads, s.seq_q, s.dv},
+                          0.0f);
+  detail::attention_forward_(q.buffer_data(), k.buffer_data(), v.buffer_data(),
+                             mask.has_bias() ? bias.buffer_data() : nullptr,
+                             bias_per_head, mask.is_causal, s, scale,
+                             out.buffer_data());
+  return out;
+}
+
+};  // namespace sil
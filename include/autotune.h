@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cpu.h>
+#include <gpu.h>
+#include <tuning.h>
+
+#include <chrono>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Autotuner
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Best-of-`reps` wall time in seconds, after one warm-up call
+template <typename F>
+inline double autotune_time_(F &&fn, int reps = 5) {
+  fn();
+  auto best = std::numeric_limits<double>::max();
+  for (int i = 0; i < reps; i++) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    auto t1 = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+  }
+  return best;
+}
+
+// Smallest size from which `candidate(n)` beats `baseline(n)` for every
+// larger size in the sweep; max() when it never wins at the top end.
+template <typename Candidate, typename Baseline>
+inline size_t autotune_crossover_(std::initializer_list<size_t> sizes,
+                                  Candidate &&candidate, Baseline &&baseline) {
+  auto crossover = std::numeric_limits<size_t>::max();
+  std::vector<size_t> sweep(sizes);
+  for (auto it = sweep.rbegin(); it != sweep.rend(); ++it) {
+    auto n = *it;
+    auto tc = autotune_time_([&] { candidate(n); });
+    auto tb = autotune_time_([&] { baseline(n); });
+    if (tc >= tb) break;
+    crossover = n;
+  }
+  return crossover;
+}
+
+inline float *autotune_fill_(storage &s, size_t n) {
+  auto *p = static_cast<float *>(s.data);
+  for (size_t i = 0; i < n; i++) p[i] = float(i % 251) / 251.0f - 0.5f;
+  s.len = n;
+  return p;
+}
+
+inline void autotune_cpu_(tuning_params &t) {
+  constexpr size_t kMax = 1 << 24;
+  auto a_st = storage::make(kMax * sizeof(float));
+  auto b_st = storage::make(kMax * sizeof(float));
+  auto o_st = storage::make(kMax * sizeof(float));
+  auto *a = autotune_fill_(a_st, kMax);
+  auto *b = autotune_fill_(b_st, kMax);
+  auto *out = static_cast<float *>(o_st.data);
+  auto &k = cpu::kernels();
+
+  // Single vs multi-threaded: memory-bound add and compute-bound sigmoid
+  auto threaded = [&](auto fn) {
+    return [&, fn](size_t n) {
+      parallel_chunks(n, kParallelGrain,
+                      [&](size_t s, size_t e) { fn(s, e); });
+    };
+  };
+  auto add = [&](size_t s, size_t e) {
+    k.add(a + s, e - s, b + s, e - s, out + s, e - s);
+  };
+  auto sig = [&](size_t s, size_t e) { k.sigmoid(a + s, out + s, e - s); };
+  auto sizes = {size_t(1) << 16, size_t(1) << 18, size_t(1) << 20,
+                size_t(1) << 22, kMax};
+  t.parallel_threshold = std::max(
+      autotune_crossover_(sizes, threaded(add), [&](size_t n) { add(0, n); }),
+      autotune_crossover_(sizes, threaded(sig), [&](size_t n) { sig(0, n); }));
+
+  // Affine: single-pass NEON FMA vs vDSP_vsmsa
+  float scale = 1.5f, offset = 0.25f;
+  t.neon_affine_threshold = autotune_crossover_(
+      sizes,
+      [&](size_t n) { neon_kernels::affine(a, out, n, scale, offset); },
+      [&](size_t n) { vDSP_vsmsa(a, 1, &scale, &offset, out, 1, n); });
+
+  // Packed GEMM cache blocking for the scalar/NEON tiers
+  constexpr size_t kDim = 384;
+  auto best = std::numeric_limits<double>::max();
+  for (size_t mc : {64, 128, 256}) {
+    for (size_t kc : {128, 256, 512}) {
+      tuning().gemm_mc = mc;
+      tuning().gemm_kc = kc;
+      auto time = autotune_time_([&] {
+        neon_kernels::sgemm(false, false, kDim, kDim, kDim, a, kDim, b, kDim,
+                            out, kDim);
+      }, 3);
+      if (time < best) best = time, t.gemm_mc = mc, t.gemm_kc = kc;
+    }
+  }
+}
+
+inline void autotune_gpu_(tuning_params &t) {
+  constexpr size_t kMax = 1 << 24;
+  auto in = storage::make(kMax * sizeof(float));
+  auto partial = storage::make(gpu::sum_f32_num_tg(kMax) * sizeof(float));
+  auto *p = autotune_fill_(in, kMax);
+
+  auto gpu_sum = [&](size_t n) {
+    auto tg = gpu::sum_f32(in, partial, n);
+    synchronize();
+    return cpu::sum<float>(static_cast<const float *>(partial.data), tg);
+  };
+
+  // Reduction threadgroup size, then the CPU/GPU crossover for sum()
+  auto best = std::numeric_limits<double>::max();
+  auto best_tg = t.reduction_tg_size;
+  for (size_t tg : {256, 512, 1024}) {
+    tuning().reduction_tg_size = tg;
+    auto time = autotune_time_([&] { gpu_sum(kMax); });
+    if (time < best) best = time, best_tg = tg;
+  }
+  t.reduction_tg_size = tuning().reduction_tg_size = best_tg;
+
+  t.gpu_sum_threshold = autotune_crossover_(
+      {size_t(1) << 12, size_t(1) << 14, size_t(1) << 16, size_t(1) << 18,
+       size_t(1) << 20, size_t(1) << 22, kMax},
+      [&](size_t n) { gpu_sum(n); },
+      [&](size_t n) { cpu::sum<float>(p, n); });
+
+  // STEEL vs simple simdgroup GEMM on small square problems
+  constexpr uint32_t kDim = 256;
+  auto a = storage::make(kDim * kDim * sizeof(float));
+  auto c = storage::make(kDim * kDim * sizeof(float));
+  autotune_fill_(a, kDim * kDim);
+  auto dim = autotune_crossover_(
+      {8, 16, 32, 64, 128, kDim},
+      [&](size_t d) {
+        auto n = static_cast<uint32_t>(d);
+        gpu::sgemm_steel(a, a, c, n, n, n, n, n);
+        synchronize();
+      },
+      [&](size_t d) {
+        auto n = static_cast<uint32_t>(d);
+        gpu::sgemm(a, a, c, n, n, n, n, n, false, false);
+        synchronize();
+      });
+  t.steel_min_dim = std::min<size_t>(dim, kDim);
+}
+
+}  // namespace detail
+
+// Measure kernel crossover points on this host, make them active and (by
+// default) write them to tuning_cache_path() so later runs start tuned.
+// Takes a few seconds; run once per machine, e.g. from a setup step.
+inline tuning_params autotune(bool persist = true) {
+  auto &active = tuning();
+  auto t = active;
+
+  detail::autotune_cpu_(t);
+  active = t;
+  detail::autotune_gpu_(t);
+  active = t;
+
+  if (persist && !save_tuning(t)) {
+    throw std::runtime_error("autotune: can't write " +
+                             tuning_cache_path().string());
+  }
+  return t;
+}
+
+};  // namespace sil
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <npy.h>
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Checkpoints
+//-----------------------------------------------------------------------------
+
+// Training state (weights, optimizer moments, counters) saved as .npz
+// archives without stalling the step. save() only takes references to the
+// arrays, bumping their storage refcount, and returns. A background thread
+// then checksums and writes the archive to `<path>.tmp` and renames it
+// over `path`, so a crash mid-write leaves the previous checkpoint whole.
+//
+// Captured buffers are copy-on-write until the write is done: an in-place
+// operator (+=, -=, *=, /=) on one allocates a new buffer, and a mutable
+// buffer_data(), at() or operator[] first moves the array onto a copy, so
+// what is being written never changes. Other arrays viewing the same buffer
+// keep the captured values.
+//
+//   checkpoint ckpt;
+//   for (size_t step = 1; step <= steps; step++) {
+//     ...
+//     if (step % 1000 == 0) ckpt.save("run.ckpt", {{"W1", W1}, {"m1", m1}});
+//   }
+//   ckpt.wait();
+//   auto state = load_checkpoint("run.ckpt");
+class checkpoint {
+ public:
+  checkpoint() = default;
+  ~checkpoint();
+
+  checkpoint(const checkpoint&) = delete;
+  checkpoint& operator=(const checkpoint&) = delete;
+
+  // Waits for the previous write, then captures `arrays` and starts writing
+  void save(const std::filesystem::path& path,
+            const std::vector<std::pair<std::string, npy_value>>& arrays);
+
+  // Blocks until the write in flight is on disk; rethrows its error
+  void wait();
+
+  bool pending() const { return !done_.load(std::memory_order_acquire); }
+
+ private:
+  detail::npz_archive_ archive_;
+  std::vector<const void*> captured_;
+  std::thread worker_;
+  std::atomic<bool> done_ = true;
+  std::exception_ptr error_;
+};
+
+// A checkpoint (or any stored .npz) with every entry's CRC-32 verified
+// against the archive's directory. Entries are views over the mapped file,
+// as with load_npz.
+std::map<std::string, npy_value> load_checkpoint(
+    const std::filesystem::path& path);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+inline checkpoint::~checkpoint() {
+  if (worker_.joinable()) worker_.join();
+}
+
+inline void checkpoint::save(
+    const std::filesystem::path& path,
+    const std::vector<std::pair<std::string, npy_value>>& arrays) {
+  wait();
+
+  // Evaluates lazy arrays and flushes GPU work here, so the writer only
+  // reads settled memory
+  archive_ = detail::npz_prepare_(arrays);
+  auto& captures = detail::capture_set::instance();
+  for (auto& src : archive_.sources) {
+    auto id = std::visit([](const auto& a) { return a.buffer_id(); }, src);
+    captured_.push_back(id);
+    captures.add(id);
+  }
+
+  done_.store(false, std::memory_order_release);
+  worker_ = std::thread([this, path] {
+    try {
+      auto tmp = path;
+      tmp += ".tmp";
+      detail::npz_write_(tmp, archive_, "checkpoint");
+      std::filesystem::rename(tmp, path);
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+    auto& captures = detail::capture_set::instance();
+    for (auto* id : captured_) captures.remove(id);
+    done_.store(true, std::memory_order_release);
+  });
+}
+
+inline void checkpoint::wait() {
+  if (worker_.joinable()) worker_.join();
+
+  // Dropped on this thread: the buffer pool isn't thread-safe
+  archive_ = {};
+  captured_.clear();
+  if (auto e = std::exchange(error_, nullptr)) std::rethrow_exception(e);
+}
+
+inline std::map<std::string, npy_value> load_checkpoint(
+    const std::filesystem::path& path) {
+  auto what = "load_checkpoint '" + path.string() + "'";
+  auto file = mapped_file::open(path);
+  auto entries = detail::npz_scan_(*file, what);
+
+  std::vector<char> ok(entries.size());
+  detail::parallel_for(entries.size(), [&](size_t i) {
+    auto& e = entries[i];
+    ok[i] = detail::crc32_(0, file->data() + e.begin, e.size) == e.crc;
+  });
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (!ok[i]) {
+      throw std::runtime_error("array: " + what + " entry '" +
+                               entries[i].name + "' fails its checksum.");
+    }
+  }
+  return detail::npz_load_(*file, entries, what);
+}
+
+};  // namespace sil
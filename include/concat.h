@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array.h>
+
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <numeric>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Concatenate, stack and split
+//-----------------------------------------------------------------------------
+
+// Join arrays along an existing axis; shapes must agree on every other axis.
+template <value_type T>
+array<T> concat(const std::vector<array<T>> &xs, size_t axis = 0);
+template <value_type T>
+array<T> concat(std::initializer_list<array<T>> xs, size_t axis = 0);
+
+// Same, written into a preallocated contiguous `dst` of the joined shape.
+template <value_type T>
+void concat_into(array<T> &dst, const std::vector<array<T>> &xs,
+                 size_t axis = 0);
+
+// Join equal-shaped arrays along a new axis inserted at `axis`.
+template <value_type T>
+array<T> stack(const std::vector<array<T>> &xs, size_t axis = 0);
+template <value_type T>
+array<T> stack(std::initializer_list<array<T>> xs, size_t axis = 0);
+
+// Zero-copy views of consecutive pieces of `sizes` along `axis` (see
+// array::slice for views along an inner axis).
+template <value_type T>
+std::vector<array<T>> split(const array<T> &a, const std::vector<size_t> &sizes,
+                            size_t axis = 0);
+
+// `n` views of equal size along `axis`; the last one takes the remainder.
+template <value_type T>
+std::vector<array<T>> chunk(const array<T> &a, size_t n, size_t axis = 0);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+template <value_type T>
+inline shape_type concat_shape_(const std::vector<array<T>> &xs, size_t axis) {
+  if (xs.empty()) {
+    throw std::runtime_error("array: concat requires at least one array.");
+  }
+  auto ref = xs[0].shape();
+  if (axis >= ref.size()) {
+    throw std::runtime_error("array: concat axis is out of range.");
+  }
+  auto shape = ref;
+  shape[axis] = 0;
+  ref[axis] = 0;
+  for (auto &x : xs) {
+    auto s = x.shape();
+    if (s.size() != ref.size()) {
+      throw std::runtime_error("array: concat shape mismatch.");
+    }
+    auto extent = s[axis];
+    s[axis] = 0;
+    if (s != ref) throw std::runtime_error("array: concat shape mismatch.");
+    shape[axis] += extent;
+  }
+  return shape;
+}
+
+// dst is (outer, sum of extents, inner); piece i is (outer, extents[i], inner)
+template <value_type T>
+inline void concat_copy_(const std::vector<const T *> &srcs,
+                         const std::vector<size_t> &extents, size_t outer,
+                         size_t inner, T *dst) {
+  auto total = std::accumulate(extents.begin(), extents.end(), size_t(0));
+  auto row = std::max<size_t>(total * inner, 1);
+  auto grain = std::max<size_t>(1, kParallelGrain / row);
+  parallel_chunks(outer, grain, [&](size_t begin, size_t end) {
+    for (size_t o = begin; o < end; o++) {
+      T *d = dst + o * total * inner;
+      for (size_t i = 0; i < srcs.size(); i++) {
+        auto n = extents[i] * inner;
+        std::memcpy(d, srcs[i] + o * n, n * sizeof(T));
+        d += n;
+      }
+    }
+  });
+}
+
+template <value_type T>
+inline void concat_to_(T *dst, const std::vector<array<T>> &xs,
+                       const shape_type &shape, size_t axis,
+                       std::vector<size_t> extents) {
+  // Inputs that aren't contiguous (transposed, sliced) are copied first
+  std::vector<array<T>> keep;
+  keep.reserve(xs.size());
+  std::vector<const T *> srcs;
+  for (auto &x : xs) {
+    keep.push_back(x.is_contiguous() ? x : x.clone());
+    srcs.push_back(keep.back().buffer_data());
+  }
+
+  auto outer = std::accumulate(shape.begin(), shape.begin() + axis, size_t(1),
+                               std::multiplies<>());
+  auto inner = std::accumulate(shape.begin() + axis + 1, shape.end(),
+                               size_t(1), std::multiplies<>());
+  concat_copy_(srcs, extents, outer, inner, dst);
+}
+
+template <value_type T>
+inline std::vector<size_t> extents_along_(const std::vector<array<T>> &xs,
+                                          size_t axis) {
+  std::vector<size_t> extents;
+  for (auto &x : xs) extents.push_back(x.shape()[axis]);
+  return extents;
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline array<T> concat(const std::vector<array<T>> &xs, size_t axis) {
+  auto shape = detail::concat_shape_(xs, axis);
+  auto out = array<T>(shape, T{});
+  detail::concat_to_(out.buffer_data(), xs, shape, axis,
+                     detail::extents_along_(xs, axis));
+  return out;
+}
+
+template <value_type T>
+inline array<T> concat(std::initializer_list<array<T>> xs, size_t axis) {
+  return concat(std::vector<array<T>>(xs), axis);
+}
+
+template <value_type T>
+inline void concat_into(array<T> &dst, const std::vector<array<T>> &xs,
+                        size_t axis) {
+  auto shape = detail::concat_shape_(xs, axis);
+  if (dst.shape() != shape || !dst.is_contiguous()) {
+    throw std::runtime_error(
+        "array: concat_into requires a contiguous destination of the joined "
+        "shape.");
+  }
+  detail::concat_to_(dst.buffer_data(), xs, shape, axis,
+                     detail::extents_along_(xs, axis));
+}
+
+template <value_type T>
+inline array<T> stack(const std::vector<array<T>> &xs, size_t axis) {
+  if (xs.empty()) {
+    throw std::runtime_error("array: stack requires at least one array.");
+  }
+  auto shape = xs[0].shape();
+  if (axis > shape.size()) {
+    throw std::runtime_error("array: stack axis is out of range.");
+  }
+  for (auto &x : xs) {
+    if (x.shape() != shape) {
+      throw std::runtime_error("array: stack shape mismatch.");
+    }
+  }
+
+  // Each input contributes one slice along the new axis
+  shape.insert(shape.begin() + axis, xs.size());
+  auto out = array<T>(shape, T{});
+  detail::concat_to_(out.buffer_data(), xs, shape, axis,
+                     std::vector<size_t>(xs.size(), 1));
+  return out;
+}
+
+template <value_type T>
+inline array<T> stack(std::initializer_list<array<T>> xs, size_t axis) {
+  return stack(std::vector<array<T>>(xs), axis);
+}
+
+template <value_type T>
+inline std::vector<array<T>> split(const array<T> &a,
+                                   const std::vector<size_t> &sizes,
+                                   size_t axis) {
+  if (axis >= a.dimension()) {
+    throw std::runtime_error("array: split axis is out of range.");
+  }
+  if (std::accumulate(sizes.begin(), sizes.end(), size_t(0)) !=
+      a.shape()[axis]) {
+    throw std::runtime_error("array: split sizes must add up to the axis.");
+  }
+
+  std::vector<array<T>> parts;
+  parts.reserve(sizes.size());
+  size_t begin = 0;
+  for (auto n : sizes) {
+    parts.push_back(a.slice(axis, begin, begin + n));
+    begin += n;
+  }
+  return parts;
+}
+
+template <value_type T>
+inline std::vector<array<T>> chunk(const array<T> &a, size_t n, size_t axis) {
+  if (axis >= a.dimension() || n == 0 || n > a.shape()[axis]) {
+    throw std::runtime_error("array: chunk count is out of range.");
+  }
+  auto extent = a.shape()[axis];
+  std::vector<size_t> sizes(n, extent / n);
+  sizes.back() += extent % n;
+  return split(a, sizes, axis);
+}
+
+};  // namespace sil
@@ -0,0 +1,520 @@
+#pragma once
+
+#include <array.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Spatial ops (CPU)
+//-----------------------------------------------------------------------------
+
+enum class data_layout { nchw, nhwc };
+
+// Weights are always (C_out, C_in / groups, KH, KW); input and output use
+// `layout`.
+struct conv2d_params {
+  size_t stride_h = 1, stride_w = 1;
+  size_t pad_h = 0, pad_w = 0;
+  size_t dilation_h = 1, dilation_w = 1;
+  size_t groups = 1;
+  data_layout layout = data_layout::nchw;
+};
+
+// stride 0 = kernel size. avg_pool2d counts padded cells in the divisor.
+struct pool2d_params {
+  size_t kernel_h = 2, kernel_w = 2;
+  size_t stride_h = 0, stride_w = 0;
+  size_t pad_h = 0, pad_w = 0;
+  data_layout layout = data_layout::nchw;
+};
+
+struct conv2d_grads {
+  array<float> dx;
+  array<float> dw;
+  array<float> db;
+};
+
+array<float> conv2d(const array<float> &x, const array<float> &w,
+                    const conv2d_params &p = {});
+array<float> conv2d(const array<float> &x, const array<float> &w,
+                    const array<float> &b, const conv2d_params &p = {});
+conv2d_grads conv2d_backward(const array<float> &dout, const array<float> &x,
+                             const array<float> &w,
+                             const conv2d_params &p = {});
+
+array<float> max_pool2d(const array<float> &x, const pool2d_params &p = {});
+array<float> max_pool2d_backward(const array<float> &dout,
+                                 const array<float> &x,
+                                 const pool2d_params &p = {});
+
+array<float> avg_pool2d(const array<float> &x, const pool2d_params &p = {});
+array<float> avg_pool2d_backward(const array<float> &dout,
+                                 const array<float> &x,
+                                 const pool2d_params &p = {});
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Extents and element strides of a 4D activation in either layout
+struct tensor4_ {
+  size_t n, c, h, w;
+  size_t sn, sc, sh, sw;
+};
+
+inline tensor4_ make_tensor4_(size_t n, size_t c, size_t h, size_t w,
+                              data_layout layout) {
+  if (layout == data_layout::nchw) return {n, c, h, w, c * h * w, h * w, w, 1};
+  return {n, c, h, w, h * w * c, 1, w * c, c};
+}
+
+inline tensor4_ tensor4_of_(const shape_type &s, data_layout layout,
+                            const char *op) {
+  if (s.size() != 4) {
+    throw std::runtime_error(std::string("array: ") + op +
+                             " requires a 4D array.");
+  }
+  if (layout == data_layout::nchw)
+    return make_tensor4_(s[0], s[1], s[2], s[3], layout);
+  return make_tensor4_(s[0], s[3], s[1], s[2], layout);
+}
+
+inline shape_type shape_of_(const tensor4_ &t, data_layout layout) {
+  if (layout == data_layout::nchw) return {t.n, t.c, t.h, t.w};
+  return {t.n, t.h, t.w, t.c};
+}
+
+inline size_t out_extent_(size_t in, size_t k, size_t stride, size_t pad,
+                          size_t dilation, const char *op) {
+  auto span = dilation * (k - 1) + 1;
+  if (k == 0 || stride == 0 || dilation == 0 || in + 2 * pad < span) {
+    throw std::runtime_error(std::string("array: invalid ") + op +
+                             " geometry.");
+  }
+  return (in + 2 * pad - span) / stride + 1;
+}
+
+//-----------------------------------------------------------------------------
+
+struct conv_geometry_ {
+  tensor4_ in, out;
+  size_t kh, kw;
+  size_t cig, cog;   // channels per group
+  size_t kdim;       // cig * kh * kw — GEMM reduction length
+  size_t pixels;     // out.h * out.w
+  conv2d_params p;
+};
+
+inline conv_geometry_ conv_geometry_of_(const shape_type &xs,
+                                        const shape_type &ws,
+                                        const conv2d_params &p) {
+  auto in = tensor4_of_(xs, p.layout, "conv2d");
+  if (ws.size() != 4) {
+    throw std::runtime_error("array: conv2d weights must be (C_out, C_in / groups, KH, KW).");
+  }
+  auto cout = ws[0];
+  if (p.groups == 0 || in.c % p.groups || cout % p.groups ||
+      ws[1] != in.c / p.groups) {
+    throw std::runtime_error("array: conv2d channels don't match groups.");
+  }
+
+  conv_geometry_ g;
+  g.p = p;
+  g.in = in;
+  g.kh = ws[2];
+  g.kw = ws[3];
+  g.cig = in.c / p.groups;
+  g.cog = cout / p.groups;
+  g.kdim = g.cig * g.kh * g.kw;
+  auto oh = out_extent_(in.h, g.kh, p.stride_h, p.pad_h, p.dilation_h, "conv2d");
+  auto ow = out_extent_(in.w, g.kw, p.stride_w, p.pad_w, p.dilation_w, "conv2d");
+  g.out = make_tensor4_(in.n, cout, oh, ow, p.layout);
+  g.pixels = oh * ow;
+  return g;
+}
+
+// cols[pixel][ci * KH * KW + i * KW + j] for one image and group — the same
+// order as a flattened weight row, so both layouts share one GEMM shape.
+inline void im2col_(const float *x, const conv_geometry_ &g, size_t n,
+                    size_t grp, float *cols) {
+  auto &in = g.in;
+  auto &p = g.p;
+  auto grain = std::max<size_t>(1, kParallelGrain / std::max<size_t>(g.kdim, 1));
+
+  parallel_chunks(g.pixels, grain, [&](size_t begin, size_t end) {
+    for (size_t pix = begin; pix < end; pix++) {
+      auto oh = pix / g.out.w, ow = pix % g.out.w;
+      auto *row = cols + pix * g.kdim;
+      for (size_t ci = 0; ci < g.cig; ci++) {
+        const float *src = x + n * in.sn + (grp * g.cig + ci) * in.sc;
+        for (size_t i = 0; i < g.kh; i++) {
+          auto ih = ptrdiff_t(oh * p.stride_h + i * p.dilation_h) - ptrdiff_t(p.pad_h);
+          bool row_ok = ih >= 0 && ih < ptrdiff_t(in.h);
+          for (size_t j = 0; j < g.kw; j++) {
+            auto iw = ptrdiff_t(ow * p.stride_w + j * p.dilation_w) - ptrdiff_t(p.pad_w);
+            *row++ = row_ok && iw >= 0 && iw < ptrdiff_t(in.w)
+                         ? src[ih * in.sh + iw * in.sw]
+                         : 0.0f;
+          }
+        }
+      }
+    }
+  });
+}
+
+// Inverse of im2col_: accumulates cols back into dx. Channels are disjoint,
+// so they are processed in parallel.
+inline void col2im_(const float *cols, const conv_geometry_ &g, size_t n,
+                    size_t grp, float *dx) {
+  auto &in = g.in;
+  auto &p = g.p;
+
+  parallel_for(g.cig, [&](size_t ci) {
+    float *dst = dx + n * in.sn + (grp * g.cig + ci) * in.sc;
+    for (size_t pix = 0; pix < g.pixels; pix++) {
+      auto oh = pix / g.out.w, ow = pix % g.out.w;
+      const float *row = cols + pix * g.kdim + ci * g.kh * g.kw;
+      for (size_t i = 0; i < g.kh; i++) {
+        auto ih = ptrdiff_t(oh * p.stride_h + i * p.dilation_h) - ptrdiff_t(p.pad_h);
+        if (ih < 0 || ih >= ptrdiff_t(in.h)) continue;
+        for (size_t j = 0; j < g.kw; j++) {
+          auto iw = ptrdiff_t(ow * p.stride_w + j * p.dilation_w) - ptrdiff_t(p.pad_w);
+          if (iw < 0 || iw >= ptrdiff_t(in.w)) continue;
+          dst[ih * in.sh + iw * in.sw] += row[i * g.kw + j];
+        }
+      }
+    }
+  });
+}
+
+// Direct 3×3, stride 1, no dilation, NCHW. For few input channels im2col
+// inflates memory traffic 9× for a GEMM with a tiny reduction dimension;
+// sliding the kernel over contiguous rows lets the inner loop vectorize.
+inline bool conv3x3_direct_eligible_(const conv_geometry_ &g) {
+  auto &p = g.p;
+  return p.layout == data_layout::nchw && g.kh == 3 && g.kw == 3 &&
+         p.stride_h == 1 && p.stride_w == 1 && p.dilation_h == 1 &&
+         p.dilation_w == 1 && g.cig <= 4;
+}
+
+inline void conv3x3_direct_(const float *x, const float *w, float *y,
+                            const conv_geometry_ &g) {
+  auto &in = g.in;
+  auto &out = g.out;
+  auto ph = ptrdiff_t(g.p.pad_h), pw = ptrdiff_t(g.p.pad_w);
+
+  parallel_for(in.n * out.c, [&](size_t plane) {
+    auto n = plane / out.c, co = plane % out.c, grp = co / g.cog;
+    float *dst = y + n * out.sn + co * out.sc;
+    std::fill(dst, dst + g.pixels, 0.0f);
+
+    for (size_t ci = 0; ci < g.cig; ci++) {
+      const float *src = x + n * in.sn + (grp * g.cig + ci) * in.sc;
+      const float *k = w + (co * g.cig + ci) * 9;
+      for (ptrdiff_t i = 0; i < 3; i++) {
+        for (size_t oh = 0; oh < out.h; oh++) {
+          auto ih = ptrdiff_t(oh) + i - ph;
+          if (ih < 0 || ih >= ptrdiff_t(in.h)) continue;
+          const float *srow = src + ih * in.w;
+          float *orow = dst + oh * out.w;
+          for (ptrdiff_t j = 0; j < 3; j++) {
+            auto wv = k[i * 3 + j];
+            auto lo = std::max<ptrdiff_t>(0, pw - j);
+            auto hi = std::min<ptrdiff_t>(out.w, ptrdiff_t(in.w) + pw - j);
+            for (auto ow = lo; ow < hi; ow++) orow[ow] += wv * srow[ow + j - pw];
+          }
+        }
+      }
+    }
+  });
+}
+
+inline void conv2d_forward_(const float *x, const float *w, float *y,
+                            const conv_geometry_ &g) {
+  if (conv3x3_direct_eligible_(g)) return conv3x3_direct_(x, w, y, g);
+
+  std::vector<float> cols(g.pixels * g.kdim);
+  for (size_t n = 0; n < g.in.n; n++) {
+    for (size_t grp = 0; grp < g.p.groups; grp++) {
+      im2col_(x, g, n, grp, cols.data());
+      const float *wg = w + grp * g.cog * g.kdim;
+      if (g.p.layout == data_layout::nchw) {
+        // (Cog × P) = W_g · cols^T
+        float *dst = y + n * g.out.sn + grp * g.cog * g.out.sc;
+        cpu::sgemm(false, true, g.cog, g.pixels, g.kdim, wg, g.kdim,
+                   cols.data(), g.kdim, dst, g.pixels);
+      } else {
+        // (P × Cog) = cols · W_g^T, strided into the C_out channels
+        float *dst = y + n * g.out.sn + grp * g.cog;
+        cpu::sgemm(false, true, g.pixels, g.cog, g.kdim, cols.data(), g.kdim,
+                   wg, g.kdim, dst, g.out.c);
+      }
+    }
+  }
+}
+
+inline void add_channel_bias_(float *y, const float *b, const tensor4_ &t) {
+  parallel_for(t.n, [&](size_t n) {
+    for (size_t c = 0; c < t.c; c++)
+      for (size_t h = 0; h < t.h; h++)
+        for (size_t w = 0; w < t.w; w++)
+          y[n * t.sn + c * t.sc + h * t.sh + w * t.sw] += b[c];
+  });
+}
+
+//-----------------------------------------------------------------------------
+
+struct pool_geometry_ {
+  tensor4_ in, out;
+  size_t kh, kw, sh, sw, ph, pw;
+};
+
+inline pool_geometry_ pool_geometry_of_(const shape_type &xs,
+                                        const pool2d_params &p,
+                                        const char *op) {
+  pool_geometry_ g;
+  g.in = tensor4_of_(xs, p.layout, op);
+  g.kh = p.kernel_h;
+  g.kw = p.kernel_w;
+  g.sh = p.stride_h ? p.stride_h : p.kernel_h;
+  g.sw = p.stride_w ? p.stride_w : p.kernel_w;
+  g.ph = p.pad_h;
+  g.pw = p.pad_w;
+  if (2 * g.ph > g.kh || 2 * g.pw > g.kw) {
+    throw std::runtime_error(std::string("array: ") + op +
+                             " padding must be at most half the kernel.");
+  }
+  auto oh = out_extent_(g.in.h, g.kh, g.sh, g.ph, 1, op);
+  auto ow = out_extent_(g.in.w, g.kw, g.sw, g.pw, 1, op);
+  g.out = make_tensor4_(g.in.n, g.in.c, oh, ow, p.layout);
+  return g;
+}
+
+// fn(src_plane, dst_plane, window) over every (n, c) plane in parallel;
+// window(oh, ow, visit) calls visit(offset) for each in-bounds input cell.
+template <typename F>
+inline void pool_planes_(const pool_geometry_ &g, F &&fn) {
+  auto &in = g.in;
+  parallel_for(in.n * in.c, [&](size_t plane) {
+    auto n = plane / in.c, c = plane % in.c;
+    auto window = [&](size_t oh, size_t ow, auto &&visit) {
+      auto h0 = ptrdiff_t(oh * g.sh) - ptrdiff_t(g.ph);
+      auto w0 = ptrdiff_t(ow * g.sw) - ptrdiff_t(g.pw);
+      auto h_lo = std::max<ptrdiff_t>(h0, 0);
+      auto h_hi = std::min<ptrdiff_t>(h0 + g.kh, in.h);
+      auto w_lo = std::max<ptrdiff_t>(w0, 0);
+      auto w_hi = std::min<ptrdiff_t>(w0 + g.kw, in.w);
+      for (auto h = h_lo; h < h_hi; h++)
+        for (auto w = w_lo; w < w_hi; w++) visit(h * in.sh + w * in.sw);
+    };
+    fn(n * in.sn + c * in.sc, n * g.out.sn + c * g.out.sc, window);
+  });
+}
+
+// Kernels index packed NCHW/NHWC buffers; strided views (slices,
+// broadcasts) are packed first
+inline array<float> conv_contiguous_(const array<float> &a) {
+  return a.is_contiguous() ? a : a.clone();
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+inline array<float> conv2d(const array<float> &x, const array<float> &w,
+                           const conv2d_params &p) {
+  auto g = detail::conv_geometry_of_(x.shape(), w.shape(), p);
+  auto xc = detail::conv_contiguous_(x);
+  auto wc = detail::conv_contiguous_(w);
+  auto y = array<float>(detail::shape_of_(g.out, p.layout), 0.0f);
+  detail::conv2d_forward_(xc.buffer_data(), wc.buffer_data(), y.buffer_data(), g);
+  return y;
+}
+
+inline array<float> conv2d(const array<float> &x, const array<float> &w,
+                           const array<float> &b, const conv2d_params &p) {
+  auto g = detail::conv_geometry_of_(x.shape(), w.shape(), p);
+  if (b.element_count() != g.out.c) {
+    throw std::runtime_error("array: conv2d bias must have C_out elements.");
+  }
+  auto xc = detail::conv_contiguous_(x);
+  auto wc = detail::conv_contiguous_(w);
+  auto bc = detail::conv_contiguous_(b);
+  auto y = array<float>(detail::shape_of_(g.out, p.layout), 0.0f);
+  detail::conv2d_forward_(xc.buffer_data(), wc.buffer_data(), y.buffer_data(), g);
+  detail::add_channel_bias_(y.buffer_data(), bc.buffer_data(), g.out);
+  return y;
+}
+
+inline conv2d_grads conv2d_backward(const array<float> &dout,
+                                    const array<float> &x,
+                                    const array<float> &w,
+                                    const conv2d_params &p) {
+  auto g = detail::conv_geometry_of_(x.shape(), w.shape(), p);
+  if (dout.shape() != detail::shape_of_(g.out, p.layout)) {
+    throw std::runtime_error("array: conv2d_backward dout shape mismatch.");
+  }
+
+  auto grads = conv2d_grads{array<float>(x.shape(), 0.0f),
+                            array<float>(w.shape(), 0.0f),
+                            array<float>({g.out.c}, 0.0f)};
+  auto xc = detail::conv_contiguous_(x);
+  auto wc = detail::conv_contiguous_(w);
+  auto dc = detail::conv_contiguous_(dout);
+  const float *xp = xc.buffer_data();
+  const float *wp = wc.buffer_data();
+  const float *dp = dc.buffer_data();
+  float *dx = grads.dx.buffer_data();
+  float *dw = grads.dw.buffer_data();
+  float *db = grads.db.buffer_data();
+
+  auto nchw = p.layout == data_layout::nchw;
+  auto wg_len = g.cog * g.kdim;
+  std::vector<float> cols(g.pixels * g.kdim), dcols(g.pixels * g.kdim);
+  std::vector<float> dw_tmp(wg_len);
+
+  for (size_t n = 0; n < g.in.n; n++) {
+    for (size_t grp = 0; grp < p.groups; grp++) {
+      detail::im2col_(xp, g, n, grp, cols.data());
+      const float *wg = wp + grp * wg_len;
+
+      if (nchw) {
+        // dout_g is (Cog × P) with leading dimension P
+        const float *d = dp + n * g.out.sn + grp * g.cog * g.out.sc;
+        cpu::sgemm(false, false, g.cog, g.kdim, g.pixels, d, g.pixels,
+                   cols.data(), g.kdim, dw_tmp.data(), g.kdim);
+        cpu::sgemm(true, false, g.pixels, g.kdim, g.cog, d, g.pixels, wg,
+                   g.kdim, dcols.data(), g.kdim);
+      } else {
+        // dout_g is (P × Cog) with leading dimension C_out
+        const float *d = dp + n * g.out.sn + grp * g.cog;
+        cpu::sgemm(true, false, g.cog, g.kdim, g.pixels, d, g.out.c,
+                   cols.data(), g.kdim, dw_tmp.data(), g.kdim);
+        cpu::sgemm(false, false, g.pixels, g.kdim, g.cog, d, g.out.c, wg,
+                   g.kdim, dcols.data(), g.kdim);
+      }
+
+      float *dwg = dw + grp * wg_len;
+      cpu::kernels().add(dwg, wg_len, dw_tmp.data(), wg_len, dwg, wg_len);
+      detail::col2im_(dcols.data(), g, n, grp, dx);
+    }
+  }
+
+  // db[c] = sum of dout over batch and pixels
+  auto &o = g.out;
+  for (size_t n = 0; n < o.n; n++)
+    for (size_t c = 0; c < o.c; c++)
+      for (size_t h = 0; h < o.h; h++)
+        for (size_t w = 0; w < o.w; w++)
+          db[c] += dp[n * o.sn + c * o.sc + h * o.sh + w * o.sw];
+
+  return grads;
+}
+
+//-----------------------------------------------------------------------------
+
+inline array<float> max_pool2d(const array<float> &x, const pool2d_params &p) {
+  auto g = detail::pool_geometry_of_(x.shape(), p, "max_pool2d");
+  auto xc = detail::conv_contiguous_(x);
+  auto y = array<float>(detail::shape_of_(g.out, p.layout), 0.0f);
+  const float *src = xc.buffer_data();
+  float *dst = y.buffer_data();
+
+  detail::pool_planes_(g, [&](size_t si, size_t di, auto &&window) {
+    for (size_t oh = 0; oh < g.out.h; oh++) {
+      for (size_t ow = 0; ow < g.out.w; ow++) {
+        auto m = -std::numeric_limits<float>::infinity();
+        window(oh, ow, [&](size_t off) { m = std::max(m, src[si + off]); });
+        dst[di + oh * g.out.sh + ow * g.out.sw] = m;
+      }
+    }
+  });
+  return y;
+}
+
+inline array<float> max_pool2d_backward(const array<float> &dout,
+                                        const array<float> &x,
+                                        const pool2d_params &p) {
+  auto g = detail::pool_geometry_of_(x.shape(), p, "max_pool2d_backward");
+  if (dout.shape() != detail::shape_of_(g.out, p.layout)) {
+    throw std::runtime_error("array: max_pool2d_backward dout shape mismatch.");
+  }
+  auto xc = detail::conv_contiguous_(x);
+  auto dc = detail::conv_contiguous_(dout);
+  auto dx = array<float>(x.shape(), 0.0f);
+  const float *src = xc.buffer_data();
+  const float *d = dc.buffer_data();
+  float *dst = dx.buffer_data();
+
+  // Gradient goes to the first maximum of each window, as in the forward
+  detail::pool_planes_(g, [&](size_t si, size_t di, auto &&window) {
+    for (size_t oh = 0; oh < g.out.h; oh++) {
+      for (size_t ow = 0; ow < g.out.w; ow++) {
+        auto m = 0.0f;
+        auto arg = std::numeric_limits<size_t>::max();
+        window(oh, ow, [&](size_t off) {
+          if (arg == std::numeric_limits<size_t>::max() || src[si + off] > m) {
+            m = src[si + off];
+            arg = off;
+          }
+        });
+        dst[si + arg] += d[di + oh * g.out.sh + ow * g.out.sw];
+      }
+    }
+  });
+  return dx;
+}
+
+inline array<float> avg_pool2d(const array<float> &x, const pool2d_params &p) {
+  auto g = detail::pool_geometry_of_(x.shape(), p, "avg_pool2d");
+  auto xc = detail::conv_contiguous_(x);
+  auto y = array<float>(detail::shape_of_(g.out, p.layout), 0.0f);
+  const float *src = xc.buffer_data();
+  float *dst = y.buffer_data();
+  auto inv = 1.0f / float(g.kh * g.kw);
+
+  detail::pool_planes_(g, [&](size_t si, size_t di, auto &&window) {
+    for (size_t oh = 0; oh < g.out.h; oh++) {
+      for (size_t ow = 0; ow < g.out.w; ow++) {
+        auto s = 0.0f;
+        window(oh, ow, [&](size_t off) { s += src[si + off]; });
+        dst[di + oh * g.out.sh + ow * g.out.sw] = s * inv;
+      }
+    }
+  });
+  return y;
+}
+
+inline array<float> avg_pool2d_backward(const array<float> &dout,
+                                        const array<float> &x,
+                                        const pool2d_params &p) {
+  auto g = detail::pool_geometry_of_(x.shape(), p, "avg_pool2d_backward");
+  if (dout.shape() != detail::shape_of_(g.out, p.layout)) {
+    throw std::runtime_error("array: avg_pool2d_backward dout shape mismatch.");
+  }
+  auto dc = detail::conv_contiguous_(dout);
+  auto dx = array<float>(x.shape(), 0.0f);
+  const float *d = dc.buffer_data();
+  float *dst = dx.buffer_data();
+  auto inv = 1.0f / float(g.kh * g.kw);
+
+  detail::pool_planes_(g, [&](size_t si, size_t di, auto &&window) {
+    for (size_t oh = 0; oh < g.out.h; oh++) {
+      for (size_t ow = 0; ow < g.out.w; ow++) {
+        auto v = d[di + oh * g.out.sh + ow * g.out.sw] * inv;
+        window(oh, ow, [&](size_t off) { dst[si + off] += v; });
+      }
+    }
+  });
+  return dx;
+}
+
+};  // namespace sil
@@ -2,11 +2,13 @@
 
 #include <types.h>
 #include <device.h>
+#include <cpu_kernels.h>
 
 #include <Accelerate/Accelerate.h>
 #include <arm_neon.h>
 #include <cmath>
 #include <numeric>
+#include <vector>
 
 namespace sil {
 
@@ -48,15 +50,103 @@ class cpu {
   static void bias_sigmoid(float *data, const float *bias, size_t n, size_t cols);
   static void relu(const float *src, float *dst, size_t n);
 
+  // out[i] = f(in[i] * scale + offset) * post_scale + post_offset
+  static void unary(unary_op op, const float *in, float *out, size_t n,
+                    const unary_args &args = {});
+  // dx[i] = dout[i] * f'(x[i])
+  static void unary_backward(unary_op op, const float *dout, const float *x,
+                             float *dx, size_t n, const unary_args &args = {});
+
+  // Row statistics go to mean/rstd (rows each) when they are non-null
   static void layer_norm(const float *src, float *dst,
                          const float *gamma, const float *beta,
-                         size_t rows, size_t cols, float eps);
-
-  // out[i] = in[i] * scale + offset — single-pass NEON FMA
+                         size_t rows, size_t cols, float eps,
+                         float *mean = nullptr, float *rstd = nullptr);
+  // dx from the saved statistics; dgamma/dbeta (cols each) are overwritten
+  static void layer_norm_backward(const float *dout, const float *x,
+                                  const float *mean, const float *rstd,
+                                  const float *gamma, float *dx,
+                                  float *dgamma, float *dbeta, size_t rows,
+                                  size_t cols);
+
+  static void rms_norm(const float *src, float *dst, const float *gamma,
+                       size_t rows, size_t cols, float eps,
+                       float *rstd = nullptr);
+  static void rms_norm_backward(const float *dout, const float *x,
+                                const float *rstd, const float *gamma,
+                                float *dx, float *dgamma, size_t rows,
+                                size_t cols);
+
+  // Row-wise softmax over the last axis
+  static void softmax(const float *src, float *dst, size_t rows, size_t cols);
+
+  // Sum of per-row softmax cross-entropy losses; dlogits (optional) gets
+  // (softmax - one_hot(labels)) * grad_scale
+  static double cross_entropy(const float *logits, const int *labels,
+                              float *dlogits, size_t rows, size_t cols,
+                              float grad_scale);
+  // Sum of (a - b)^2; grad (optional) gets (a - b) * grad_scale
+  static double squared_error(const float *a, const float *b, float *grad,
+                              size_t n, float grad_scale);
+
+  // out[i] = in[i] * scale + offset
   static void affine(const float *in, float *out, size_t n,
                      float scale, float offset);
 
+  static float min(const float *data, size_t n);
+  static float max(const float *data, size_t n);
+
+  // C = op(A) * op(B), row-major
+  static void sgemm(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                    const float *a, size_t lda, const float *b, size_t ldb,
+                    float *c, size_t ldc);
+
+  // Kernel table for the active tier (see cpu_kernels.h)
+  static const cpu_kernel_table &kernels() {
+    return *detail::active_kernel_table_();
+  }
+
  private:
+  static void binary_(cpu_kernel_table::binary_fn fn, const float *a,
+                      size_t a_len, const float *b, size_t b_len, float *out,
+                      size_t n);
+
+  // Split an elementwise kernel over [0, n) across cores when large enough
+  template <typename F>
+  static void elementwise_(size_t n, F &&fn) {
+    // Below tuning().parallel_threshold, stay on the calling thread
+    if (n < tuning().parallel_threshold) return fn(size_t(0), n);
+    detail::parallel_chunks(n, detail::kParallelGrain, fn);
+  }
+
+  // Sum of fn(begin, end) over row ranges, one partial per chunk
+  template <typename F>
+  static double sum_rows_(size_t rows, size_t cols, F &&fn);
+
+  // Rows split across cores like `rows_`; each chunk accumulates its own
+  // partial column sums (dgamma, optional dbeta), added up at the end
+  template <typename F>
+  static void rows_with_partials_(size_t rows, size_t cols, float *dgamma,
+                                  float *dbeta, F &&fn);
+
+  // Run fn(begin, end) over row ranges, in parallel for large inputs
+  template <typename F>
+  static void rows_(size_t rows, size_t cols, F &&fn) {
+    if (rows * cols < tuning().parallel_threshold) return fn(size_t(0), rows);
+    detail::parallel_chunks(rows, row_grain_(cols), fn);
+  }
+
+  static size_t row_grain_(size_t cols) {
+    return std::max<size_t>(1, detail::kParallelGrain / std::max<size_t>(cols, 1));
+  }
+
+  // Number of row ranges for an explicit per-chunk split (1 = inline)
+  static size_t row_chunks_(size_t rows, size_t cols) {
+    if (rows * cols < tuning().parallel_threshold) return 1;
+    return std::max<size_t>(
+        1, std::min(cpu_features().cores, rows / row_grain_(cols)));
+  }
+
   template <value_type T>
   static const T *ptr(const storage &s) {
     return static_cast<const T *>(s.data) + s.off;
@@ -82,23 +172,8 @@ inline void cpu::add(const storage &A, const storage &B,
   auto n = OUT.len;
 
   if constexpr (std::is_same_v<T, float>) {
-    if (A.len == n && B.len == n) {
-      vDSP_vadd(a, 1, b, 1, out, 1, n);
-      return;
-    }
-    if (B.len == 1) { vDSP_vsadd(a, 1, b, out, 1, n); return; }
-    if (A.len == 1) { vDSP_vsadd(b, 1, a, out, 1, n); return; }
-    // Broadcast: repeat shorter side row-by-row with vDSP
-    if (A.len == n && B.len > 1 && n % B.len == 0) {
-      for (size_t i = 0; i < n; i += B.len)
-        vDSP_vadd(a + i, 1, b, 1, out + i, 1, B.len);
-      return;
-    }
-    if (B.len == n && A.len > 1 && n % A.len == 0) {
-      for (size_t i = 0; i < n; i += A.len)
-        vDSP_vadd(a, 1, b + i, 1, out + i, 1, A.len);
-      return;
-    }
+    binary_(kernels().add, a, A.len, b, B.len, out, n);
+    return;
   }
   if (A.len == n && B.len == n) {
     for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
@@ -116,25 +191,8 @@ inline void cpu::sub(const storage &A, const storage &B,
   auto n = OUT.len;
 
   if constexpr (std::is_same_v<T, float>) {
-    if (A.len == n && B.len == n) {
-      vDSP_vsub(b, 1, a, 1, out, 1, n);
-      return;
-    }
-    if (B.len == 1) {
-      float neg_b = -b[0];
-      vDSP_vsadd(a, 1, &neg_b, out, 1, n);
-      return;
-    }
-    if (A.len == n && B.len > 1 && n % B.len == 0) {
-      for (size_t i = 0; i < n; i += B.len)
-        vDSP_vsub(b, 1, a + i, 1, out + i, 1, B.len);
-      return;
-    }
-    if (B.len == n && A.len > 1 && n % A.len == 0) {
-      for (size_t i = 0; i < n; i += A.len)
-        vDSP_vsub(b + i, 1, a, 1, out + i, 1, A.len);
-      return;
-    }
+    binary_(kernels().sub, a, A.len, b, B.len, out, n);
+    return;
   }
   if (A.len == n && B.len == n) {
     for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
@@ -152,22 +210,8 @@ inline void cpu::mul(const storage &A, const storage &B,
   auto n = OUT.len;
 
   if constexpr (std::is_same_v<T, float>) {
-    if (A.len == n && B.len == n) {
-      vDSP_vmul(a, 1, b, 1, out, 1, n);
-      return;
-    }
-    if (B.len == 1) { vDSP_vsmul(a, 1, b, out, 1, n); return; }
-    if (A.len == 1) { vDSP_vsmul(b, 1, a, out, 1, n); return; }
-    if (A.len == n && B.len > 1 && n % B.len == 0) {
-      for (size_t i = 0; i < n; i += B.len)
-        vDSP_vmul(a + i, 1, b, 1, out + i, 1, B.len);
-      return;
-    }
-    if (B.len == n && A.len > 1 && n % A.len == 0) {
-      for (size_t i = 0; i < n; i += A.len)
-        vDSP_vmul(a, 1, b + i, 1, out + i, 1, A.len);
-      return;
-    }
+    binary_(kernels().mul, a, A.len, b, B.len, out, n);
+    return;
   }
   if (A.len == n && B.len == n) {
     for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
@@ -185,22 +229,8 @@ inline void cpu::div(const storage &A, const storage &B,
   auto n = OUT.len;
 
   if constexpr (std::is_same_v<T, float>) {
-    if (A.len == n && B.len == n) {
-      vDSP_vdiv(b, 1, a, 1, out, 1, n);
-      return;
-    }
-    if (B.len == 1) { vDSP_vsdiv(a, 1, b, out, 1, n); return; }
-    if (A.len == 1) { vDSP_svdiv(a, b, 1, out, 1, n); return; }
-    if (A.len == n && B.len > 1 && n % B.len == 0) {
-      for (size_t i = 0; i < n; i += B.len)
-        vDSP_vdiv(b, 1, a + i, 1, out + i, 1, B.len);
-      return;
-    }
-    if (B.len == n && A.len > 1 && n % A.len == 0) {
-      for (size_t i = 0; i < n; i += A.len)
-        vDSP_vdiv(b + i, 1, a, 1, out + i, 1, A.len);
-      return;
-    }
+    binary_(kernels().div, a, A.len, b, B.len, out, n);
+    return;
   }
   if (A.len == n && B.len == n) {
     for (size_t i = 0; i < n; i++) out[i] = a[i] / b[i];
@@ -232,14 +262,30 @@ inline void cpu::pow(const storage &A, const storage &B,
   }
 }
 
+inline void cpu::binary_(cpu_kernel_table::binary_fn fn, const float *a,
+                         size_t a_len, const float *b, size_t b_len,
+                         float *out, size_t n) {
+  // Chunking keeps operand alignment only for full-length or scalar sides
+  auto splittable = [n](size_t len) { return len == n || len == 1; };
+  if (!splittable(a_len) || !splittable(b_len)) {
+    fn(a, a_len, b, b_len, out, n);
+    return;
+  }
+  elementwise_(n, [&](size_t begin, size_t end) {
+    auto a_off = a_len == 1 ? 0 : begin;
+    auto b_off = b_len == 1 ? 0 : begin;
+    fn(a + a_off, a_len == 1 ? 1 : end - begin, b + b_off,
+       b_len == 1 ? 1 : end - begin, out + begin, end - begin);
+  });
+}
+
 template <value_type T>
 inline void cpu::dot(const storage &A, const storage &B,
                       storage &OUT, uint32_t A_cols, uint32_t OUT_rows,
                       uint32_t OUT_cols) {
   if constexpr (std::is_same_v<T, float>) {
-    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, OUT_rows, OUT_cols,
-                A_cols, 1.0f, ptr<T>(A), A_cols, ptr<T>(B), OUT_cols, 0.0f,
-                mutable_ptr<T>(OUT), OUT_cols);
+    sgemm(false, false, OUT_rows, OUT_cols, A_cols, ptr<T>(A), A_cols,
+          ptr<T>(B), OUT_cols, mutable_ptr<T>(OUT), OUT_cols);
     return;
   }
 
@@ -262,9 +308,7 @@ inline void cpu::dot(const storage &A, const storage &B,
 template <value_type T>
 inline T cpu::sum(const T *data, size_t n) {
   if constexpr (std::is_same_v<T, float>) {
-    float result;
-    vDSP_sve(data, 1, &result, n);
-    return result;
+    return kernels().sum(data, n);
   }
   return std::accumulate(data, data + n, T{});
 }
@@ -273,8 +317,9 @@ template <value_type T>
 inline void cpu::sum_axis0(const T *src, T *dst, size_t rows, size_t cols) {
   if constexpr (std::is_same_v<T, float>) {
     std::memset(dst, 0, cols * sizeof(float));
+    auto add = kernels().add;
     for (size_t r = 0; r < rows; r++)
-      vDSP_vadd(dst, 1, src + r * cols, 1, dst, 1, cols);
+      add(dst, cols, src + r * cols, cols, dst, cols);
   } else {
     std::memset(dst, 0, cols * sizeof(T));
     for (size_t r = 0; r < rows; r++)
@@ -284,17 +329,15 @@ inline void cpu::sum_axis0(const T *src, T *dst, size_t rows, size_t cols) {
 }
 
 inline void cpu::sigmoid(const float *src, float *dst, size_t n) {
-  auto len = static_cast<int>(n);
-  vDSP_vneg(src, 1, dst, 1, n);
-  vvexpf(dst, dst, &len);
-  float one = 1.0f;
-  vDSP_vsadd(dst, 1, &one, dst, 1, n);
-  vvrecf(dst, dst, &len);
+  auto fn = kernels().sigmoid;
+  elementwise_(n, [&](size_t begin, size_t end) {
+    fn(src + begin, dst + begin, end - begin);
+  });
 }
 
 inline void cpu::sigmoid_backward(const float *dout, const float *x,
                                    float *dst, size_t n) {
-  // dst = sigmoid(x) via vectorized vDSP
+  // dst = sigmoid(x) via the active kernel tier
   sigmoid(x, dst, n);
   // dst = dout * sigmoid * (1 - sigmoid) — compiler auto-vectorizes with NEON
   for (size_t i = 0; i < n; i++) {
@@ -305,67 +348,168 @@ inline void cpu::sigmoid_backward(const float *dout, const float *x,
 
 inline void cpu::bias_sigmoid(float *data, const float *bias,
                                size_t n, size_t cols) {
-  // Add bias (broadcast row-wise)
-  for (size_t i = 0; i < n; i += cols)
-    vDSP_vadd(data + i, 1, bias, 1, data + i, 1, cols);
-  // In-place sigmoid
-  auto len = static_cast<int>(n);
-  vDSP_vneg(data, 1, data, 1, n);
-  vvexpf(data, data, &len);
-  float one = 1.0f;
-  vDSP_vsadd(data, 1, &one, data, 1, n);
-  vvrecf(data, data, &len);
+  // Add bias (broadcast row-wise), then in-place sigmoid
+  binary_(kernels().add, data, n, bias, cols, data, n);
+  sigmoid(data, data, n);
 }
 
 inline void cpu::relu(const float *src, float *dst, size_t n) {
-  float zero = 0.0f;
-  vDSP_vthres(src, 1, &zero, dst, 1, n);
+  auto fn = kernels().relu;
+  elementwise_(n, [&](size_t begin, size_t end) {
+    fn(src + begin, dst + begin, end - begin);
+  });
+}
+
+inline void cpu::unary(unary_op op, const float *in, float *out, size_t n,
+                       const unary_args &args) {
+  auto fn = kernels().unary;
+  elementwise_(n, [&](size_t begin, size_t end) {
+    fn(op, in + begin, out + begin, end - begin, args);
+  });
+}
+
+inline void cpu::unary_backward(unary_op op, const float *dout,
+                                const float *x, float *dx, size_t n,
+                                const unary_args &args) {
+  auto fn = kernels().unary_backward;
+  elementwise_(n, [&](size_t begin, size_t end) {
+    fn(op, dout + begin, x + begin, dx + begin, end - begin, args);
+  });
 }
 
 inline void cpu::affine(const float *in, float *out, size_t n,
                         float scale, float offset) {
-  float32x4_t vs = vdupq_n_f32(scale);
-  float32x4_t vo = vdupq_n_f32(offset);
-  size_t i = 0;
-  for (; i + 16 <= n; i += 16) {
-    float32x4_t v0 = vld1q_f32(in + i);
-    float32x4_t v1 = vld1q_f32(in + i + 4);
-    float32x4_t v2 = vld1q_f32(in + i + 8);
-    float32x4_t v3 = vld1q_f32(in + i + 12);
-    vst1q_f32(out + i,      vfmaq_f32(vo, v0, vs));
-    vst1q_f32(out + i + 4,  vfmaq_f32(vo, v1, vs));
-    vst1q_f32(out + i + 8,  vfmaq_f32(vo, v2, vs));
-    vst1q_f32(out + i + 12, vfmaq_f32(vo, v3, vs));
-  }
-  for (; i + 4 <= n; i += 4) {
-    float32x4_t v = vld1q_f32(in + i);
-    vst1q_f32(out + i, vfmaq_f32(vo, v, vs));
-  }
-  for (; i < n; i++)
-    out[i] = in[i] * scale + offset;
+  auto fn = kernels().affine;
+  elementwise_(n, [&](size_t begin, size_t end) {
+    fn(in + begin, out + begin, end - begin, scale, offset);
+  });
+}
+
+inline float cpu::min(const float *data, size_t n) {
+  return kernels().min(data, n);
+}
+
+inline float cpu::max(const float *data, size_t n) {
+  return kernels().max(data, n);
 }
 
 inline void cpu::layer_norm(const float *src, float *dst,
                             const float *gamma, const float *beta,
-                            size_t rows, size_t cols, float eps) {
-  for (size_t r = 0; r < rows; r++) {
-    const float *row = src + r * cols;
-    float *out = dst + r * cols;
+                            size_t rows, size_t cols, float eps, float *mean,
+                            float *rstd) {
+  // Rows are independent — split them across cores for large inputs
+  auto fn = kernels().layer_norm;
+  rows_(rows, cols, [&](size_t begin, size_t end) {
+    fn(src + begin * cols, dst + begin * cols, gamma, beta, end - begin, cols,
+       eps, mean ? mean + begin : nullptr, rstd ? rstd + begin : nullptr);
+  });
+}
 
-    float mu;
-    vDSP_meanv(row, 1, &mu, cols);
+template <typename F>
+inline void cpu::rows_with_partials_(size_t rows, size_t cols, float *dgamma,
+                                     float *dbeta, F &&fn) {
+  std::fill_n(dgamma, cols, 0.0f);
+  if (dbeta) std::fill_n(dbeta, cols, 0.0f);
+
+  auto chunks = row_chunks_(rows, cols);
+  if (chunks == 1) return fn(size_t(0), rows, dgamma, dbeta);
+
+  auto width = dbeta ? 2 * cols : cols;
+  std::vector<float> partials(chunks * width, 0.0f);
+  detail::parallel_for(chunks, [&](size_t i) {
+    float *p = partials.data() + i * width;
+    fn(rows * i / chunks, rows * (i + 1) / chunks, p, dbeta ? p + cols : nullptr);
+  });
+
+  auto add = kernels().add;
+  for (size_t i = 0; i < chunks; i++) {
+    const float *p = partials.data() + i * width;
+    add(dgamma, cols, p, cols, dgamma, cols);
+    if (dbeta) add(dbeta, cols, p + cols, cols, dbeta, cols);
+  }
+}
 
-    float neg_mu = -mu;
-    vDSP_vsadd(row, 1, &neg_mu, out, 1, cols);    // out = row - mu
+inline void cpu::layer_norm_backward(const float *dout, const float *x,
+                                     const float *mean, const float *rstd,
+                                     const float *gamma, float *dx,
+                                     float *dgamma, float *dbeta, size_t rows,
+                                     size_t cols) {
+  auto fn = kernels().layer_norm_backward;
+  rows_with_partials_(rows, cols, dgamma, dbeta,
+                      [&](size_t begin, size_t end, float *dg, float *db) {
+    auto off = begin * cols;
+    fn(dout + off, x + off, mean + begin, rstd + begin, gamma, dx + off, dg,
+       db, end - begin, cols);
+  });
+}
 
-    float sum_sq;
-    vDSP_dotpr(out, 1, out, 1, &sum_sq, cols);    // sum_sq = sum((row - mu)^2)
-    float inv_std = 1.0f / sqrtf(sum_sq / cols + eps);
+inline void cpu::rms_norm(const float *src, float *dst, const float *gamma,
+                          size_t rows, size_t cols, float eps, float *rstd) {
+  auto fn = kernels().rms_norm;
+  rows_(rows, cols, [&](size_t begin, size_t end) {
+    fn(src + begin * cols, dst + begin * cols, gamma, end - begin, cols, eps,
+       rstd ? rstd + begin : nullptr);
+  });
+}
 
-    vDSP_vsmul(out, 1, &inv_std, out, 1, cols);   // out *= inv_std
-    vDSP_vmul(out, 1, gamma, 1, out, 1, cols);    // out *= gamma
-    vDSP_vadd(out, 1, beta, 1, out, 1, cols);     // out += beta
-  }
+inline void cpu::rms_norm_backward(const float *dout, const float *x,
+                                   const float *rstd, const float *gamma,
+                                   float *dx, float *dgamma, size_t rows,
+                                   size_t cols) {
+  auto fn = kernels().rms_norm_backward;
+  rows_with_partials_(rows, cols, dgamma, nullptr,
+                      [&](size_t begin, size_t end, float *dg, float *) {
+    auto off = begin * cols;
+    fn(dout + off, x + off, rstd + begin, gamma, dx + off, dg, end - begin,
+       cols);
+  });
+}
+
+inline void cpu::softmax(const float *src, float *dst,
+                         size_t rows, size_t cols) {
+  auto fn = kernels().softmax;
+  auto grain = std::max<size_t>(1, detail::kParallelGrain / std::max<size_t>(cols, 1));
+  if (rows * cols < tuning().parallel_threshold) return fn(src, dst, rows, cols);
+  detail::parallel_chunks(rows, grain, [&](size_t begin, size_t end) {
+    fn(src + begin * cols, dst + begin * cols, end - begin, cols);
+  });
+}
+
+template <typename F>
+inline double cpu::sum_rows_(size_t rows, size_t cols, F &&fn) {
+  auto chunks = row_chunks_(rows, cols);
+  if (chunks == 1) return fn(size_t(0), rows);
+  std::vector<double> partials(chunks);
+  detail::parallel_for(chunks, [&](size_t i) {
+    partials[i] = fn(rows * i / chunks, rows * (i + 1) / chunks);
+  });
+  return std::accumulate(partials.begin(), partials.end(), 0.0);
+}
+
+inline double cpu::cross_entropy(const float *logits, const int *labels,
+                                 float *dlogits, size_t rows, size_t cols,
+                                 float grad_scale) {
+  auto fn = kernels().cross_entropy;
+  return sum_rows_(rows, cols, [&](size_t begin, size_t end) -> double {
+    return fn(logits + begin * cols, labels + begin,
+              dlogits ? dlogits + begin * cols : nullptr, end - begin, cols,
+              grad_scale);
+  });
+}
+
+inline double cpu::squared_error(const float *a, const float *b, float *grad,
+                                 size_t n, float grad_scale) {
+  auto fn = kernels().squared_error;
+  return sum_rows_(n, 1, [&](size_t begin, size_t end) -> double {
+    return fn(a + begin, b + begin, grad ? grad + begin : nullptr,
+              end - begin, grad_scale);
+  });
+}
+
+inline void cpu::sgemm(bool trans_a, bool trans_b, size_t M, size_t N,
+                       size_t K, const float *a, size_t lda, const float *b,
+                       size_t ldb, float *c, size_t ldc) {
+  kernels().sgemm(trans_a, trans_b, M, N, K, a, lda, b, ldb, c, ldc);
 }
 
 };  // namespace sil
@@ -0,0 +1,1554 @@
+#pragma once
+
+#include <Accelerate/Accelerate.h>
+#include <arm_neon.h>
+#include <dispatch/dispatch.h>
+#include <tuning.h>
+#include <types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// CPU features
+//-----------------------------------------------------------------------------
+
+// Kernel tiers for the CPU backend, selected once at startup.
+//   accelerate: vDSP / vForce / CBLAS (default)
+//   neon:       hand-written NEON intrinsics below
+//   scalar:     plain C++, reference implementation
+// Override with SIL_CPU_TIER=scalar|neon|accelerate or use_cpu_tier().
+enum class cpu_tier { scalar, neon, accelerate };
+
+struct cpu_feature_set {
+  bool neon = false;
+  bool fp16 = false;
+  bool bf16 = false;
+  bool dotprod = false;
+  bool i8mm = false;
+  bool sme = false;
+  size_t cores = 1;              // logical CPUs
+  size_t performance_cores = 1;  // perflevel0 (P-cores)
+  std::string brand;
+  cpu_tier tier = cpu_tier::scalar;
+};
+
+inline const char *cpu_tier_name(cpu_tier tier) {
+  switch (tier) {
+    case cpu_tier::scalar: return "scalar";
+    case cpu_tier::neon: return "neon";
+    case cpu_tier::accelerate: return "accelerate";
+  }
+  return "unknown";
+}
+
+namespace detail {
+
+inline cpu_feature_set detect_cpu_features_() {
+  cpu_feature_set f;
+  f.neon = sysctl_int_("hw.optional.neon", 1) != 0;
+  f.fp16 = sysctl_int_("hw.optional.arm.FEAT_FP16") != 0;
+  f.bf16 = sysctl_int_("hw.optional.arm.FEAT_BF16") != 0;
+  f.dotprod = sysctl_int_("hw.optional.arm.FEAT_DotProd") != 0;
+  f.i8mm = sysctl_int_("hw.optional.arm.FEAT_I8MM") != 0;
+  f.sme = sysctl_int_("hw.optional.arm.FEAT_SME") != 0;
+  f.cores = std::max(1, sysctl_int_("hw.logicalcpu", 1));
+  f.performance_cores =
+      std::max(1, sysctl_int_("hw.perflevel0.physicalcpu", int(f.cores)));
+  f.brand = sysctl_string_("machdep.cpu.brand_string");
+
+  f.tier = cpu_tier::accelerate;
+  if (auto env = std::getenv("SIL_CPU_TIER")) {
+    std::string_view v(env);
+    if (v == "scalar") f.tier = cpu_tier::scalar;
+    else if (v == "neon") f.tier = cpu_tier::neon;
+    else if (v == "accelerate") f.tier = cpu_tier::accelerate;
+  }
+  if (f.tier == cpu_tier::neon && !f.neon) f.tier = cpu_tier::scalar;
+  return f;
+}
+
+inline cpu_feature_set &cpu_features_() {
+  static cpu_feature_set f = detect_cpu_features_();
+  return f;
+}
+
+}  // namespace detail
+
+inline const cpu_feature_set &cpu_features() { return detail::cpu_features_(); }
+
+//-----------------------------------------------------------------------------
+// Parallel helpers (Grand Central Dispatch)
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Elements per chunk below which splitting work across threads doesn't pay
+constexpr size_t kParallelGrain = 1 << 16;
+
+// Run fn(begin, end) over [0, n) split into at most one chunk per core, each
+// at least `grain` items. Runs inline when the range is too small to split.
+template <typename F>
+inline void parallel_chunks(size_t n, size_t grain, F &&fn) {
+  size_t chunks = std::min(cpu_features().cores, grain ? n / grain : n);
+  if (chunks <= 1) {
+    if (n) fn(size_t(0), n);
+    return;
+  }
+
+  struct context {
+    std::remove_reference_t<F> *fn;
+    size_t n, chunks;
+  } ctx{&fn, n, chunks};
+
+  dispatch_apply_f(chunks, DISPATCH_APPLY_AUTO, &ctx, [](void *p, size_t i) {
+    auto &c = *static_cast<context *>(p);
+    (*c.fn)(c.n * i / c.chunks, c.n * (i + 1) / c.chunks);
+  });
+}
+
+// Run fn(i) for i in [0, n) on the GCD thread pool.
+template <typename F>
+inline void parallel_for(size_t n, F &&fn) {
+  if (n <= 1) {
+    if (n) fn(size_t(0));
+    return;
+  }
+  dispatch_apply_f(n, DISPATCH_APPLY_AUTO, &fn, [](void *p, size_t i) {
+    (*static_cast<std::remove_reference_t<F> *>(p))(i);
+  });
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+// Kernel table
+//-----------------------------------------------------------------------------
+
+struct cpu_kernel_table {
+  // out[i] = a[i % a_len] op b[i % b_len], with fast paths for equal
+  // lengths, scalar operands and row-repeat broadcast
+  using binary_fn = void (*)(const float *a, size_t a_len, const float *b,
+                             size_t b_len, float *out, size_t n);
+
+  cpu_tier tier;
+  binary_fn add, sub, mul, div;
+  void (*affine)(const float *in, float *out, size_t n, float scale,
+                 float offset);
+  // The same affine map applied to bytes (e.g. pixels), widened to float
+  void (*u8_affine)(const uint8_t *in, float *out, size_t n, float scale,
+                    float offset);
+  void (*sigmoid)(const float *in, float *out, size_t n);
+  void (*relu)(const float *in, float *out, size_t n);
+  void (*unary)(unary_op op, const float *in, float *out, size_t n,
+                const unary_args &args);
+  // dx[i] = dout[i] * f'(x[i]); only the clamp bounds of `args` are read
+  void (*unary_backward)(unary_op op, const float *dout, const float *x,
+                         float *dx, size_t n, const unary_args &args);
+  float (*sum)(const float *in, size_t n);
+  float (*min)(const float *in, size_t n);
+  float (*max)(const float *in, size_t n);
+  // Row statistics are written to mean/rstd when they are non-null
+  void (*layer_norm)(const float *src, float *dst, const float *gamma,
+                     const float *beta, size_t rows, size_t cols, float eps,
+                     float *mean, float *rstd);
+  // dgamma/dbeta are accumulated into (+=), dx is overwritten
+  void (*layer_norm_backward)(const float *dout, const float *x,
+                              const float *mean, const float *rstd,
+                              const float *gamma, float *dx, float *dgamma,
+                              float *dbeta, size_t rows, size_t cols);
+  void (*rms_norm)(const float *src, float *dst, const float *gamma,
+                   size_t rows, size_t cols, float eps, float *rstd);
+  void (*rms_norm_backward)(const float *dout, const float *x,
+                            const float *rstd, const float *gamma, float *dx,
+                            float *dgamma, size_t rows, size_t cols);
+  void (*softmax)(const float *src, float *dst, size_t rows, size_t cols);
+  // Sum over rows of -log softmax(row)[label], accumulated in double. When
+  // dlogits is non-null it receives (softmax - one_hot) * grad_scale.
+  double (*cross_entropy)(const float *logits, const int *labels,
+                         float *dlogits, size_t rows, size_t cols,
+                         float grad_scale);
+  // Sum of (a - b)^2 in double; grad (when non-null) receives
+  // (a - b) * grad_scale
+  double (*squared_error)(const float *a, const float *b, float *grad,
+                         size_t n, float grad_scale);
+  // Inclusive scan of in[0, n) continuing from `carry`; returns the last
+  // value so blocks can be chained
+  float (*scan)(scan_op op, const float *in, float *out, size_t n,
+                float carry);
+  // C = op(A) * op(B), row-major, C is fully overwritten
+  void (*sgemm)(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                const float *a, size_t lda, const float *b, size_t ldb,
+                float *c, size_t ldc);
+};
+
+namespace detail {
+
+struct op_add_ {
+  static float apply(float a, float b) { return a + b; }
+  static float32x4_t apply(float32x4_t a, float32x4_t b) { return vaddq_f32(a, b); }
+};
+struct op_sub_ {
+  static float apply(float a, float b) { return a - b; }
+  static float32x4_t apply(float32x4_t a, float32x4_t b) { return vsubq_f32(a, b); }
+};
+struct op_mul_ {
+  static float apply(float a, float b) { return a * b; }
+  static float32x4_t apply(float32x4_t a, float32x4_t b) { return vmulq_f32(a, b); }
+};
+struct op_div_ {
+  static float apply(float a, float b) { return a / b; }
+  static float32x4_t apply(float32x4_t a, float32x4_t b) { return vdivq_f32(a, b); }
+};
+
+// Generic broadcast fallback shared by all tiers
+template <typename Op>
+inline void binary_modulo_(const float *a, size_t a_len, const float *b,
+                           size_t b_len, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = Op::apply(a[i % a_len], b[i % b_len]);
+}
+
+// Unary math. GELU is the tanh approximation. Worst-case error of the NEON
+// tier against a double-precision reference:
+//   exp, log, tanh, rsqrt  ≤ 2 ulp
+//   silu                   ≤ 4 ulp
+//   gelu                   ≤ 6 ulp for |x| ≤ 1; rounding of the cubic term
+//                          grows this to 2e-5 relative on the far tails
+//   sqrt, abs, clamp       exact
+// exp saturates outside [-87.3, 88] and silu/gelu flush to zero where their
+// sigmoid underflows. The scalar tier is <cmath>; Accelerate uses vForce.
+
+// Reference definitions of the unary ops and their derivatives (scalar tier)
+constexpr float kGeluK = 0.7978845608028654f;  // sqrt(2 / pi)
+constexpr float kGeluC = 0.044715f;
+
+inline float unary_ref_(unary_op op, float x, float lo, float hi) {
+  switch (op) {
+    case unary_op::exp: return std::exp(x);
+    case unary_op::log: return std::log(x);
+    case unary_op::tanh: return std::tanh(x);
+    case unary_op::gelu:
+      return 0.5f * x * (1.0f + std::tanh(kGeluK * (x + kGeluC * x * x * x)));
+    case unary_op::silu: return x / (1.0f + std::exp(-x));
+    case unary_op::sqrt: return std::sqrt(x);
+    case unary_op::rsqrt: return 1.0f / std::sqrt(x);
+    case unary_op::abs: return std::fabs(x);
+    case unary_op::clamp: return std::min(std::max(x, lo), hi);
+  }
+  return x;
+}
+
+// Stable log(exp(a) + exp(b)); -inf is the identity
+inline float logaddexp_(float a, float b) {
+  if (a == b) return a + 0.6931471805599453f;  // equal infinities: no inf - inf
+  auto m = std::max(a, b);
+  return m + std::log1p(std::exp(-std::fabs(a - b)));
+}
+
+inline float scan_combine_(scan_op op, float a, float b) {
+  switch (op) {
+    case scan_op::sum: return a + b;
+    case scan_op::prod: return a * b;
+    case scan_op::logaddexp: return logaddexp_(a, b);
+  }
+  return b;
+}
+
+inline float unary_grad_ref_(unary_op op, float x, float lo, float hi) {
+  switch (op) {
+    case unary_op::exp: return std::exp(x);
+    case unary_op::log: return 1.0f / x;
+    case unary_op::tanh: {
+      auto t = std::tanh(x);
+      return 1.0f - t * t;
+    }
+    case unary_op::gelu: {
+      auto t = std::tanh(kGeluK * (x + kGeluC * x * x * x));
+      return 0.5f * (1.0f + t) +
+             0.5f * x * (1.0f - t * t) * kGeluK * (1.0f + 3.0f * kGeluC * x * x);
+    }
+    case unary_op::silu: {
+      auto s = 1.0f / (1.0f + std::exp(-x));
+      return s * (1.0f + x * (1.0f - s));
+    }
+    case unary_op::sqrt: return 0.5f / std::sqrt(x);
+    case unary_op::rsqrt: return -0.5f / (x * std::sqrt(x));
+    case unary_op::abs: return x > 0.0f ? 1.0f : x < 0.0f ? -1.0f : 0.0f;
+    case unary_op::clamp: return x >= lo && x <= hi ? 1.0f : 0.0f;
+  }
+  return 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// GEMM packing driver shared by the scalar and NEON tiers
+//-----------------------------------------------------------------------------
+
+// Register tile; cache blocking (mc, kc, nc) comes from tuning()
+constexpr size_t kGemmMR = 8;
+constexpr size_t kGemmNR = 8;
+
+// Micro: c[0:mr, 0:nr] += a_panel(kb×MR) * b_panel(kb×NR)
+template <void (*Micro)(size_t, const float *, const float *, float *, size_t,
+                        size_t, size_t)>
+inline void packed_sgemm_(bool ta, bool tb, size_t M, size_t N, size_t K,
+                          const float *a, size_t lda, const float *b,
+                          size_t ldb, float *c, size_t ldc) {
+  constexpr size_t MR = kGemmMR, NR = kGemmNR;
+  auto &t = tuning();
+  auto mc = std::max(t.gemm_mc, MR), kc = std::max<size_t>(t.gemm_kc, 1),
+       nc = std::max(t.gemm_nc, NR);
+
+  for (size_t i = 0; i < M; i++) std::memset(c + i * ldc, 0, N * sizeof(float));
+  if (K == 0) return;
+
+  auto A = [&](size_t i, size_t k) { return ta ? a[k * lda + i] : a[i * lda + k]; };
+  auto B = [&](size_t k, size_t j) { return tb ? b[j * ldb + k] : b[k * ldb + j]; };
+
+  std::vector<float> bpack;
+  for (size_t jc = 0; jc < N; jc += nc) {
+    auto nb = std::min(nc, N - jc);
+    auto np = (nb + NR - 1) / NR;
+
+    for (size_t pc = 0; pc < K; pc += kc) {
+      auto kb = std::min(kc, K - pc);
+
+      bpack.resize(np * NR * kb);
+      for (size_t jp = 0; jp < np; jp++) {
+        auto *dst = bpack.data() + jp * NR * kb;
+        for (size_t p = 0; p < kb; p++) {
+          for (size_t j = 0; j < NR; j++) {
+            auto col = jp * NR + j;
+            dst[p * NR + j] = col < nb ? B(pc + p, jc + col) : 0.0f;
+          }
+        }
+      }
+
+      auto block = [&](size_t ib) {
+        auto ic = ib * mc;
+        auto mb = std::min(mc, M - ic);
+        auto mp = (mb + MR - 1) / MR;
+
+        thread_local std::vector<float> apack;
+        apack.resize(mp * MR * kb);
+        for (size_t ip = 0; ip < mp; ip++) {
+          auto *dst = apack.data() + ip * MR * kb;
+          for (size_t p = 0; p < kb; p++) {
+            for (size_t r = 0; r < MR; r++) {
+              auto row = ip * MR + r;
+              dst[p * MR + r] = row < mb ? A(ic + row, pc + p) : 0.0f;
+            }
+          }
+        }
+
+        for (size_t jp = 0; jp < np; jp++) {
+          auto nr = std::min(NR, nb - jp * NR);
+          for (size_t ip = 0; ip < mp; ip++) {
+            auto mr = std::min(MR, mb - ip * MR);
+            Micro(kb, apack.data() + ip * MR * kb, bpack.data() + jp * NR * kb,
+                  c + (ic + ip * MR) * ldc + jc + jp * NR, ldc, mr, nr);
+          }
+        }
+      };
+
+      auto mblocks = (M + mc - 1) / mc;
+      if (mblocks > 1 && M * nb * kb >= kParallelGrain * 16) {
+        parallel_for(mblocks, block);
+      } else {
+        for (size_t ib = 0; ib < mblocks; ib++) block(ib);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Scalar tier
+//-----------------------------------------------------------------------------
+
+namespace scalar_kernels {
+
+template <typename Op>
+inline void binary(const float *a, size_t a_len, const float *b, size_t b_len,
+                   float *out, size_t n) {
+  if (a_len == n && b_len == n) {
+    for (size_t i = 0; i < n; i++) out[i] = Op::apply(a[i], b[i]);
+    return;
+  }
+  binary_modulo_<Op>(a, a_len, b, b_len, out, n);
+}
+
+inline void affine(const float *in, float *out, size_t n, float scale,
+                   float offset) {
+  for (size_t i = 0; i < n; i++) out[i] = in[i] * scale + offset;
+}
+
+inline void u8_affine(const uint8_t *in, float *out, size_t n, float scale,
+                      float offset) {
+  for (size_t i = 0; i < n; i++) out[i] = in[i] * scale + offset;
+}
+
+inline void sigmoid(const float *in, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+inline void relu(const float *in, float *out, size_t n) {
+  for (size_t i = 0; i < n; i++) out[i] = std::max(in[i], 0.0f);
+}
+
+inline void unary(unary_op op, const float *in, float *out, size_t n,
+                  const unary_args &a) {
+  for (size_t i = 0; i < n; i++) {
+    auto y = unary_ref_(op, in[i] * a.scale + a.offset, a.lo, a.hi);
+    out[i] = y * a.post_scale + a.post_offset;
+  }
+}
+
+inline void unary_backward(unary_op op, const float *dout, const float *x,
+                           float *dx, size_t n, const unary_args &a) {
+  for (size_t i = 0; i < n; i++)
+    dx[i] = dout[i] * unary_grad_ref_(op, x[i], a.lo, a.hi);
+}
+
+inline float sum(const float *in, size_t n) {
+  float s = 0.0f;
+  for (size_t i = 0; i < n; i++) s += in[i];
+  return s;
+}
+
+inline float min(const float *in, size_t n) {
+  return n ? *std::min_element(in, in + n) : INFINITY;
+}
+
+inline float max(const float *in, size_t n) {
+  return n ? *std::max_element(in, in + n) : -INFINITY;
+}
+
+inline void layer_norm(const float *src, float *dst, const float *gamma,
+                       const float *beta, size_t rows, size_t cols, float eps,
+                       float *mean, float *rstd) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+
+    // Welford: running mean and sum of squared deviations in one pass
+    float mu = 0.0f, m2 = 0.0f;
+    for (size_t c = 0; c < cols; c++) {
+      float d = row[c] - mu;
+      mu += d / (c + 1);
+      m2 += d * (row[c] - mu);
+    }
+    float inv_std = 1.0f / std::sqrt(m2 / cols + eps);
+    if (mean) mean[r] = mu;
+    if (rstd) rstd[r] = inv_std;
+    for (size_t c = 0; c < cols; c++)
+      out[c] = (row[c] - mu) * inv_std * gamma[c] + beta[c];
+  }
+}
+
+inline void layer_norm_backward(const float *dout, const float *x,
+                                const float *mean, const float *rstd,
+                                const float *gamma, float *dx, float *dgamma,
+                                float *dbeta, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *dy = dout + r * cols;
+    const float *row = x + r * cols;
+    float *out = dx + r * cols;
+    float mu = mean[r], inv_std = rstd[r];
+
+    float sum_g = 0.0f, sum_gx = 0.0f;
+    for (size_t c = 0; c < cols; c++) {
+      float xhat = (row[c] - mu) * inv_std;
+      float g = dy[c] * gamma[c];
+      sum_g += g;
+      sum_gx += g * xhat;
+      dgamma[c] += dy[c] * xhat;
+      dbeta[c] += dy[c];
+    }
+    float a = inv_std * sum_g / cols, b = inv_std * sum_gx / cols;
+    for (size_t c = 0; c < cols; c++) {
+      float xhat = (row[c] - mu) * inv_std;
+      out[c] = inv_std * dy[c] * gamma[c] - a - xhat * b;
+    }
+  }
+}
+
+inline void rms_norm(const float *src, float *dst, const float *gamma,
+                     size_t rows, size_t cols, float eps, float *rstd) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+    float ss = 0.0f;
+    for (size_t c = 0; c < cols; c++) ss += row[c] * row[c];
+    float inv_rms = 1.0f / std::sqrt(ss / cols + eps);
+    if (rstd) rstd[r] = inv_rms;
+    for (size_t c = 0; c < cols; c++) out[c] = row[c] * inv_rms * gamma[c];
+  }
+}
+
+inline void rms_norm_backward(const float *dout, const float *x,
+                              const float *rstd, const float *gamma, float *dx,
+                              float *dgamma, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *dy = dout + r * cols;
+    const float *row = x + r * cols;
+    float *out = dx + r * cols;
+    float inv_rms = rstd[r];
+
+    float sum_gx = 0.0f;
+    for (size_t c = 0; c < cols; c++) {
+      float xhat = row[c] * inv_rms;
+      sum_gx += dy[c] * gamma[c] * xhat;
+      dgamma[c] += dy[c] * xhat;
+    }
+    float b = inv_rms * sum_gx / cols;
+    for (size_t c = 0; c < cols; c++)
+      out[c] = inv_rms * dy[c] * gamma[c] - row[c] * inv_rms * b;
+  }
+}
+
+inline void softmax(const float *src, float *dst, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+    float m = max(row, cols);
+    float s = 0.0f;
+    for (size_t c = 0; c < cols; c++) s += (out[c] = std::exp(row[c] - m));
+    float inv = 1.0f / s;
+    for (size_t c = 0; c < cols; c++) out[c] *= inv;
+  }
+}
+
+inline double cross_entropy(const float *logits, const int *labels,
+                            float *dlogits, size_t rows, size_t cols,
+                            float grad_scale) {
+  double total = 0.0;
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = logits + r * cols;
+    float m = max(row, cols);
+    float s = 0.0f;
+    for (size_t c = 0; c < cols; c++) s += std::exp(row[c] - m);
+    total += std::log(s) + m - row[labels[r]];
+    if (dlogits) {
+      float *d = dlogits + r * cols;
+      float k = grad_scale / s;
+      for (size_t c = 0; c < cols; c++) d[c] = std::exp(row[c] - m) * k;
+      d[labels[r]] -= grad_scale;
+    }
+  }
+  return total;
+}
+
+inline double squared_error(const float *a, const float *b, float *grad,
+                            size_t n, float grad_scale) {
+  double total = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    float d = a[i] - b[i];
+    total += d * d;
+    if (grad) grad[i] = d * grad_scale;
+  }
+  return total;
+}
+
+inline float scan(scan_op op, const float *in, float *out, size_t n,
+                  float carry) {
+  for (size_t i = 0; i < n; i++) out[i] = carry = scan_combine_(op, carry, in[i]);
+  return carry;
+}
+
+inline void gemm_micro(size_t kb, const float *a, const float *b, float *c,
+                       size_t ldc, size_t mr, size_t nr) {
+  float acc[kGemmMR][kGemmNR] = {};
+  for (size_t p = 0; p < kb; p++, a += kGemmMR, b += kGemmNR)
+    for (size_t r = 0; r < kGemmMR; r++)
+      for (size_t j = 0; j < kGemmNR; j++) acc[r][j] += a[r] * b[j];
+  for (size_t r = 0; r < mr; r++)
+    for (size_t j = 0; j < nr; j++) c[r * ldc + j] += acc[r][j];
+}
+
+inline void sgemm(bool ta, bool tb, size_t M, size_t N, size_t K,
+                  const float *a, size_t lda, const float *b, size_t ldb,
+                  float *c, size_t ldc) {
+  packed_sgemm_<gemm_micro>(ta, tb, M, N, K, a, lda, b, ldb, c, ldc);
+}
+
+}  // namespace scalar_kernels
+
+//-----------------------------------------------------------------------------
+// NEON tier
+//-----------------------------------------------------------------------------
+
+namespace neon_kernels {
+
+// exp(x) via Cody-Waite range reduction and a degree-6 polynomial on
+// [-ln2/2, ln2/2]; max relative error ~2 ulp over the clamped range.
+inline float32x4_t exp_f32x4(float32x4_t x) {
+  x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-87.33654f)), vdupq_n_f32(88.0f));
+  auto fx = vrndmq_f32(
+      vfmaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(1.44269504088896341f)));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(0.693359375f));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(-2.12194440e-4f));
+
+  auto y = vdupq_n_f32(1.9875691500e-4f);
+  y = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), y, x);
+  y = vfmaq_f32(vaddq_f32(x, vdupq_n_f32(1.0f)), y, vmulq_f32(x, x));
+
+  auto e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(127)), 23);
+  return vmulq_f32(y, vreinterpretq_f32_s32(e));
+}
+
+// log(x) = e·ln2 + log(m) with m in [sqrt(1/2), sqrt(2)) and the Cephes
+// logf polynomial in m - 1. Subnormals are rescaled by 2^23 first. Negative
+// and NaN inputs give NaN, zero gives -inf.
+inline float32x4_t log_f32x4(float32x4_t x) {
+  auto one = vdupq_n_f32(1.0f);
+  auto sub = vcltq_f32(x, vdupq_n_f32(1.17549435e-38f));
+  auto xi = vreinterpretq_u32_f32(
+      vbslq_f32(sub, vmulq_n_f32(x, 8388608.0f), x));
+  auto e = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(xi, 23)),
+                     vdupq_n_s32(126));
+  auto m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(xi, vdupq_n_u32(0x007fffff)),
+                                           vdupq_n_u32(0x3f000000)));
+  auto fe = vsubq_f32(vcvtq_f32_s32(e),
+                      vreinterpretq_f32_u32(vandq_u32(
+                          sub, vreinterpretq_u32_f32(vdupq_n_f32(23.0f)))));
+
+  // m in [0.5, 1): below sqrt(1/2) use 2m - 1 and one less in the exponent
+  auto small = vcltq_f32(m, vdupq_n_f32(0.707106781186547524f));
+  fe = vsubq_f32(fe, vreinterpretq_f32_u32(vandq_u32(small, vreinterpretq_u32_f32(one))));
+  m = vaddq_f32(vsubq_f32(m, one),
+                vreinterpretq_f32_u32(vandq_u32(small, vreinterpretq_u32_f32(m))));
+
+  auto z = vmulq_f32(m, m);
+  auto y = vdupq_n_f32(7.0376836292e-2f);
+  y = vfmaq_f32(vdupq_n_f32(-1.1514610310e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(1.1676998740e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(-1.2420140846e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(1.4249322787e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(-1.6668057665e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(2.0000714765e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(-2.4999993993e-1f), y, m);
+  y = vfmaq_f32(vdupq_n_f32(3.3333331174e-1f), y, m);
+  y = vmulq_f32(vmulq_f32(y, m), z);
+  y = vfmaq_f32(y, fe, vdupq_n_f32(-2.12194440e-4f));
+  y = vfmsq_f32(y, z, vdupq_n_f32(0.5f));
+  auto r = vfmaq_f32(vaddq_f32(m, y), fe, vdupq_n_f32(0.693359375f));
+
+  // Special cases: x < 0 or NaN, x == 0, x == inf
+  auto nan = vdupq_n_f32(NAN), inf = vdupq_n_f32(INFINITY);
+  r = vbslq_f32(vcgeq_f32(x, vdupq_n_f32(0.0f)), r, nan);
+  r = vbslq_f32(vceqq_f32(x, vdupq_n_f32(0.0f)), vnegq_f32(inf), r);
+  return vbslq_f32(vceqq_f32(x, inf), inf, r);
+}
+
+// Flushes to zero below -87.3, where exp(-x) would saturate
+inline float32x4_t sigmoid_f32x4(float32x4_t x) {
+  auto one = vdupq_n_f32(1.0f);
+  auto s = vdivq_f32(one, vaddq_f32(one, exp_f32x4(vnegq_f32(x))));
+  return vbslq_f32(vcltq_f32(x, vdupq_n_f32(-87.33654f)), vdupq_n_f32(0.0f), s);
+}
+
+// Odd polynomial below |x| = 0.625 (Cephes tanhf), 1 - 2 / (exp(2|x|) + 1)
+// above it with the sign restored.
+inline float32x4_t tanh_f32x4(float32x4_t x) {
+  auto ax = vabsq_f32(x);
+  auto z = vmulq_f32(x, x);
+  auto p = vdupq_n_f32(-5.70498872745e-3f);
+  p = vfmaq_f32(vdupq_n_f32(2.06390887954e-2f), p, z);
+  p = vfmaq_f32(vdupq_n_f32(-5.37397155531e-2f), p, z);
+  p = vfmaq_f32(vdupq_n_f32(1.33314422036e-1f), p, z);
+  p = vfmaq_f32(vdupq_n_f32(-3.33332819422e-1f), p, z);
+  auto near = vfmaq_f32(x, vmulq_f32(p, z), x);
+
+  auto one = vdupq_n_f32(1.0f);
+  auto e = exp_f32x4(vaddq_f32(ax, ax));
+  auto far = vsubq_f32(one, vdivq_f32(vdupq_n_f32(2.0f), vaddq_f32(e, one)));
+  far = vbslq_f32(vdupq_n_u32(0x80000000), x, far);  // copysign
+  return vbslq_f32(vcltq_f32(ax, vdupq_n_f32(0.625f)), near, far);
+}
+
+// Estimate refined by two Newton steps. The estimate is already exact for
+// 0 and inf, where the steps would produce 0 · inf.
+inline float32x4_t rsqrt_f32x4(float32x4_t x) {
+  auto e0 = vrsqrteq_f32(x);
+  auto e = vmulq_f32(e0, vrsqrtsq_f32(vmulq_f32(x, e0), e0));
+  e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(x, e), e));
+  auto exact = vorrq_u32(vceqq_f32(x, vdupq_n_f32(0.0f)),
+                         vceqq_f32(x, vdupq_n_f32(INFINITY)));
+  return vbslq_f32(exact, e0, e);
+}
+
+// GELU as x·sigmoid(2u), u = sqrt(2/pi)·x·(1 + 0.044715·x²), which equals
+// 0.5·x·(1 + tanh(u)) without the cancellation near tanh(u) = -1
+inline float32x4_t gelu_arg_f32x4(float32x4_t x) {
+  auto t = vfmaq_n_f32(vdupq_n_f32(1.0f), vmulq_f32(x, x), kGeluC);
+  return vmulq_f32(vmulq_n_f32(x, 2.0f * kGeluK), t);
+}
+
+template <typename Op>
+inline void binary_vv_(const float *a, const float *b, float *out, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_f32(out + i, Op::apply(vld1q_f32(a + i), vld1q_f32(b + i)));
+    vst1q_f32(out + i + 4, Op::apply(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(out + i, Op::apply(vld1q_f32(a + i), vld1q_f32(b + i)));
+  for (; i < n; i++) out[i] = Op::apply(a[i], b[i]);
+}
+
+// One side is a scalar broadcast; `scalar_lhs` keeps operand order for sub/div
+template <typename Op, bool scalar_lhs>
+inline void binary_vs_(const float *v, float s, float *out, size_t n) {
+  auto vs = vdupq_n_f32(s);
+  auto apply = [&](float32x4_t x) {
+    return scalar_lhs ? Op::apply(vs, x) : Op::apply(x, vs);
+  };
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_f32(out + i, apply(vld1q_f32(v + i)));
+    vst1q_f32(out + i + 4, apply(vld1q_f32(v + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4) vst1q_f32(out + i, apply(vld1q_f32(v + i)));
+  for (; i < n; i++) out[i] = scalar_lhs ? Op::apply(s, v[i]) : Op::apply(v[i], s);
+}
+
+template <typename Op>
+inline void binary(const float *a, size_t a_len, const float *b, size_t b_len,
+                   float *out, size_t n) {
+  if (a_len == n && b_len == n) return binary_vv_<Op>(a, b, out, n);
+  if (a_len == n && b_len == 1) return binary_vs_<Op, false>(a, b[0], out, n);
+  if (a_len == 1 && b_len == n) return binary_vs_<Op, true>(b, a[0], out, n);
+  if (a_len == n && b_len > 1 && n % b_len == 0) {
+    for (size_t i = 0; i < n; i += b_len) binary_vv_<Op>(a + i, b, out + i, b_len);
+    return;
+  }
+  if (b_len == n && a_len > 1 && n % a_len == 0) {
+    for (size_t i = 0; i < n; i += a_len) binary_vv_<Op>(a, b + i, out + i, a_len);
+    return;
+  }
+  binary_modulo_<Op>(a, a_len, b, b_len, out, n);
+}
+
+// out[i] = in[i] * scale + offset — single-pass FMA
+inline void affine(const float *in, float *out, size_t n, float scale,
+                   float offset) {
+  float32x4_t vs = vdupq_n_f32(scale);
+  float32x4_t vo = vdupq_n_f32(offset);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    float32x4_t v0 = vld1q_f32(in + i);
+    float32x4_t v1 = vld1q_f32(in + i + 4);
+    float32x4_t v2 = vld1q_f32(in + i + 8);
+    float32x4_t v3 = vld1q_f32(in + i + 12);
+    vst1q_f32(out + i,      vfmaq_f32(vo, v0, vs));
+    vst1q_f32(out + i + 4,  vfmaq_f32(vo, v1, vs));
+    vst1q_f32(out + i + 8,  vfmaq_f32(vo, v2, vs));
+    vst1q_f32(out + i + 12, vfmaq_f32(vo, v3, vs));
+  }
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t v = vld1q_f32(in + i);
+    vst1q_f32(out + i, vfmaq_f32(vo, v, vs));
+  }
+  for (; i < n; i++)
+    out[i] = in[i] * scale + offset;
+}
+
+// 16 bytes per step, widened u8 -> u16 -> u32 -> f32 in registers with the
+// FMA applied before the store, so the float data is written exactly once
+inline void u8_affine(const uint8_t *in, float *out, size_t n, float scale,
+                      float offset) {
+  float32x4_t vs = vdupq_n_f32(scale);
+  float32x4_t vo = vdupq_n_f32(offset);
+  auto fma = [&](uint32x4_t v) { return vfmaq_f32(vo, vcvtq_f32_u32(v), vs); };
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t b = vld1q_u8(in + i);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(b));
+    uint16x8_t hi = vmovl_high_u8(b);
+    vst1q_f32(out + i,      fma(vmovl_u16(vget_low_u16(lo))));
+    vst1q_f32(out + i + 4,  fma(vmovl_high_u16(lo)));
+    vst1q_f32(out + i + 8,  fma(vmovl_u16(vget_low_u16(hi))));
+    vst1q_f32(out + i + 12, fma(vmovl_high_u16(hi)));
+  }
+  for (; i < n; i++)
+    out[i] = in[i] * scale + offset;
+}
+
+inline void sigmoid(const float *in, float *out, size_t n) {
+  auto one = vdupq_n_f32(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto e = exp_f32x4(vnegq_f32(vld1q_f32(in + i)));
+    vst1q_f32(out + i, vdivq_f32(one, vaddq_f32(one, e)));
+  }
+  for (; i < n; i++) out[i] = 1.0f / (1.0f + std::exp(-in[i]));
+}
+
+inline void relu(const float *in, float *out, size_t n) {
+  auto zero = vdupq_n_f32(0.0f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_f32(out + i, vmaxq_f32(vld1q_f32(in + i), zero));
+    vst1q_f32(out + i + 4, vmaxq_f32(vld1q_f32(in + i + 4), zero));
+  }
+  for (; i + 4 <= n; i += 4) vst1q_f32(out + i, vmaxq_f32(vld1q_f32(in + i), zero));
+  for (; i < n; i++) out[i] = std::max(in[i], 0.0f);
+}
+
+// out = f(in * scale + offset) * post_scale + post_offset. The tail runs
+// through a padded vector so every element takes the same code path.
+template <typename F>
+inline void unary_map_(const float *in, float *out, size_t n,
+                       const unary_args &a, F f) {
+  auto s = vdupq_n_f32(a.scale), o = vdupq_n_f32(a.offset);
+  auto ps = vdupq_n_f32(a.post_scale), po = vdupq_n_f32(a.post_offset);
+  auto apply = [&](float32x4_t x) {
+    return vfmaq_f32(po, f(vfmaq_f32(o, x, s)), ps);
+  };
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1q_f32(out + i, apply(vld1q_f32(in + i)));
+    vst1q_f32(out + i + 4, apply(vld1q_f32(in + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4) vst1q_f32(out + i, apply(vld1q_f32(in + i)));
+  if (i < n) {
+    float buf[4] = {};
+    std::memcpy(buf, in + i, (n - i) * sizeof(float));
+    vst1q_f32(buf, apply(vld1q_f32(buf)));
+    std::memcpy(out + i, buf, (n - i) * sizeof(float));
+  }
+}
+
+// dx = dout * df(x)
+template <typename F>
+inline void unary_backward_map_(const float *dout, const float *x, float *dx,
+                                size_t n, F df) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(dx + i, vmulq_f32(vld1q_f32(dout + i), df(vld1q_f32(x + i))));
+  if (i < n) {
+    float g[4] = {}, v[4] = {};
+    std::memcpy(g, dout + i, (n - i) * sizeof(float));
+    std::memcpy(v, x + i, (n - i) * sizeof(float));
+    vst1q_f32(g, vmulq_f32(vld1q_f32(g), df(vld1q_f32(v))));
+    std::memcpy(dx + i, g, (n - i) * sizeof(float));
+  }
+}
+
+inline void unary(unary_op op, const float *in, float *out, size_t n,
+                  const unary_args &a) {
+  switch (op) {
+    case unary_op::exp:
+      return unary_map_(in, out, n, a, [](auto x) { return exp_f32x4(x); });
+    case unary_op::log:
+      return unary_map_(in, out, n, a, [](auto x) { return log_f32x4(x); });
+    case unary_op::tanh:
+      return unary_map_(in, out, n, a, [](auto x) { return tanh_f32x4(x); });
+    case unary_op::gelu:
+      return unary_map_(in, out, n, a, [](auto x) {
+        return vmulq_f32(x, sigmoid_f32x4(gelu_arg_f32x4(x)));
+      });
+    case unary_op::silu:
+      return unary_map_(in, out, n, a,
+                        [](auto x) { return vmulq_f32(x, sigmoid_f32x4(x)); });
+    case unary_op::sqrt:
+      return unary_map_(in, out, n, a, [](auto x) { return vsqrtq_f32(x); });
+    case unary_op::rsqrt:
+      return unary_map_(in, out, n, a, [](auto x) { return rsqrt_f32x4(x); });
+    case unary_op::abs:
+      return unary_map_(in, out, n, a, [](auto x) { return vabsq_f32(x); });
+    case unary_op::clamp: {
+      auto lo = vdupq_n_f32(a.lo), hi = vdupq_n_f32(a.hi);
+      return unary_map_(in, out, n, a, [&](auto x) {
+        return vminq_f32(vmaxq_f32(x, lo), hi);
+      });
+    }
+  }
+}
+
+inline void unary_backward(unary_op op, const float *dout, const float *x,
+                           float *dx, size_t n, const unary_args &a) {
+  auto one = vdupq_n_f32(1.0f);
+  switch (op) {
+    case unary_op::exp:
+      return unary_backward_map_(dout, x, dx, n,
+                                 [](auto v) { return exp_f32x4(v); });
+    case unary_op::log:
+      return unary_backward_map_(dout, x, dx, n,
+                                 [&](auto v) { return vdivq_f32(one, v); });
+    case unary_op::tanh:
+      return unary_backward_map_(dout, x, dx, n, [&](auto v) {
+        auto t = tanh_f32x4(v);
+        return vfmsq_f32(one, t, t);
+      });
+    case unary_op::gelu:
+      // s + x·s·(1 - s)·2u' with s = sigmoid(2u)
+      return unary_backward_map_(dout, x, dx, n, [&](auto v) {
+        auto s = sigmoid_f32x4(gelu_arg_f32x4(v));
+        auto du = vmulq_n_f32(vfmaq_n_f32(one, vmulq_f32(v, v), 3.0f * kGeluC),
+                              2.0f * kGeluK);
+        auto ds = vmulq_f32(s, vsubq_f32(one, s));
+        return vfmaq_f32(s, vmulq_f32(v, ds), du);
+      });
+    case unary_op::silu:
+      // s·(1 + x·(1 - s)) with s = sigmoid(x)
+      return unary_backward_map_(dout, x, dx, n, [&](auto v) {
+        auto s = sigmoid_f32x4(v);
+        return vmulq_f32(s, vfmaq_f32(one, v, vsubq_f32(one, s)));
+      });
+    case unary_op::sqrt:
+      return unary_backward_map_(dout, x, dx, n, [](auto v) {
+        return vmulq_n_f32(rsqrt_f32x4(v), 0.5f);
+      });
+    case unary_op::rsqrt:
+      return unary_backward_map_(dout, x, dx, n, [](auto v) {
+        auto r = rsqrt_f32x4(v);
+        return vmulq_n_f32(vmulq_f32(vmulq_f32(r, r), r), -0.5f);
+      });
+    case unary_op::abs:
+      return unary_backward_map_(dout, x, dx, n, [&](auto v) {
+        auto zero = vdupq_n_f32(0.0f);
+        auto pos = vandq_u32(vcgtq_f32(v, zero), vreinterpretq_u32_f32(one));
+        auto neg = vandq_u32(vcltq_f32(v, zero), vreinterpretq_u32_f32(one));
+        return vsubq_f32(vreinterpretq_f32_u32(pos), vreinterpretq_f32_u32(neg));
+      });
+    case unary_op::clamp: {
+      auto lo = vdupq_n_f32(a.lo), hi = vdupq_n_f32(a.hi);
+      return unary_backward_map_(dout, x, dx, n, [&](auto v) {
+        auto in = vandq_u32(vcgeq_f32(v, lo), vcleq_f32(v, hi));
+        return vreinterpretq_f32_u32(vandq_u32(in, vreinterpretq_u32_f32(one)));
+      });
+    }
+  }
+}
+
+inline float sum(const float *in, size_t n) {
+  auto s0 = vdupq_n_f32(0.0f), s1 = s0, s2 = s0, s3 = s0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    s0 = vaddq_f32(s0, vld1q_f32(in + i));
+    s1 = vaddq_f32(s1, vld1q_f32(in + i + 4));
+    s2 = vaddq_f32(s2, vld1q_f32(in + i + 8));
+    s3 = vaddq_f32(s3, vld1q_f32(in + i + 12));
+  }
+  for (; i + 4 <= n; i += 4) s0 = vaddq_f32(s0, vld1q_f32(in + i));
+  float s = vaddvq_f32(vaddq_f32(vaddq_f32(s0, s1), vaddq_f32(s2, s3)));
+  for (; i < n; i++) s += in[i];
+  return s;
+}
+
+inline float min(const float *in, size_t n) {
+  auto m = vdupq_n_f32(INFINITY);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) m = vminq_f32(m, vld1q_f32(in + i));
+  float r = vminvq_f32(m);
+  for (; i < n; i++) r = std::min(r, in[i]);
+  return r;
+}
+
+inline float max(const float *in, size_t n) {
+  auto m = vdupq_n_f32(-INFINITY);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) m = vmaxq_f32(m, vld1q_f32(in + i));
+  float r = vmaxvq_f32(m);
+  for (; i < n; i++) r = std::max(r, in[i]);
+  return r;
+}
+
+// Welford over 8 lanes, then Chan's merge of the lanes and the tail:
+// one read of the row for (mean, sum of squared deviations)
+inline void welford_row_(const float *row, size_t cols, float &mean,
+                         float &m2) {
+  auto m0 = vdupq_n_f32(0.0f), m1 = m0, s0 = m0, s1 = m0;
+  size_t c = 0, k = 0;
+  for (; c + 8 <= cols; c += 8) {
+    auto inv = vdupq_n_f32(1.0f / ++k);
+    auto x0 = vld1q_f32(row + c), x1 = vld1q_f32(row + c + 4);
+    auto d0 = vsubq_f32(x0, m0), d1 = vsubq_f32(x1, m1);
+    m0 = vfmaq_f32(m0, d0, inv);
+    m1 = vfmaq_f32(m1, d1, inv);
+    s0 = vfmaq_f32(s0, d0, vsubq_f32(x0, m0));
+    s1 = vfmaq_f32(s1, d1, vsubq_f32(x1, m1));
+  }
+
+  // Every lane saw k values: M2 = sum(M2_l) + k * sum((mean_l - mean)^2)
+  float mu = 0.0f, ss = 0.0f;
+  if (k) {
+    mu = vaddvq_f32(vaddq_f32(m0, m1)) / 8;
+    auto vmu = vdupq_n_f32(mu);
+    auto d0 = vsubq_f32(m0, vmu), d1 = vsubq_f32(m1, vmu);
+    auto spread = vaddvq_f32(vfmaq_f32(vmulq_f32(d0, d0), d1, d1));
+    ss = vaddvq_f32(vaddq_f32(s0, s1)) + k * spread;
+  }
+  for (size_t n = 8 * k; c < cols; c++) {
+    float d = row[c] - mu;
+    mu += d / ++n;
+    ss += d * (row[c] - mu);
+  }
+  mean = mu;
+  m2 = ss;
+}
+
+inline float sum_squares_(const float *row, size_t cols) {
+  auto a0 = vdupq_n_f32(0.0f), a1 = a0;
+  size_t c = 0;
+  for (; c + 8 <= cols; c += 8) {
+    auto x0 = vld1q_f32(row + c), x1 = vld1q_f32(row + c + 4);
+    a0 = vfmaq_f32(a0, x0, x0);
+    a1 = vfmaq_f32(a1, x1, x1);
+  }
+  float ss = vaddvq_f32(vaddq_f32(a0, a1));
+  for (; c < cols; c++) ss += row[c] * row[c];
+  return ss;
+}
+
+inline void layer_norm(const float *src, float *dst, const float *gamma,
+                       const float *beta, size_t rows, size_t cols, float eps,
+                       float *mean, float *rstd) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+
+    float mu, m2;
+    welford_row_(row, cols, mu, m2);
+    float inv_std = 1.0f / std::sqrt(m2 / cols + eps);
+    if (mean) mean[r] = mu;
+    if (rstd) rstd[r] = inv_std;
+
+    auto vmu = vdupq_n_f32(mu);
+    auto vinv = vdupq_n_f32(inv_std);
+    size_t c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto x = vmulq_f32(vsubq_f32(vld1q_f32(row + c), vmu), vinv);
+      vst1q_f32(out + c, vfmaq_f32(vld1q_f32(beta + c), x, vld1q_f32(gamma + c)));
+    }
+    for (; c < cols; c++) out[c] = (row[c] - mu) * inv_std * gamma[c] + beta[c];
+  }
+}
+
+// dx = rstd * (g - mean(g) - xhat * mean(g * xhat)) with g = dout * gamma.
+// The first pass also accumulates dgamma/dbeta; the row is still in cache
+// for the second.
+inline void layer_norm_backward(const float *dout, const float *x,
+                                const float *mean, const float *rstd,
+                                const float *gamma, float *dx, float *dgamma,
+                                float *dbeta, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *dy = dout + r * cols;
+    const float *row = x + r * cols;
+    float *out = dx + r * cols;
+    float mu = mean[r], inv_std = rstd[r];
+    auto vmu = vdupq_n_f32(mu);
+    auto vinv = vdupq_n_f32(inv_std);
+
+    auto acc_g = vdupq_n_f32(0.0f), acc_gx = acc_g;
+    size_t c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto d = vld1q_f32(dy + c);
+      auto xhat = vmulq_f32(vsubq_f32(vld1q_f32(row + c), vmu), vinv);
+      auto g = vmulq_f32(d, vld1q_f32(gamma + c));
+      acc_g = vaddq_f32(acc_g, g);
+      acc_gx = vfmaq_f32(acc_gx, g, xhat);
+      vst1q_f32(dgamma + c, vfmaq_f32(vld1q_f32(dgamma + c), d, xhat));
+      vst1q_f32(dbeta + c, vaddq_f32(vld1q_f32(dbeta + c), d));
+    }
+    float sum_g = vaddvq_f32(acc_g), sum_gx = vaddvq_f32(acc_gx);
+    for (; c < cols; c++) {
+      float xhat = (row[c] - mu) * inv_std;
+      float g = dy[c] * gamma[c];
+      sum_g += g;
+      sum_gx += g * xhat;
+      dgamma[c] += dy[c] * xhat;
+      dbeta[c] += dy[c];
+    }
+
+    float a = inv_std * sum_g / cols, b = inv_std * sum_gx / cols;
+    auto va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+    c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto xhat = vmulq_f32(vsubq_f32(vld1q_f32(row + c), vmu), vinv);
+      auto g = vmulq_f32(vld1q_f32(dy + c), vld1q_f32(gamma + c));
+      vst1q_f32(out + c, vfmsq_f32(vsubq_f32(vmulq_f32(g, vinv), va), xhat, vb));
+    }
+    for (; c < cols; c++) {
+      float xhat = (row[c] - mu) * inv_std;
+      out[c] = inv_std * dy[c] * gamma[c] - a - xhat * b;
+    }
+  }
+}
+
+inline void rms_norm(const float *src, float *dst, const float *gamma,
+                     size_t rows, size_t cols, float eps, float *rstd) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+    float inv_rms = 1.0f / std::sqrt(sum_squares_(row, cols) / cols + eps);
+    if (rstd) rstd[r] = inv_rms;
+
+    auto vinv = vdupq_n_f32(inv_rms);
+    size_t c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto x = vmulq_f32(vld1q_f32(row + c), vinv);
+      vst1q_f32(out + c, vmulq_f32(x, vld1q_f32(gamma + c)));
+    }
+    for (; c < cols; c++) out[c] = row[c] * inv_rms * gamma[c];
+  }
+}
+
+// dx = rstd * (g - xhat * mean(g * xhat)) with g = dout * gamma
+inline void rms_norm_backward(const float *dout, const float *x,
+                              const float *rstd, const float *gamma, float *dx,
+                              float *dgamma, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *dy = dout + r * cols;
+    const float *row = x + r * cols;
+    float *out = dx + r * cols;
+    float inv_rms = rstd[r];
+    auto vinv = vdupq_n_f32(inv_rms);
+
+    auto acc = vdupq_n_f32(0.0f);
+    size_t c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto d = vld1q_f32(dy + c);
+      auto xhat = vmulq_f32(vld1q_f32(row + c), vinv);
+      acc = vfmaq_f32(acc, vmulq_f32(d, vld1q_f32(gamma + c)), xhat);
+      vst1q_f32(dgamma + c, vfmaq_f32(vld1q_f32(dgamma + c), d, xhat));
+    }
+    float sum_gx = vaddvq_f32(acc);
+    for (; c < cols; c++) {
+      float xhat = row[c] * inv_rms;
+      sum_gx += dy[c] * gamma[c] * xhat;
+      dgamma[c] += dy[c] * xhat;
+    }
+
+    float b = inv_rms * sum_gx / cols;
+    auto vb = vdupq_n_f32(b);
+    c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto xhat = vmulq_f32(vld1q_f32(row + c), vinv);
+      auto g = vmulq_f32(vld1q_f32(dy + c), vld1q_f32(gamma + c));
+      vst1q_f32(out + c, vfmsq_f32(vmulq_f32(g, vinv), xhat, vb));
+    }
+    for (; c < cols; c++)
+      out[c] = inv_rms * dy[c] * gamma[c] - row[c] * inv_rms * b;
+  }
+}
+
+inline void softmax(const float *src, float *dst, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+
+    auto vm = vdupq_n_f32(max(row, cols));
+    auto acc = vdupq_n_f32(0.0f);
+    size_t c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto e = exp_f32x4(vsubq_f32(vld1q_f32(row + c), vm));
+      vst1q_f32(out + c, e);
+      acc = vaddq_f32(acc, e);
+    }
+    float s = vaddvq_f32(acc);
+    float m = vgetq_lane_f32(vm, 0);
+    for (; c < cols; c++) s += (out[c] = std::exp(row[c] - m));
+
+    affine(out, out, cols, 1.0f / s, 0.0f);
+  }
+}
+
+// Per row: max, then exp(x - max) summed (and kept in dlogits when the
+// gradient is wanted, so the second pass is a scale over cached values)
+inline double cross_entropy(const float *logits, const int *labels,
+                            float *dlogits, size_t rows, size_t cols,
+                            float grad_scale) {
+  double total = 0.0;
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = logits + r * cols;
+    float *d = dlogits ? dlogits + r * cols : nullptr;
+    float m = max(row, cols);
+    auto vm = vdupq_n_f32(m);
+    auto acc = vdupq_n_f32(0.0f);
+    size_t c = 0;
+    for (; c + 4 <= cols; c += 4) {
+      auto e = exp_f32x4(vsubq_f32(vld1q_f32(row + c), vm));
+      if (d) vst1q_f32(d + c, e);
+      acc = vaddq_f32(acc, e);
+    }
+    float s = vaddvq_f32(acc);
+    for (; c < cols; c++) {
+      float e = std::exp(row[c] - m);
+      if (d) d[c] = e;
+      s += e;
+    }
+    total += std::log(s) + m - row[labels[r]];
+    if (d) {
+      affine(d, d, cols, grad_scale / s, 0.0f);
+      d[labels[r]] -= grad_scale;
+    }
+  }
+  return total;
+}
+
+// Float lanes sum one block at a time; blocks are added up in double
+inline double squared_error(const float *a, const float *b, float *grad,
+                            size_t n, float grad_scale) {
+  constexpr size_t block = 1024;
+  auto k = vdupq_n_f32(grad_scale);
+  double total = 0.0;
+  size_t i = 0;
+  while (i + 8 <= n) {
+    auto a0 = vdupq_n_f32(0.0f), a1 = a0;
+    for (size_t end = std::min(n, i + block); i + 8 <= end; i += 8) {
+      auto d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+      auto d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+      a0 = vfmaq_f32(a0, d0, d0);
+      a1 = vfmaq_f32(a1, d1, d1);
+      if (grad) {
+        vst1q_f32(grad + i, vmulq_f32(d0, k));
+        vst1q_f32(grad + i + 4, vmulq_f32(d1, k));
+      }
+    }
+    total += vaddvq_f32(vaddq_f32(a0, a1));
+  }
+  for (; i < n; i++) {
+    float d = a[i] - b[i];
+    total += d * d;
+    if (grad) grad[i] = d * grad_scale;
+  }
+  return total;
+}
+
+// In-register scan: each 4-lane vector is scanned with two shift-and-combine
+// steps (shifting in the identity), then the pair of vectors is chained
+// through the broadcast last lane. logaddexp has no cheap vector form and
+// stays scalar.
+template <typename Op>
+inline float scan_lanes_(const float *in, float *out, size_t n, float carry,
+                         float identity) {
+  auto id = vdupq_n_f32(identity);
+  auto c = vdupq_n_f32(carry);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto x0 = vld1q_f32(in + i), x1 = vld1q_f32(in + i + 4);
+    x0 = Op::apply(x0, vextq_f32(id, x0, 3));
+    x1 = Op::apply(x1, vextq_f32(id, x1, 3));
+    x0 = Op::apply(x0, vextq_f32(id, x0, 2));
+    x1 = Op::apply(x1, vextq_f32(id, x1, 2));
+    x0 = Op::apply(x0, c);
+    x1 = Op::apply(x1, vdupq_laneq_f32(x0, 3));
+    c = vdupq_laneq_f32(x1, 3);
+    vst1q_f32(out + i, x0);
+    vst1q_f32(out + i + 4, x1);
+  }
+  carry = vgetq_lane_f32(c, 0);
+  for (; i < n; i++) out[i] = carry = Op::apply(carry, in[i]);
+  return carry;
+}
+
+inline float scan(scan_op op, const float *in, float *out, size_t n,
+                  float carry) {
+  switch (op) {
+    case scan_op::sum: return scan_lanes_<op_add_>(in, out, n, carry, 0.0f);
+    case scan_op::prod: return scan_lanes_<op_mul_>(in, out, n, carry, 1.0f);
+    case scan_op::logaddexp: break;
+  }
+  return scalar_kernels::scan(op, in, out, n, carry);
+}
+
+// 8×8 register-blocked microkernel: 16 accumulators, A broadcast by lane
+inline void gemm_micro(size_t kb, const float *a, const float *b, float *c,
+                       size_t ldc, size_t mr, size_t nr) {
+  float32x4_t c00 = vdupq_n_f32(0), c01 = c00, c10 = c00, c11 = c00,
+              c20 = c00, c21 = c00, c30 = c00, c31 = c00,
+              c40 = c00, c41 = c00, c50 = c00, c51 = c00,
+              c60 = c00, c61 = c00, c70 = c00, c71 = c00;
+
+  for (size_t p = 0; p < kb; p++, a += kGemmMR, b += kGemmNR) {
+    auto b0 = vld1q_f32(b), b1 = vld1q_f32(b + 4);
+    auto a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4);
+    c00 = vfmaq_laneq_f32(c00, b0, a0, 0); c01 = vfmaq_laneq_f32(c01, b1, a0, 0);
+    c10 = vfmaq_laneq_f32(c10, b0, a0, 1); c11 = vfmaq_laneq_f32(c11, b1, a0, 1);
+    c20 = vfmaq_laneq_f32(c20, b0, a0, 2); c21 = vfmaq_laneq_f32(c21, b1, a0, 2);
+    c30 = vfmaq_laneq_f32(c30, b0, a0, 3); c31 = vfmaq_laneq_f32(c31, b1, a0, 3);
+    c40 = vfmaq_laneq_f32(c40, b0, a1, 0); c41 = vfmaq_laneq_f32(c41, b1, a1, 0);
+    c50 = vfmaq_laneq_f32(c50, b0, a1, 1); c51 = vfmaq_laneq_f32(c51, b1, a1, 1);
+    c60 = vfmaq_laneq_f32(c60, b0, a1, 2); c61 = vfmaq_laneq_f32(c61, b1, a1, 2);
+    c70 = vfmaq_laneq_f32(c70, b0, a1, 3); c71 = vfmaq_laneq_f32(c71, b1, a1, 3);
+  }
+
+  float32x4_t acc[kGemmMR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31},
+                                 {c40, c41}, {c50, c51}, {c60, c61}, {c70, c71}};
+  if (mr == kGemmMR && nr == kGemmNR) {
+    for (size_t r = 0; r < kGemmMR; r++) {
+      auto *row = c + r * ldc;
+      vst1q_f32(row, vaddq_f32(vld1q_f32(row), acc[r][0]));
+      vst1q_f32(row + 4, vaddq_f32(vld1q_f32(row + 4), acc[r][1]));
+    }
+    return;
+  }
+
+  float tmp[kGemmMR][kGemmNR];
+  for (size_t r = 0; r < kGemmMR; r++) {
+    vst1q_f32(tmp[r], acc[r][0]);
+    vst1q_f32(tmp[r] + 4, acc[r][1]);
+  }
+  for (size_t r = 0; r < mr; r++)
+    for (size_t j = 0; j < nr; j++) c[r * ldc + j] += tmp[r][j];
+}
+
+inline void sgemm(bool ta, bool tb, size_t M, size_t N, size_t K,
+                  const float *a, size_t lda, const float *b, size_t ldb,
+                  float *c, size_t ldc) {
+  packed_sgemm_<gemm_micro>(ta, tb, M, N, K, a, lda, b, ldb, c, ldc);
+}
+
+}  // namespace neon_kernels
+
+//-----------------------------------------------------------------------------
+// Accelerate tier
+//-----------------------------------------------------------------------------
+
+namespace accelerate_kernels {
+
+inline void add(const float *a, size_t a_len, const float *b, size_t b_len,
+                float *out, size_t n) {
+  if (a_len == n && b_len == n) { vDSP_vadd(a, 1, b, 1, out, 1, n); return; }
+  if (b_len == 1) { vDSP_vsadd(a, 1, b, out, 1, n); return; }
+  if (a_len == 1) { vDSP_vsadd(b, 1, a, out, 1, n); return; }
+  // Broadcast: repeat shorter side row-by-row with vDSP
+  if (a_len == n && b_len > 1 && n % b_len == 0) {
+    for (size_t i = 0; i < n; i += b_len)
+      vDSP_vadd(a + i, 1, b, 1, out + i, 1, b_len);
+    return;
+  }
+  if (b_len == n && a_len > 1 && n % a_len == 0) {
+    for (size_t i = 0; i < n; i += a_len)
+      vDSP_vadd(a, 1, b + i, 1, out + i, 1, a_len);
+    return;
+  }
+  binary_modulo_<op_add_>(a, a_len, b, b_len, out, n);
+}
+
+inline void sub(const float *a, size_t a_len, const float *b, size_t b_len,
+                float *out, size_t n) {
+  if (a_len == n && b_len == n) { vDSP_vsub(b, 1, a, 1, out, 1, n); return; }
+  if (b_len == 1) {
+    float neg_b = -b[0];
+    vDSP_vsadd(a, 1, &neg_b, out, 1, n);
+    return;
+  }
+  if (a_len == n && b_len > 1 && n % b_len == 0) {
+    for (size_t i = 0; i < n; i += b_len)
+      vDSP_vsub(b, 1, a + i, 1, out + i, 1, b_len);
+    return;
+  }
+  if (b_len == n && a_len > 1 && n % a_len == 0) {
+    for (size_t i = 0; i < n; i += a_len)
+      vDSP_vsub(b + i, 1, a, 1, out + i, 1, a_len);
+    return;
+  }
+  binary_modulo_<op_sub_>(a, a_len, b, b_len, out, n);
+}
+
+inline void mul(const float *a, size_t a_len, const float *b, size_t b_len,
+                float *out, size_t n) {
+  if (a_len == n && b_len == n) { vDSP_vmul(a, 1, b, 1, out, 1, n); return; }
+  if (b_len == 1) { vDSP_vsmul(a, 1, b, out, 1, n); return; }
+  if (a_len == 1) { vDSP_vsmul(b, 1, a, out, 1, n); return; }
+  if (a_len == n && b_len > 1 && n % b_len == 0) {
+    for (size_t i = 0; i < n; i += b_len)
+      vDSP_vmul(a + i, 1, b, 1, out + i, 1, b_len);
+    return;
+  }
+  if (b_len == n && a_len > 1 && n % a_len == 0) {
+    for (size_t i = 0; i < n; i += a_len)
+      vDSP_vmul(a, 1, b + i, 1, out + i, 1, a_len);
+    return;
+  }
+  binary_modulo_<op_mul_>(a, a_len, b, b_len, out, n);
+}
+
+inline void div(const float *a, size_t a_len, const float *b, size_t b_len,
+                float *out, size_t n) {
+  if (a_len == n && b_len == n) { vDSP_vdiv(b, 1, a, 1, out, 1, n); return; }
+  if (b_len == 1) { vDSP_vsdiv(a, 1, b, out, 1, n); return; }
+  if (a_len == 1) { vDSP_svdiv(a, b, 1, out, 1, n); return; }
+  if (a_len == n && b_len > 1 && n % b_len == 0) {
+    for (size_t i = 0; i < n; i += b_len)
+      vDSP_vdiv(b, 1, a + i, 1, out + i, 1, b_len);
+    return;
+  }
+  if (b_len == n && a_len > 1 && n % a_len == 0) {
+    for (size_t i = 0; i < n; i += a_len)
+      vDSP_vdiv(b + i, 1, a, 1, out + i, 1, a_len);
+    return;
+  }
+  binary_modulo_<op_div_>(a, a_len, b, b_len, out, n);
+}
+
+inline void affine(const float *in, float *out, size_t n, float scale,
+                   float offset) {
+  // Large inputs: the single-pass NEON FMA beats vDSP's scalar-op variants
+  if (n >= tuning().neon_affine_threshold) {
+    neon_kernels::affine(in, out, n, scale, offset);
+  } else if (scale == 1.0f && offset == 0.0f) {
+    if (in != out) std::memcpy(out, in, n * sizeof(float));
+  } else if (offset == 0.0f) {
+    vDSP_vsmul(in, 1, &scale, out, 1, n);
+  } else if (scale == 1.0f) {
+    vDSP_vsadd(in, 1, &offset, out, 1, n);
+  } else {
+    vDSP_vsmsa(in, 1, &scale, &offset, out, 1, n);
+  }
+}
+
+inline void sigmoid(const float *in, float *out, size_t n) {
+  auto len = static_cast<int>(n);
+  vDSP_vneg(in, 1, out, 1, n);
+  vvexpf(out, out, &len);
+  float one = 1.0f;
+  vDSP_vsadd(out, 1, &one, out, 1, n);
+  vvrecf(out, out, &len);
+}
+
+inline void relu(const float *in, float *out, size_t n) {
+  float zero = 0.0f;
+  vDSP_vthres(in, 1, &zero, out, 1, n);
+}
+
+// vForce for the plain transcendental cases; anything with fused scalar
+// arithmetic (or without a vForce counterpart) is a single NEON pass.
+inline void unary(unary_op op, const float *in, float *out, size_t n,
+                  const unary_args &a) {
+  auto plain = a.scale == 1.0f && a.offset == 0.0f && a.post_scale == 1.0f &&
+               a.post_offset == 0.0f;
+  auto len = static_cast<int>(n);
+  if (plain) {
+    switch (op) {
+      case unary_op::exp: vvexpf(out, in, &len); return;
+      case unary_op::log: vvlogf(out, in, &len); return;
+      case unary_op::tanh: vvtanhf(out, in, &len); return;
+      case unary_op::sqrt: vvsqrtf(out, in, &len); return;
+      case unary_op::rsqrt: vvrsqrtf(out, in, &len); return;
+      default: break;
+    }
+  }
+  neon_kernels::unary(op, in, out, n, a);
+}
+
+inline float sum(const float *in, size_t n) {
+  float result;
+  vDSP_sve(in, 1, &result, n);
+  return result;
+}
+
+inline float min(const float *in, size_t n) {
+  float result;
+  vDSP_minv(in, 1, &result, n);
+  return result;
+}
+
+inline float max(const float *in, size_t n) {
+  float result;
+  vDSP_maxv(in, 1, &result, n);
+  return result;
+}
+
+inline void softmax(const float *src, float *dst, size_t rows, size_t cols) {
+  auto len = static_cast<int>(cols);
+  for (size_t r = 0; r < rows; r++) {
+    const float *row = src + r * cols;
+    float *out = dst + r * cols;
+
+    float neg_max;
+    vDSP_maxv(row, 1, &neg_max, cols);
+    neg_max = -neg_max;
+    vDSP_vsadd(row, 1, &neg_max, out, 1, cols);
+    vvexpf(out, out, &len);
+
+    float s;
+    vDSP_sve(out, 1, &s, cols);
+    vDSP_vsdiv(out, 1, &s, out, 1, cols);
+  }
+}
+
+inline void sgemm(bool ta, bool tb, size_t M, size_t N, size_t K,
+                  const float *a, size_t lda, const float *b, size_t ldb,
+                  float *c, size_t ldc) {
+  cblas_sgemm(CblasRowMajor, ta ? CblasTrans : CblasNoTrans,
+              tb ? CblasTrans : CblasNoTrans, M, N, K, 1.0f, a, lda, b, ldb,
+              0.0f, c, ldc);
+}
+
+}  // namespace accelerate_kernels
+
+inline const cpu_kernel_table &kernel_table_for_(cpu_tier tier) {
+  static const cpu_kernel_table tables[] = {
+      {cpu_tier::scalar,
+       scalar_kernels::binary<op_add_>, scalar_kernels::binary<op_sub_>,
+       scalar_kernels::binary<op_mul_>, scalar_kernels::binary<op_div_>,
+       scalar_kernels::affine, scalar_kernels::u8_affine,
+       scalar_kernels::sigmoid, scalar_kernels::relu,
+       scalar_kernels::unary, scalar_kernels::unary_backward,
+       scalar_kernels::sum, scalar_kernels::min, scalar_kernels::max,
+       scalar_kernels::layer_norm, scalar_kernels::layer_norm_backward,
+       scalar_kernels::rms_norm, scalar_kernels::rms_norm_backward,
+       scalar_kernels::softmax, scalar_kernels::cross_entropy,
+       scalar_kernels::squared_error, scalar_kernels::scan,
+       scalar_kernels::sgemm},
+      {cpu_tier::neon,
+       neon_kernels::binary<op_add_>, neon_kernels::binary<op_sub_>,
+       neon_kernels::binary<op_mul_>, neon_kernels::binary<op_div_>,
+       neon_kernels::affine, neon_kernels::u8_affine,
+       neon_kernels::sigmoid, neon_kernels::relu,
+       neon_kernels::unary, neon_kernels::unary_backward,
+       neon_kernels::sum, neon_kernels::min, neon_kernels::max,
+       neon_kernels::layer_norm, neon_kernels::layer_norm_backward,
+       neon_kernels::rms_norm, neon_kernels::rms_norm_backward,
+       neon_kernels::softmax, neon_kernels::cross_entropy,
+       neon_kernels::squared_error, neon_kernels::scan, neon_kernels::sgemm},
+      // Norms, losses, scans and byte widening borrow the NEON kernels:
+      // composing them from vDSP calls costs several passes over each row
+      {cpu_tier::accelerate,
+       accelerate_kernels::add, accelerate_kernels::sub,
+       accelerate_kernels::mul, accelerate_kernels::div,
+       accelerate_kernels::affine, neon_kernels::u8_affine,
+       accelerate_kernels::sigmoid,
+       accelerate_kernels::relu, accelerate_kernels::unary,
+       neon_kernels::unary_backward, accelerate_kernels::sum,
+       accelerate_kernels::min, accelerate_kernels::max,
+       neon_kernels::layer_norm, neon_kernels::layer_norm_backward,
+       neon_kernels::rms_norm, neon_kernels::rms_norm_backward,
+       accelerate_kernels::softmax, neon_kernels::cross_entropy,
+       neon_kernels::squared_error, neon_kernels::scan,
+       accelerate_kernels::sgemm},
+  };
+  return tables[static_cast<size_t>(tier)];
+}
+
+inline const cpu_kernel_table *&active_kernel_table_() {
+  static const cpu_kernel_table *table =
+      &kernel_table_for_(cpu_features().tier);
+  return table;
+}
+
+}  // namespace detail
+
+// Switch the CPU kernel tier at runtime (benchmarks, A/B comparisons).
+inline void use_cpu_tier(cpu_tier tier) {
+  if (tier == cpu_tier::neon && !cpu_features().neon) tier = cpu_tier::scalar;
+  detail::cpu_features_().tier = tier;
+  detail::active_kernel_table_() = &detail::kernel_table_for_(tier);
+}
+
+};  // namespace sil
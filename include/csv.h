@@ -0,0 +1,208 @@
+#pragma once
+
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// CSV / delimited text matrices
+//-----------------------------------------------------------------------------
+
+struct csv_options {
+  char delimiter = ',';
+  size_t skip_rows = 0;  // leading lines to ignore (headers, other blocks)
+  size_t max_rows = std::numeric_limits<size_t>::max();  // after skip_rows
+};
+
+// A (rows, cols) array from a delimited text file, cols taken from the
+// first row. The file is mapped and split into per-core chunks on line
+// boundaries; each chunk counts its rows, then parses them with
+// std::from_chars straight into the output, so the text is never copied.
+// Blank lines are skipped; a row with the wrong number of fields throws.
+//
+//   auto x = load_csv("features.csv");
+//   auto w1 = load_csv("sample_weight.csv", {.skip_rows = 3, .max_rows = 784});
+template <value_type T = float>
+array<T> load_csv(const std::filesystem::path &path,
+                  const csv_options &opts = {});
+
+// One line per row (a 1D array is written as a column, like numpy.savetxt)
+// in the shortest form that reads back exactly. Row blocks are formatted
+// with std::to_chars on every core, then written with one writev.
+template <value_type T>
+void save_csv(const std::filesystem::path &path, const array<T> &a,
+              const csv_options &opts = {});
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Start of the line following the one containing p[at]
+inline size_t csv_next_line_(const char *p, size_t at, size_t size) {
+  auto *nl = static_cast<const char *>(std::memchr(p + at, '\n', size - at));
+  return nl ? nl - p + 1 : size;
+}
+
+inline bool csv_blank_(const char *b, const char *e) {
+  return std::all_of(b, e, [](char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  });
+}
+
+template <value_type T>
+inline bool csv_field_(const char *b, const char *e, T &out) {
+  while (b < e && (*b == ' ' || *b == '\t')) b++;
+  while (e > b && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r')) e--;
+  if (b < e && *b == '+') b++;
+  std::from_chars_result r;
+  if constexpr (std::same_as<T, bool>) {
+    int v = 0;
+    r = std::from_chars(b, e, v);
+    out = v != 0;
+  } else {
+    r = std::from_chars(b, e, out);
+  }
+  return r.ec == std::errc() && r.ptr == e;
+}
+
+// Parse exactly `cols` fields of the line [b, e) into out
+template <value_type T>
+inline bool csv_line_(const char *b, const char *e, char delimiter,
+                      size_t cols, T *out) {
+  for (size_t c = 0; c < cols; c++) {
+    auto *d = c + 1 < cols ? static_cast<const char *>(
+                                 std::memchr(b, delimiter, e - b))
+                           : e;
+    if (!d || !csv_field_(b, d, out[c])) return false;
+    b = d + 1;
+  }
+  return true;
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline array<T> load_csv(const std::filesystem::path &path,
+                         const csv_options &opts) {
+  using detail::csv_blank_;
+  using detail::csv_next_line_;
+  auto file = mapped_file::open(path);
+  const char *p = file->data();
+  auto size = file->size();
+
+  size_t start = 0;
+  for (size_t i = 0; i < opts.skip_rows && start < size; i++) {
+    start = csv_next_line_(p, start, size);
+  }
+
+  // Chunk c owns the lines that start in its byte range
+  auto chunks = std::clamp<size_t>((size - start) / detail::kParallelGrain, 1,
+                                   cpu_features().cores);
+  auto bound = [&](size_t c) { return start + (size - start) * c / chunks; };
+  std::vector<size_t> first(chunks), rows(chunks + 1, 0);
+  detail::parallel_for(chunks, [&](size_t c) {
+    auto at = c ? csv_next_line_(p, bound(c) - 1, size) : start;
+    first[c] = at;
+    size_t count = 0;
+    while (at < bound(c + 1)) {
+      auto next = csv_next_line_(p, at, size);
+      count += !csv_blank_(p + at, p + next);
+      at = next;
+    }
+    rows[c + 1] = count;
+  });
+  for (size_t c = 0; c < chunks; c++) rows[c + 1] += rows[c];
+  auto total = std::min(rows[chunks], opts.max_rows);
+
+  size_t cols = 0;
+  for (auto at = start; total && at < size;) {
+    auto next = csv_next_line_(p, at, size);
+    if (!csv_blank_(p + at, p + next)) {
+      cols = std::count(p + at, p + next, opts.delimiter) + 1;
+      break;
+    }
+    at = next;
+  }
+
+  auto out = array<T>({total, cols}, T{});
+  T *dst = out.buffer_data();
+  std::atomic<size_t> bad = total;  // first malformed row
+  detail::parallel_for(chunks, [&](size_t c) {
+    auto row = rows[c];
+    for (auto at = first[c]; at < bound(c + 1) && row < total;) {
+      auto next = csv_next_line_(p, at, size);
+      if (!csv_blank_(p + at, p + next)) {
+        auto end = next - (p[next - 1] == '\n');
+        if (!detail::csv_line_(p + at, p + end, opts.delimiter, cols,
+                               dst + row * cols)) {
+          auto seen = bad.load();
+          while (row < seen && !bad.compare_exchange_weak(seen, row)) {
+          }
+          return;
+        }
+        row++;
+      }
+      at = next;
+    }
+  });
+  if (bad < total) {
+    throw std::runtime_error("array: load_csv '" + path.string() + "' row " +
+                             std::to_string(bad + 1) + " doesn't have " +
+                             std::to_string(cols) + " numeric fields.");
+  }
+  return out;
+}
+
+template <value_type T>
+inline void save_csv(const std::filesystem::path &path, const array<T> &a,
+                     const csv_options &opts) {
+  if (a.dimension() > 2) {
+    throw std::runtime_error("array: save_csv requires at most 2 dimensions.");
+  }
+  auto src = a.is_contiguous() ? a : a.clone();
+  const T *p = src.buffer_data();
+  auto rows = a.dimension() == 2 ? a.shape()[0] : a.element_count();
+  auto cols = a.dimension() == 2 ? a.shape()[1] : 1;
+
+  // Longest shortest-form float ("-1.17549435e-38") or int, plus delimiter
+  constexpr size_t kField = 24;
+  auto parts = std::clamp<size_t>(rows * cols / detail::kParallelGrain, 1,
+                                  cpu_features().cores);
+  std::vector<std::string> text(parts);
+  detail::parallel_for(parts, [&](size_t k) {
+    auto begin = rows * k / parts, end = rows * (k + 1) / parts;
+    auto &s = text[k];
+    s.resize((end - begin) * (cols * kField + 1));
+    char *o = s.data();
+    for (auto r = begin; r < end; r++) {
+      for (size_t c = 0; c < cols; c++) {
+        if (c) *o++ = opts.delimiter;
+        auto v = p[r * cols + c];
+        if constexpr (std::same_as<T, bool>) {
+          *o++ = v ? '1' : '0';
+        } else {
+          o = std::to_chars(o, o + kField, v).ptr;
+        }
+      }
+      *o++ = '\n';
+    }
+    s.resize(o - s.data());
+  });
+
+  std::vector<iovec> iov;
+  for (auto &s : text) iov.push_back({s.data(), s.size()});
+  detail::write_all_(path, std::move(iov), "save_csv");
+}
+
+};  // namespace sil
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <array.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Data loader
+//-----------------------------------------------------------------------------
+
+struct loader_options {
+  size_t batch_size = 32;
+  bool shuffle = true;      // reshuffled every epoch
+  bool drop_last = false;   // skip a final batch smaller than batch_size
+  size_t in_flight = 3;     // batch slots, including the one being consumed
+  uint64_t seed = 0;
+};
+
+template <value_type X, value_type Y>
+struct minibatch {
+  array<X> x;
+  array<Y> y;
+};
+
+// Minibatches of samples (rows along the first axis) of x and y. A
+// background thread gathers the next batches straight into a ring of
+// preallocated slot arrays while the current one is being used, so
+// assembly overlaps compute and nothing is allocated per step.
+//
+//   data_loader loader(images, labels, {.batch_size = 100});
+//   for (size_t epoch = 0; epoch < epochs; epoch++) {
+//     while (auto b = loader.next()) step(b->x, b->y);
+//   }
+//
+// A batch's slot is recycled on the following next() call. Arrays still
+// referencing it then (a copy kept by the caller, a lazy result) keep the
+// old buffers and the slot gets fresh ones, so batches are never
+// overwritten under a live reference. x and y must not change while the
+// loader exists.
+template <value_type X, value_type Y>
+class data_loader {
+ public:
+  // fill(rows, count, out) writes samples rows[0, count) contiguously
+  // into out; it runs on the loader thread
+  template <value_type T>
+  using fill_fn = std::function<void(const size_t *rows, size_t count, T *out)>;
+
+  data_loader(const array<X> &x, const array<Y> &y, loader_options opts = {});
+
+  // Samples produced on the loader thread instead of copied from arrays,
+  // e.g. decoded or normalized per batch (see idx_loader). x_sample and
+  // y_sample are the shapes of one sample.
+  data_loader(size_t samples, const shape_type &x_sample, fill_fn<X> fill_x,
+              const shape_type &y_sample, fill_fn<Y> fill_y,
+              loader_options opts = {});
+  ~data_loader();
+
+  data_loader(const data_loader &) = delete;
+  data_loader &operator=(const data_loader &) = delete;
+
+  size_t size() const { return samples_; }
+  size_t batch_size() const { return opts_.batch_size; }
+  size_t batch_count() const { return batches_; }  // per epoch
+
+  // The next batch of the current epoch, or nullopt once it is exhausted;
+  // the call after that starts the next epoch. An exception thrown by a
+  // fill function on the loader thread is rethrown here, by this and
+  // every later call.
+  std::optional<minibatch<X, Y>> next();
+
+ private:
+  struct slot_ {
+    array<X> x;
+    array<Y> y;
+    X *xp = nullptr;
+    Y *yp = nullptr;
+  };
+
+  struct ready_ {
+    size_t slot, count;
+    bool last;  // final batch of its epoch
+    std::exception_ptr error;  // the fill failed; the loader thread stopped
+  };
+
+  static constexpr size_t kNone = size_t(-1);
+
+  loader_options opts_;
+  fill_fn<X> fill_x_;
+  fill_fn<Y> fill_y_;
+  size_t samples_, batches_;
+  shape_type x_shape_, y_shape_;
+
+  std::vector<slot_> slots_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<size_t> free_;
+  std::deque<ready_> ready_queue_;
+  bool stop_ = false;
+
+  size_t current_ = kNone;  // slot handed out by the last next()
+  bool epoch_done_ = false;
+  std::thread worker_;
+
+  void start_();
+  void allocate_(slot_ &s);
+  void recycle_();
+  void run_();
+};
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Row gather from a contiguous array. The pointer is taken here: the
+// loader thread never touches array state.
+template <value_type T>
+inline auto loader_rows_(const array<T> &a) {
+  auto src = a.is_contiguous() ? a : a.clone();
+  const T *p = src.buffer_data();
+  auto row = a.shape()[0] ? a.element_count() / a.shape()[0] : 0;
+  return [src, p, row](const size_t *rows, size_t count, T *out) {
+    for (size_t i = 0; i < count; i++) {
+      std::memcpy(out + i * row, p + rows[i] * row, row * sizeof(T));
+    }
+  };
+}
+
+}  // namespace detail
+
+template <value_type X, value_type Y>
+inline data_loader<X, Y>::data_loader(const array<X> &x, const array<Y> &y,
+                                      loader_options opts)
+    : opts_(opts) {
+  if (x.dimension() == 0 || y.dimension() == 0 ||
+      x.shape()[0] != y.shape()[0]) {
+    throw std::runtime_error(
+        "array: data_loader requires x and y with the same number of rows.");
+  }
+  samples_ = x.shape()[0];
+  fill_x_ = detail::loader_rows_(x);
+  fill_y_ = detail::loader_rows_(y);
+  x_shape_ = x.shape();
+  y_shape_ = y.shape();
+  start_();
+}
+
+template <value_type X, value_type Y>
+inline data_loader<X, Y>::data_loader(size_t samples,
+                                      const shape_type &x_sample,
+                                      fill_fn<X> fill_x,
+                                      const shape_type &y_sample,
+                                      fill_fn<Y> fill_y, loader_options opts)
+    : opts_(opts),
+      fill_x_(std::move(fill_x)),
+      fill_y_(std::move(fill_y)),
+      samples_(samples) {
+  x_shape_ = y_shape_ = {samples};
+  x_shape_.insert(x_shape_.end(), x_sample.begin(), x_sample.end());
+  y_shape_.insert(y_shape_.end(), y_sample.begin(), y_sample.end());
+  start_();
+}
+
+template <value_type X, value_type Y>
+inline void data_loader<X, Y>::start_() {
+  if (opts_.batch_size == 0 || opts_.in_flight == 0) {
+    throw std::runtime_error(
+        "array: data_loader requires non-zero batch_size and in_flight.");
+  }
+  batches_ = opts_.drop_last
+                 ? samples_ / opts_.batch_size
+                 : (samples_ + opts_.batch_size - 1) / opts_.batch_size;
+  x_shape_[0] = y_shape_[0] = opts_.batch_size;
+
+  slots_.resize(opts_.in_flight);
+  for (size_t s = 0; s < slots_.size(); s++) {
+    allocate_(slots_[s]);
+    free_.push_back(s);
+  }
+  if (batches_) worker_ = std::thread([this] { run_(); });
+}
+
+template <value_type X, value_type Y>
+inline data_loader<X, Y>::~data_loader() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) worker_.join();
+}
+
+template <value_type X, value_type Y>
+inline void data_loader<X, Y>::allocate_(slot_ &s) {
+  s.x = array<X>(x_shape_, X{});
+  s.y = array<Y>(y_shape_, Y{});
+  s.xp = s.x.buffer_data();
+  s.yp = s.y.buffer_data();
+}
+
+template <value_type X, value_type Y>
+inline void data_loader<X, Y>::recycle_() {
+  if (current_ == kNone) return;
+  auto &s = slots_[current_];
+  if (s.x.use_count() > 1 || s.y.use_count() > 1) {
+    allocate_(s);
+  } else if (gpu_pending_) {
+    // Queued GPU work may still read the slot
+    synchronize();
+  }
+  {
+    std::lock_guard lock(mutex_);
+    free_.push_back(current_);
+  }
+  cv_.notify_all();
+  current_ = kNone;
+}
+
+template <value_type X, value_type Y>
+inline std::optional<minibatch<X, Y>> data_loader<X, Y>::next() {
+  recycle_();
+  if (batches_ == 0) return std::nullopt;
+  if (epoch_done_) {
+    epoch_done_ = false;
+    return std::nullopt;
+  }
+
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return !ready_queue_.empty(); });
+  auto r = ready_queue_.front();
+  if (r.error) std::rethrow_exception(r.error);
+  ready_queue_.pop_front();
+  lock.unlock();
+
+  current_ = r.slot;
+  epoch_done_ = r.last;
+  auto &s = slots_[r.slot];
+  if (r.count == opts_.batch_size) return minibatch<X, Y>{s.x, s.y};
+  return minibatch<X, Y>{s.x.rows(0, r.count), s.y.rows(0, r.count)};
+}
+
+template <value_type X, value_type Y>
+inline void data_loader<X, Y>::run_() {
+  std::mt19937_64 rng(opts_.seed);
+  std::vector<size_t> order(samples_);
+  std::iota(order.begin(), order.end(), size_t(0));
+  size_t batch = batches_;
+
+  while (true) {
+    if (batch == batches_) {
+      if (opts_.shuffle) std::shuffle(order.begin(), order.end(), rng);
+      batch = 0;
+    }
+
+    size_t s;
+    X *xp;
+    Y *yp;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !free_.empty(); });
+      if (stop_) return;
+      s = free_.back();
+      free_.pop_back();
+      xp = slots_[s].xp;
+      yp = slots_[s].yp;
+    }
+
+    auto begin = batch * opts_.batch_size;
+    auto count = std::min(opts_.batch_size, samples_ - begin);
+    try {
+      fill_x_(order.data() + begin, count, xp);
+      fill_y_(order.data() + begin, count, yp);
+    } catch (...) {
+      // Left at the head of the queue, so next() keeps rethrowing it
+      {
+        std::lock_guard lock(mutex_);
+        ready_queue_.push_back({s, count, false, std::current_exception()});
+      }
+      cv_.notify_all();
+      return;
+    }
+
+    batch++;
+    {
+      std::lock_guard lock(mutex_);
+      ready_queue_.push_back({s, count, batch == batches_});
+    }
+    cv_.notify_all();
+  }
+}
+
+};  // namespace sil
@@ -2,7 +2,10 @@
 
 #include <types.h>
 #include <device.h>
+#include <tuning.h>
 
+#include <algorithm>
+#include <bit>
 #include <sstream>
 #include <stdexcept>
 
@@ -82,7 +85,7 @@ class gpu_context {
     }
 
     // Create pipeline state objects
-    const char* fn_names[] = {"add", "sub", "mul", "div", "pow", "sigmoid_", "relu_", "sum_f32_", "layer_norm_", "softmax_f32_", "affine_f32_", "sigmoid_backward_f32_", "bias_sigmoid_f32_", "sgemm_32_", "sgemm_64_"};
+    const char* fn_names[] = {"add", "sub", "mul", "div", "pow", "sigmoid_", "relu_", "sum_f32_", "layer_norm_", "softmax_f32_", "affine_f32_", "sigmoid_backward_f32_", "bias_sigmoid_f32_", "sgemm_32_", "sgemm_64_", "unary_f32_", "unary_backward_f32_"};
     for (auto name : fn_names) {
       psos_.push_back(create_pso_(device, lib, name));
     }
@@ -1122,16 +1125,19 @@ kernel void layer_norm_(
   uint vec_len = cols / 4;
   device const float4* row4 = reinterpret_cast<device const float4*>(row);
 
-  // Pass 1: compute sum and sum-of-squares in a single pass (vectorized)
+  // Pass 1: compute sum and sum-of-squares in a single pass (vectorized).
+  // Values are shifted by the row's first element so that E[x^2] - E[x]^2
+  // doesn't cancel when |mean| is much larger than the spread.
+  float shift = row[0];
   float sum_val = 0.0f;
   float sq_val = 0.0f;
   for (uint i = tid; i < vec_len; i += tg_size) {
-    float4 v = row4[i];
+    float4 v = row4[i] - float4(shift);
     sum_val += v.x + v.y + v.z + v.w;
     sq_val += dot(v, v);
   }
   for (uint i = vec_len * 4 + tid; i < cols; i += tg_size) {
-    float v = row[i];
+    float v = row[i] - shift;
     sum_val += v;
     sq_val += v * v;
   }
@@ -1140,9 +1146,10 @@ kernel void layer_norm_(
   threadgroup_barrier(mem_flags::mem_threadgroup);
   float total_sq = tg_simd_reduce_sum(shared, tid, tg_size, sq_val);
 
-  float mean = total_sum / float(cols);
-  // var = E[x^2] - E[x]^2
-  float inv_std = rsqrt(total_sq / float(cols) - mean * mean + eps);
+  float shifted_mean = total_sum / float(cols);
+  float mean = shift + shifted_mean;
+  // var = E[(x-k)^2] - E[x-k]^2
+  float inv_std = rsqrt(max(total_sq / float(cols) - shifted_mean * shifted_mean, 0.0f) + eps);
 
   // Pass 2: normalize, scale, shift
   for (uint i = tid; i < vec_len; i += tg_size) {
@@ -1255,6 +1262,66 @@ kernel void affine_f32_(
   out[gid] = fma(in[gid], scale, offset);
 }
 
+// Must match gpu::unary_params_ and the order of sil::unary_op
+struct unary_params {
+  uint op;
+  float scale, offset, post_scale, post_offset, lo, hi;
+};
+
+constant float kGeluK2 = 1.5957691216f;  // 2 * sqrt(2 / pi)
+
+inline float unary_fn_(uint op, float x, float lo, float hi) {
+  switch (op) {
+    case 0: return exp(x);
+    case 1: return log(x);
+    case 2: return tanh(x);
+    case 3: return x / (1.0f + exp(-kGeluK2 * x * (1.0f + 0.044715f * x * x)));
+    case 4: return x / (1.0f + exp(-x));
+    case 5: return sqrt(x);
+    case 6: return rsqrt(x);
+    case 7: return abs(x);
+    default: return clamp(x, lo, hi);
+  }
+}
+
+inline float unary_grad_(uint op, float x, float lo, float hi) {
+  switch (op) {
+    case 0: return exp(x);
+    case 1: return 1.0f / x;
+    case 2: { float t = tanh(x); return 1.0f - t * t; }
+    case 3: {
+      float s = 1.0f / (1.0f + exp(-kGeluK2 * x * (1.0f + 0.044715f * x * x)));
+      float du = kGeluK2 * (1.0f + 3.0f * 0.044715f * x * x);
+      return s + x * s * (1.0f - s) * du;
+    }
+    case 4: { float s = 1.0f / (1.0f + exp(-x)); return s * (1.0f + x * (1.0f - s)); }
+    case 5: return 0.5f * rsqrt(x);
+    case 6: { float r = rsqrt(x); return -0.5f * r * r * r; }
+    case 7: return sign(x);
+    default: return x >= lo && x <= hi ? 1.0f : 0.0f;
+  }
+}
+
+kernel void unary_f32_(
+  device const float*     in  [[buffer(0)]],
+  device float*           out [[buffer(1)]],
+  constant unary_params&  p   [[buffer(2)]],
+  uint gid [[thread_position_in_grid]])
+{
+  float y = unary_fn_(p.op, fma(in[gid], p.scale, p.offset), p.lo, p.hi);
+  out[gid] = fma(y, p.post_scale, p.post_offset);
+}
+
+kernel void unary_backward_f32_(
+  device const float*     dout [[buffer(0)]],
+  device const float*     x    [[buffer(1)]],
+  device float*           out  [[buffer(2)]],
+  constant unary_params&  p    [[buffer(3)]],
+  uint gid [[thread_position_in_grid]])
+{
+  out[gid] = dout[gid] * unary_grad_(p.op, x[gid], p.lo, p.hi);
+}
+
 )MSL";
   }
 };
@@ -1269,14 +1336,39 @@ class gpu {
     kAdd, kSub, kMul, kDiv, kPow,
     kSigmoid, kRelu, kSumF32, kLayerNorm, kSoftmaxF32,
     kAffineF32, kSigmoidBackwardF32, kBiasSigmoidF32, kSgemm32, kSgemm64,
+    kUnaryF32, kUnaryBackwardF32,
     kSgemmSteel, kSgemmSteelEdge,
     kSgemmBiasSteel, kSgemmBiasSteelEdge,
     kSgemmBiasSigmoidSteel, kSgemmBiasSigmoidSteelEdge,
   };
 
+  // Must match `unary_params` in the MSL source
+  struct unary_params_ {
+    uint32_t op;
+    float scale, offset, post_scale, post_offset, lo, hi;
+  };
+
+  static unary_params_ unary_params_of_(unary_op op, const unary_args& a) {
+    return {static_cast<uint32_t>(op), a.scale, a.offset, a.post_scale,
+            a.post_offset, a.lo, a.hi};
+  }
+
   static constexpr unsigned long kMPSDataTypeFloat32 = 0x10000000 | 32;
+  // Hard cap from the `shared[1024]` scratch in the reduction kernels
   static constexpr size_t kMaxReductionTGSize = 1024;
-  static constexpr size_t kMaxReductionTGs = 256;
+
+  // Threads per reduction threadgroup: the smallest of pipeline limit,
+  // shader scratch size and tuned value, rounded down to a power of two
+  static size_t reduction_tg_size_(const gpu_context::pipeline& pl) {
+    return std::bit_floor(
+        std::min({pl.max_threads, kMaxReductionTGSize,
+                  std::max<size_t>(tuning().reduction_tg_size, 32)}));
+  }
+
+  static size_t reduction_num_tg_(size_t length, size_t tg_size) {
+    return std::min((length + tg_size - 1) / tg_size,
+                    std::max<size_t>(tuning().reduction_max_tgs, 1));
+  }
 
  public:
   template <value_type T>
@@ -1315,8 +1407,8 @@ class gpu {
   // Number of partial sums produced by sum_f32.
   static size_t sum_f32_num_tg(size_t length) {
     auto& pl = gpu_context::instance().pso(kSumF32);
-    size_t tg_size = std::min(pl.max_threads, kMaxReductionTGSize);
-    return std::min((length + tg_size - 1) / tg_size, kMaxReductionTGs);
+    size_t tg_size = reduction_tg_size_(pl);
+    return reduction_num_tg_(length, tg_size);
   }
 
   // Sum reduction: dispatches threadgroups, each producing a partial sum.
@@ -1326,8 +1418,8 @@ class gpu {
     auto& pl = ctx.pso(kSumF32);
 
     auto len = static_cast<uint32_t>(length);
-    size_t tg_size = std::min(pl.max_threads, kMaxReductionTGSize);
-    size_t num_tg = std::min((length + tg_size - 1) / tg_size, kMaxReductionTGs);
+    size_t tg_size = reduction_tg_size_(pl);
+    size_t num_tg = reduction_num_tg_(length, tg_size);
 
     auto enc = ctx.compute_encoder();
 
@@ -1353,7 +1445,7 @@ class gpu {
     auto& ctx = gpu_context::instance();
     auto& pl = ctx.pso(kLayerNorm);
 
-    size_t tg_size = std::min(pl.max_threads, kMaxReductionTGSize);
+    size_t tg_size = reduction_tg_size_(pl);
 
     auto enc = ctx.compute_encoder();
 
@@ -1586,7 +1678,7 @@ class gpu {
     auto& ctx = gpu_context::instance();
     auto& pl = ctx.pso(kSoftmaxF32);
 
-    size_t tg_size = std::min(pl.max_threads, kMaxReductionTGSize);
+    size_t tg_size = reduction_tg_size_(pl);
 
     auto enc = ctx.compute_encoder();
 
@@ -1666,6 +1758,51 @@ class gpu {
     objc::send_dispatch(enc, {n, 1, 1}, {tg, 1, 1});
   }
 
+  // out[i] = f(in[i] * scale + offset) * post_scale + post_offset
+  static void unary(unary_op op, const storage& IN, storage& OUT, size_t n,
+                    const unary_args& args) {
+    auto& ctx = gpu_context::instance();
+    auto& pl = ctx.pso(kUnaryF32);
+    auto params = unary_params_of_(op, args);
+
+    auto enc = ctx.compute_encoder();
+    objc::send_set_pso(enc, pl.pso);
+    objc::send_set_buffer(enc,
+               IN.mtl_buf, IN.off * sizeof(float), size_t(0));
+    objc::send_set_buffer(enc,
+               OUT.mtl_buf, OUT.off * sizeof(float), size_t(1));
+    objc::send_set_bytes(enc,
+               &params, sizeof(params), size_t(2));
+
+    auto tw = pl.thread_width;
+    auto tg = std::min(n, pl.max_threads - (pl.max_threads % tw));
+    objc::send_dispatch(enc, {n, 1, 1}, {tg, 1, 1});
+  }
+
+  // out[i] = dout[i] * f'(x[i])
+  static void unary_backward(unary_op op, const storage& dout,
+                             const storage& x, storage& OUT, size_t n,
+                             const unary_args& args) {
+    auto& ctx = gpu_context::instance();
+    auto& pl = ctx.pso(kUnaryBackwardF32);
+    auto params = unary_params_of_(op, args);
+
+    auto enc = ctx.compute_encoder();
+    objc::send_set_pso(enc, pl.pso);
+    objc::send_set_buffer(enc,
+               dout.mtl_buf, dout.off * sizeof(float), size_t(0));
+    objc::send_set_buffer(enc,
+               x.mtl_buf, x.off * sizeof(float), size_t(1));
+    objc::send_set_buffer(enc,
+               OUT.mtl_buf, OUT.off * sizeof(float), size_t(2));
+    objc::send_set_bytes(enc,
+               &params, sizeof(params), size_t(3));
+
+    auto tw = pl.thread_width;
+    auto tg = std::min(n, pl.max_threads - (pl.max_threads % tw));
+    objc::send_dispatch(enc, {n, 1, 1}, {tg, 1, 1});
+  }
+
  private:
   // Shared dispatch for unary float4-vectorized kernels (sigmoid, relu, etc.)
   static void unary_dispatch_(size_t pso_index,
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <data_loader.h>
+#include <npy.h>
+
+#include <bit>
+#include <memory>
+#include <string>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// IDX files (MNIST and friends)
+//-----------------------------------------------------------------------------
+
+// A big-endian IDX file, mapped and read a range of records at a time.
+// Records are converted straight from the mapping into the output with
+// `x * scale + offset` fused in, so a normalized float copy of a byte
+// dataset never has to exist: u8 pixels are widened to float in SIMD
+// registers and written once. Copies share the mapping.
+//
+//   auto images = idx_file("train-images-idx3-ubyte");  // 60000 x 28 x 28
+//   auto x = images.read(0, 100, 1.0f / 255);           // (100, 784) floats
+class idx_file {
+ public:
+  explicit idx_file(const std::filesystem::path &path);
+
+  size_t size() const { return shape_[0]; }  // records
+  uint32_t magic() const { return magic_; }  // 0x00000803: u8, rank 3
+  const shape_type &shape() const { return shape_; }
+  size_t record_size() const { return record_; }  // elements per record
+
+  // Shape of one record as read() lays it out: a scalar for a rank-1 file
+  // (labels), otherwise the record flattened to a row
+  shape_type record_shape() const;
+
+  // Records [begin, end) as a (end - begin, record_size()) array, or
+  // (end - begin) for a rank-1 file. scale and offset apply to float only.
+  template <value_type T = float>
+  array<T> read(size_t begin, size_t end, float scale = 1.0f,
+                float offset = 0.0f) const;
+
+  template <value_type T>
+  void read(size_t begin, size_t end, T *out, float scale = 1.0f,
+            float offset = 0.0f) const;
+
+  // Records records[0, count) in that order, converted on the calling
+  // thread (data_loader workers)
+  template <value_type T>
+  void gather(const size_t *records, size_t count, T *out,
+              float scale = 1.0f, float offset = 0.0f) const;
+
+ private:
+  std::shared_ptr<mapped_file> file_;
+  detail::npy_dtype_ dtype_;
+  shape_type shape_;
+  uint32_t magic_ = 0;
+  size_t record_ = 1;
+  size_t data_ = 0;
+
+  const char *record_data_(size_t i) const {
+    return file_->data() + data_ + i * record_ * dtype_.size;
+  }
+  template <value_type T>
+  void check_(size_t begin, size_t end, float scale, float offset) const;
+  template <value_type T>
+  void convert_(const char *src, size_t n, T *out, float scale,
+                float offset) const;
+};
+
+// A data_loader over a pair of IDX files (samples, labels) that converts
+// and normalizes each batch on the loader thread, reading only the
+// mapped records a batch uses.
+//
+//   auto loader = idx_loader(images, labels, {.batch_size = 100}, 1.0f / 255);
+template <value_type X = float, value_type Y = int>
+data_loader<X, Y> idx_loader(const idx_file &x, const idx_file &y,
+                             loader_options opts = {}, float scale = 1.0f,
+                             float offset = 0.0f);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Element type of the third magic byte; every multi-byte type is
+// big-endian on disk
+inline npy_dtype_ idx_dtype_(uint8_t code) {
+  switch (code) {
+    case 0x08: return {'u', 1};
+    case 0x09: return {'i', 1};
+    case 0x0B: return {'i', 2, true};
+    case 0x0C: return {'i', 4, true};
+    case 0x0D: return {'f', 4, true};
+    case 0x0E: return {'f', 8, true};
+    default: return {};
+  }
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+inline idx_file::idx_file(const std::filesystem::path &path)
+    : file_(mapped_file::open(path)) {
+  auto fail = [&](const char *what) {
+    throw std::runtime_error("array: idx '" + path.string() + "' " + what);
+  };
+  const char *p = file_->data();
+  auto size = file_->size();
+  if (size < 4 || p[0] || p[1]) fail("has an invalid magic number.");
+  magic_ = std::byteswap(detail::load_le_<uint32_t>(p));
+  dtype_ = detail::idx_dtype_(static_cast<uint8_t>(p[2]));
+  auto rank = static_cast<uint8_t>(p[3]);
+  if (!dtype_.kind || !rank) fail("has an unsupported element type.");
+
+  data_ = 4 + size_t(rank) * 4;
+  if (size < data_) fail("is truncated.");
+  for (size_t d = 0; d < rank; d++) {
+    auto dim = std::byteswap(detail::load_le_<uint32_t>(p + 4 + d * 4));
+    shape_.push_back(dim);
+    if (d) record_ *= dim;
+  }
+  if (data_ + shape_[0] * record_ * dtype_.size > size) fail("is truncated.");
+}
+
+inline shape_type idx_file::record_shape() const {
+  if (shape_.size() == 1) return {};
+  return {record_};
+}
+
+template <value_type T>
+inline array<T> idx_file::read(size_t begin, size_t end, float scale,
+                               float offset) const {
+  check_<T>(begin, end, scale, offset);
+  shape_type shape = {end - begin};
+  for (auto d : record_shape()) shape.push_back(d);
+  auto out = array<T>(shape, T{});
+  read(begin, end, out.buffer_data(), scale, offset);
+  return out;
+}
+
+template <value_type T>
+inline void idx_file::read(size_t begin, size_t end, T *out, float scale,
+                           float offset) const {
+  check_<T>(begin, end, scale, offset);
+  convert_(record_data_(begin), (end - begin) * record_, out, scale, offset);
+}
+
+template <value_type T>
+inline void idx_file::gather(const size_t *records, size_t count, T *out,
+                             float scale, float offset) const {
+  check_<T>(0, 0, scale, offset);
+  for (size_t i = 0; i < count; i++) {
+    if (records[i] >= size()) {
+      throw std::runtime_error("array: idx record out of range.");
+    }
+    // One record is below the parallel grain, so this stays on this thread
+    convert_(record_data_(records[i]), record_, out + i * record_, scale,
+             offset);
+  }
+}
+
+template <value_type T>
+inline void idx_file::check_(size_t begin, size_t end, float scale,
+                             float offset) const {
+  if (begin > end || end > size()) {
+    throw std::runtime_error("array: idx record range out of bounds.");
+  }
+  if (!std::same_as<T, float> && (scale != 1.0f || offset != 0.0f)) {
+    throw std::runtime_error("array: idx scale and offset require float.");
+  }
+}
+
+template <value_type T>
+inline void idx_file::convert_(const char *src, size_t n, T *out, float scale,
+                               float offset) const {
+  if constexpr (std::same_as<T, float>) {
+    auto &k = cpu::kernels();
+    if (dtype_.kind == 'u') {
+      auto *bytes = reinterpret_cast<const uint8_t *>(src);
+      detail::parallel_chunks(n, detail::kParallelGrain, [&](size_t b, size_t e) {
+        k.u8_affine(bytes + b, out + b, e - b, scale, offset);
+      });
+      return;
+    }
+    detail::npy_convert_(src, dtype_, out, n);
+    if (scale != 1.0f || offset != 0.0f) {
+      detail::parallel_chunks(n, detail::kParallelGrain, [&](size_t b, size_t e) {
+        k.affine(out + b, out + b, e - b, scale, offset);
+      });
+    }
+  } else {
+    detail::npy_convert_(src, dtype_, out, n);
+  }
+}
+
+template <value_type X, value_type Y>
+inline data_loader<X, Y> idx_loader(const idx_file &x, const idx_file &y,
+                                    loader_options opts, float scale,
+                                    float offset) {
+  if (x.size() != y.size()) {
+    throw std::runtime_error(
+        "array: idx_loader requires x and y with the same number of records.");
+  }
+  // Checked here: the fills run on the loader thread
+  if (!std::same_as<X, float> && (scale != 1.0f || offset != 0.0f)) {
+    throw std::runtime_error("array: idx scale and offset require float.");
+  }
+  return data_loader<X, Y>(
+      x.size(), x.record_shape(),
+      [x, scale, offset](const size_t *rows, size_t count, X *out) {
+        x.gather(rows, count, out, scale, offset);
+      },
+      y.record_shape(),
+      [y](const size_t *rows, size_t count, Y *out) {
+        y.gather(rows, count, out);
+      },
+      opts);
+}
+
+};  // namespace sil
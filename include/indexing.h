@@ -0,0 +1,269 @@
+#pragma once
+
+#include <array.h>
+
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Indexing
+//-----------------------------------------------------------------------------
+
+// Indices are array<int>; anything outside [0, extent) throws.
+
+// Elements of the flattened `a` at `indices`; the result has their shape.
+template <value_type T>
+array<T> take(const array<T> &a, const array<int> &indices);
+
+// Slices of `a` along `axis` picked by 1D `indices`. With axis 0 this
+// assembles a minibatch from dataset rows, one memcpy per row.
+template <value_type T>
+array<T> index_select(const array<T> &a, size_t axis,
+                      const array<int> &indices);
+
+// out[.., i, ..] = a[.., indices[.., i, ..], ..] along `axis`. `indices` has
+// the rank of `a` and matches its shape on every other axis.
+template <value_type T>
+array<T> gather(const array<T> &a, size_t axis, const array<int> &indices);
+
+// Copy of `a` with each src element added where gather() would have read
+// it. Threads own disjoint output slices, so no atomics are needed.
+template <value_type T>
+array<T> scatter_add(const array<T> &a, size_t axis, const array<int> &indices,
+                     const array<T> &src);
+
+// Rows of `table` (vocab, dim) for each id; shape is ids.shape() + {dim}.
+template <value_type T>
+array<T> embedding(const array<T> &table, const array<int> &ids);
+
+// Gradient w.r.t. the table: rows of dout (ids..., dim) summed per id.
+array<float> embedding_backward(const array<float> &dout,
+                                const array<int> &ids, size_t vocab);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+template <value_type T>
+inline array<T> indexing_contiguous_(const array<T> &a) {
+  return a.is_contiguous() ? a : a.clone();
+}
+
+// `a` viewed as (outer, extent, inner) around `axis`
+struct axis_split_ {
+  size_t outer, extent, inner;
+};
+
+inline axis_split_ axis_split_of_(const shape_type &s, size_t axis,
+                                  const char *op) {
+  if (axis >= s.size()) {
+    throw std::runtime_error(std::string("array: ") + op +
+                             " axis is out of range.");
+  }
+  auto prod = [](auto b, auto e) {
+    return std::accumulate(b, e, size_t(1), std::multiplies<>());
+  };
+  return {prod(s.begin(), s.begin() + axis), s[axis],
+          prod(s.begin() + axis + 1, s.end())};
+}
+
+inline void check_indices_(const int *idx, size_t n, size_t extent) {
+  for (size_t i = 0; i < n; i++) {
+    if (idx[i] < 0 || static_cast<size_t>(idx[i]) >= extent) {
+      throw std::runtime_error("array: index is out of bounds.");
+    }
+  }
+}
+
+// Copy `count` slices of `inner` elements: dst slice i <- src slice idx[i]
+template <value_type T>
+inline void copy_slices_(const T *src, const int *idx, size_t count,
+                         size_t inner, T *dst) {
+  auto grain = std::max<size_t>(1, kParallelGrain / std::max<size_t>(inner, 1));
+  parallel_chunks(count, grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      std::memcpy(dst + i * inner, src + idx[i] * inner, inner * sizeof(T));
+    }
+  });
+}
+
+// dst rows [0, rows) += src row i for every i with idx[i] == row. Each chunk
+// owns a range of destination rows and scans all ids, so no two threads
+// write the same row.
+inline void index_add_rows_(float *dst, size_t rows, size_t dim,
+                            const int *idx, size_t n, const float *src) {
+  auto grain = n * dim >= kParallelGrain ? 1 : rows;
+  parallel_chunks(rows, grain, [&](size_t lo, size_t hi) {
+    for (size_t i = 0; i < n; i++) {
+      auto r = static_cast<size_t>(idx[i]);
+      if (r < lo || r >= hi) continue;
+      cpu::kernels().add(dst + r * dim, dim, src + i * dim, dim, dst + r * dim,
+                         dim);
+    }
+  });
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline array<T> take(const array<T> &a, const array<int> &indices) {
+  auto src = detail::indexing_contiguous_(a);
+  auto idx = detail::indexing_contiguous_(indices);
+  auto n = idx.element_count();
+  detail::check_indices_(idx.buffer_data(), n, src.element_count());
+
+  auto out = array<T>(idx.shape(), T{});
+  detail::copy_slices_(src.buffer_data(), idx.buffer_data(), n, 1,
+                       out.buffer_data());
+  return out;
+}
+
+template <value_type T>
+inline array<T> index_select(const array<T> &a, size_t axis,
+                             const array<int> &indices) {
+  if (indices.dimension() != 1) {
+    throw std::runtime_error("array: index_select requires 1D indices.");
+  }
+  auto sp = detail::axis_split_of_(a.shape(), axis, "index_select");
+  auto src = detail::indexing_contiguous_(a);
+  auto idx = detail::indexing_contiguous_(indices);
+  auto n = idx.element_count();
+  const int *ip = idx.buffer_data();
+  detail::check_indices_(ip, n, sp.extent);
+
+  auto shape = a.shape();
+  shape[axis] = n;
+  auto out = array<T>(shape, T{});
+  const T *sp_data = src.buffer_data();
+  T *op = out.buffer_data();
+  for (size_t o = 0; o < sp.outer; o++) {
+    detail::copy_slices_(sp_data + o * sp.extent * sp.inner, ip, n, sp.inner,
+                         op + o * n * sp.inner);
+  }
+  return out;
+}
+
+template <value_type T>
+inline array<T> gather(const array<T> &a, size_t axis,
+                       const array<int> &indices) {
+  auto sp = detail::axis_split_of_(a.shape(), axis, "gather");
+  auto is = indices.shape();
+  if (is.size() == a.dimension()) is[axis] = a.shape()[axis];
+  if (is != a.shape()) {
+    throw std::runtime_error("array: gather indices shape mismatch.");
+  }
+
+  auto src = detail::indexing_contiguous_(a);
+  auto idx = detail::indexing_contiguous_(indices);
+  auto len = indices.shape()[axis];
+  const int *ip = idx.buffer_data();
+  detail::check_indices_(ip, idx.element_count(), sp.extent);
+
+  auto out = array<T>(indices.shape(), T{});
+  const T *s = src.buffer_data();
+  T *op = out.buffer_data();
+  auto grain =
+      std::max<size_t>(1, detail::kParallelGrain / std::max<size_t>(sp.inner, 1));
+  detail::parallel_chunks(sp.outer * len, grain, [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; r++) {
+      const T *slab = s + (r / len) * sp.extent * sp.inner;
+      for (size_t j = 0; j < sp.inner; j++) {
+        op[r * sp.inner + j] = slab[ip[r * sp.inner + j] * sp.inner + j];
+      }
+    }
+  });
+  return out;
+}
+
+template <value_type T>
+inline array<T> scatter_add(const array<T> &a, size_t axis,
+                            const array<int> &indices, const array<T> &src) {
+  auto sp = detail::axis_split_of_(a.shape(), axis, "scatter_add");
+  auto is = indices.shape();
+  if (is.size() == a.dimension()) is[axis] = a.shape()[axis];
+  if (is != a.shape() || src.shape() != indices.shape()) {
+    throw std::runtime_error("array: scatter_add indices shape mismatch.");
+  }
+
+  auto idx = detail::indexing_contiguous_(indices);
+  auto values = detail::indexing_contiguous_(src);
+  auto len = indices.shape()[axis];
+  const int *ip = idx.buffer_data();
+  detail::check_indices_(ip, idx.element_count(), sp.extent);
+
+  auto out = a.clone();
+  T *op = out.buffer_data();
+  const T *vp = values.buffer_data();
+
+  // Slab o of the output is only touched by slab o of the indices; with a
+  // single slab, chunks own ranges of the scatter axis instead.
+  auto slab = [&](size_t o, size_t lo, size_t hi) {
+    T *dst = op + o * sp.extent * sp.inner;
+    for (size_t i = 0; i < len; i++) {
+      auto base = (o * len + i) * sp.inner;
+      for (size_t j = 0; j < sp.inner; j++) {
+        auto k = static_cast<size_t>(ip[base + j]);
+        if (k >= lo && k < hi) dst[k * sp.inner + j] += vp[base + j];
+      }
+    }
+  };
+
+  auto entries = idx.element_count();
+  if (sp.outer > 1) {
+    auto grain =
+        std::max<size_t>(1, detail::kParallelGrain / std::max<size_t>(len * sp.inner, 1));
+    detail::parallel_chunks(sp.outer, grain, [&](size_t begin, size_t end) {
+      for (size_t o = begin; o < end; o++) slab(o, 0, sp.extent);
+    });
+  } else {
+    auto grain = entries >= detail::kParallelGrain ? 1 : sp.extent;
+    detail::parallel_chunks(sp.extent, grain,
+                            [&](size_t lo, size_t hi) { slab(0, lo, hi); });
+  }
+  return out;
+}
+
+template <value_type T>
+inline array<T> embedding(const array<T> &table, const array<int> &ids) {
+  if (table.dimension() != 2) {
+    throw std::runtime_error("array: embedding requires a 2D table.");
+  }
+  auto dim = table.shape()[1];
+  auto src = detail::indexing_contiguous_(table);
+  auto idx = detail::indexing_contiguous_(ids);
+  auto n = idx.element_count();
+  detail::check_indices_(idx.buffer_data(), n, table.shape()[0]);
+
+  auto shape = ids.shape();
+  shape.push_back(dim);
+  auto out = array<T>(shape, T{});
+  detail::copy_slices_(src.buffer_data(), idx.buffer_data(), n, dim,
+                       out.buffer_data());
+  return out;
+}
+
+inline array<float> embedding_backward(const array<float> &dout,
+                                       const array<int> &ids, size_t vocab) {
+  auto n = ids.element_count();
+  if (dout.dimension() == 0 || dout.shape().back() * n != dout.element_count()) {
+    throw std::runtime_error("array: embedding_backward dout shape mismatch.");
+  }
+  auto dim = dout.shape().back();
+  auto grad = detail::indexing_contiguous_(dout);
+  auto idx = detail::indexing_contiguous_(ids);
+  detail::check_indices_(idx.buffer_data(), n, vocab);
+
+  auto out = array<float>({vocab, dim}, 0.0f);
+  detail::index_add_rows_(out.buffer_data(), vocab, dim, idx.buffer_data(), n,
+                          grad.buffer_data());
+  return out;
+}
+
+};  // namespace sil
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array.h>
+
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// DLPack ABI
+//-----------------------------------------------------------------------------
+
+// The structs of dlpack/dlpack.h (v0.8), declared here unless that header
+// came first. Its include guard is defined too, so including it afterwards
+// is a no-op rather than a redefinition.
+#ifndef DLPACK_DLPACK_H_
+#define DLPACK_DLPACK_H_
+#define DLPACK_VERSION 80
+#define DLPACK_ABI_VERSION 1
+
+extern "C" {
+
+typedef enum {
+  kDLCPU = 1,
+  kDLCUDA = 2,
+  kDLCUDAHost = 3,
+  kDLOpenCL = 4,
+  kDLVulkan = 7,
+  kDLMetal = 8,
+  kDLVPI = 9,
+  kDLROCM = 10,
+  kDLROCMHost = 11,
+  kDLExtDev = 12,
+  kDLCUDAManaged = 13,
+  kDLOneAPI = 14,
+  kDLWebGPU = 15,
+  kDLHexagon = 16,
+} DLDeviceType;
+
+typedef struct {
+  DLDeviceType device_type;
+  int32_t device_id;
+} DLDevice;
+
+typedef enum {
+  kDLInt = 0U,
+  kDLUInt = 1U,
+  kDLFloat = 2U,
+  kDLOpaqueHandle = 3U,
+  kDLBfloat = 4U,
+  kDLComplex = 5U,
+  kDLBool = 6U,
+} DLDataTypeCode;
+
+typedef struct {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  int64_t* strides;  // in elements; null for compact row-major
+  uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(struct DLManagedTensor* self);
+} DLManagedTensor;
+
+}  // extern "C"
+#endif  // DLPACK_DLPACK_H_
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// DLPack interop
+//-----------------------------------------------------------------------------
+
+// Zero-copy hand-off to and from other libraries in the process (NumPy,
+// PyTorch, JAX via their from_dlpack/to_dlpack). Unified memory is shared
+// as kDLCPU memory, so the Metal buffer behind an array is what the other
+// side reads and writes.
+//
+// to_dlpack evaluates `a` and flushes pending GPU work, then exports its
+// buffer, shape and strides as they are (transposed and sliced views
+// included). The tensor holds a reference to the storage until its
+// deleter runs, which must happen on a thread that may use sil.
+//
+//   auto* t = to_dlpack(w);      // consumer calls t->deleter(t) when done
+//   auto x = from_dlpack(t2);    // t2->deleter runs when x is released
+template <value_type T>
+DLManagedTensor* to_dlpack(const array<T>& a);
+
+// Takes ownership of a kDLCPU tensor whose dtype is T's own (float32,
+// int32, bool), returning a view of its memory. On error the tensor is
+// left to the caller. Negative strides, and strided 1D tensors, throw.
+template <value_type T = float>
+array<T> from_dlpack(DLManagedTensor* t);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+template <value_type T>
+inline DLDataType dlpack_dtype_() {
+  if constexpr (std::same_as<T, float>) {
+    return {kDLFloat, 32, 1};
+  } else if constexpr (std::same_as<T, int>) {
+    return {kDLInt, 32, 1};
+  } else {
+    static_assert(sizeof(bool) == 1);
+    return {kDLBool, 8, 1};
+  }
+}
+
+// What a DLManagedTensor made by to_dlpack owns: the array (and so the
+// storage's shared buffer) plus the shape and strides it points to
+template <value_type T>
+struct dlpack_ctx_ {
+  DLManagedTensor tensor;
+  array<T> source;
+  std::vector<int64_t> shape, strides;
+};
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline DLManagedTensor* to_dlpack(const array<T>& a) {
+  auto* ctx = new detail::dlpack_ctx_<T>{{}, a, {}, {}};
+  auto& src = ctx->source;
+  auto* data = src.buffer_data();  // shape and strides are final after this
+  for (size_t d = 0; d < src.dimension(); d++) {
+    ctx->shape.push_back(static_cast<int64_t>(src.shape()[d]));
+    ctx->strides.push_back(static_cast<int64_t>(src.strides()[d]));
+  }
+
+  auto& t = ctx->tensor;
+  t.dl_tensor.data = data;
+  t.dl_tensor.device = {kDLCPU, 0};
+  t.dl_tensor.ndim = static_cast<int32_t>(src.dimension());
+  t.dl_tensor.dtype = detail::dlpack_dtype_<T>();
+  t.dl_tensor.shape = ctx->shape.data();
+  t.dl_tensor.strides = ctx->strides.data();
+  t.dl_tensor.byte_offset = 0;
+  t.manager_ctx = ctx;
+  t.deleter = [](DLManagedTensor* self) {
+    delete static_cast<detail::dlpack_ctx_<T>*>(self->manager_ctx);
+  };
+  return &t;
+}
+
+template <value_type T>
+inline array<T> from_dlpack(DLManagedTensor* t) {
+  if (!t) throw std::runtime_error("array: from_dlpack got a null tensor.");
+  auto& dl = t->dl_tensor;
+  if (dl.device.device_type != kDLCPU) {
+    throw std::runtime_error("array: from_dlpack requires a kDLCPU tensor.");
+  }
+  auto want = detail::dlpack_dtype_<T>();
+  if (dl.dtype.code != want.code || dl.dtype.bits != want.bits ||
+      dl.dtype.lanes != want.lanes) {
+    throw std::runtime_error("array: from_dlpack dtype doesn't match.");
+  }
+
+  shape_type shape;
+  strides_type strides;
+  for (int32_t d = 0; d < dl.ndim; d++) {
+    shape.push_back(static_cast<size_t>(dl.shape[d]));
+    if (dl.strides) {
+      if (dl.strides[d] < 0) {
+        throw std::runtime_error(
+            "array: from_dlpack doesn't support negative strides.");
+      }
+      strides.push_back(static_cast<size_t>(dl.strides[d]));
+    }
+  }
+
+  auto* ptr = reinterpret_cast<T*>(static_cast<char*>(dl.data) + dl.byte_offset);
+  return array<T>::wrap(ptr, shape, strides, [t](T*) {
+    if (t->deleter) t->deleter(t);
+  });
+}
+
+};  // namespace sil
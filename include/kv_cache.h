@@ -0,0 +1,320 @@
+#pragma once
+
+#include <array.h>
+#include <attention.h>
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// KV cache
+//-----------------------------------------------------------------------------
+
+// Fixed-size blocks of K/V rows carved out of two preallocated arrays of
+// (block_count * block_rows, dim). Shared by any number of paged kv_caches;
+// acquire/release are thread-safe.
+class kv_block_pool {
+ public:
+  kv_block_pool(size_t block_rows, size_t block_count, size_t dim);
+
+  size_t block_rows() const { return block_rows_; }
+  size_t block_count() const { return block_count_; }
+  size_t dim() const { return dim_; }
+  size_t free_blocks() const;
+
+  size_t acquire();  // throws when the pool is exhausted
+  void release(size_t block);
+
+  float *key_rows(size_t block) { return k_data_ + block * block_rows_ * dim_; }
+  float *value_rows(size_t block) {
+    return v_data_ + block * block_rows_ * dim_;
+  }
+
+  // Zero-copy (rows, dim) views of the first `rows` rows of a block
+  array<float> keys(size_t block, size_t rows) const;
+  array<float> values(size_t block, size_t rows) const;
+
+ private:
+  size_t block_rows_, block_count_, dim_;
+  array<float> k_, v_;
+  float *k_data_, *v_data_;
+  mutable std::mutex mutex_;
+  std::vector<size_t> free_;
+};
+
+// Keys and values of one sequence for autoregressive decoding.
+//
+//   kv_cache cache(max_seq, d_model);            // one contiguous block
+//   kv_cache cache(pool, max_seq);               // paged, blocks on demand
+//   cache.append(k, v);                          // (n, dim) each, O(n)
+//   auto ctx = cache.attention(q);               // q = the last n positions
+//
+// Nothing is allocated after construction (paged caches take blocks from
+// the pool as they grow), so per-token cost doesn't depend on allocation.
+// A moved-from cache is empty with capacity 0 and keeps its dim();
+// append() and attention() on it throw.
+class kv_cache {
+ public:
+  kv_cache(size_t max_seq, size_t dim);
+  kv_cache(std::shared_ptr<kv_block_pool> pool, size_t max_seq);
+  ~kv_cache();
+
+  kv_cache(const kv_cache &) = delete;
+  kv_cache &operator=(const kv_cache &) = delete;
+  kv_cache(kv_cache &&rhs) noexcept;
+  kv_cache &operator=(kv_cache &&rhs) noexcept;
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return max_seq_; }
+  size_t dim() const { return dim_; }
+  size_t block_count() const { return blocks_.size(); }
+
+  void append(const array<float> &k, const array<float> &v);
+  void clear();  // keeps a contiguous cache's block, returns paged blocks
+
+  // (size(), dim) prefix. Zero-copy while the sequence fits in one block;
+  // paged sequences spanning several blocks are gathered into a new array
+  // (and a paged cache holding no blocks yet returns an empty array).
+  array<float> keys() const;
+  array<float> values() const;
+
+  // Causal scaled-dot-product attention of q (n, dim) — the queries for the
+  // last n appended positions — against the cache, reading K/V in place.
+  array<float> attention(const array<float> &q, float scale = 0.0f) const;
+
+ private:
+  std::shared_ptr<kv_block_pool> pool_;
+  std::vector<size_t> blocks_;
+  size_t max_seq_ = 0;
+  size_t dim_ = 0;
+  size_t size_ = 0;
+  bool paged_ = false;
+
+  array<float> gather_(bool values) const;
+  void check_pool_(const char *what) const;
+  void release_blocks_();
+};
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+inline kv_block_pool::kv_block_pool(size_t block_rows, size_t block_count,
+                                    size_t dim)
+    : block_rows_(block_rows),
+      block_count_(block_count),
+      dim_(dim),
+      k_({block_rows * block_count, dim}, 0.0f),
+      v_({block_rows * block_count, dim}, 0.0f) {
+  if (block_rows == 0 || block_count == 0 || dim == 0) {
+    throw std::runtime_error("array: kv_block_pool requires non-zero sizes.");
+  }
+  k_data_ = k_.buffer_data();
+  v_data_ = v_.buffer_data();
+
+  // Hand out low block indices first
+  free_.reserve(block_count);
+  for (size_t b = block_count; b > 0; b--) free_.push_back(b - 1);
+}
+
+inline size_t kv_block_pool::free_blocks() const {
+  std::lock_guard lock(mutex_);
+  return free_.size();
+}
+
+inline size_t kv_block_pool::acquire() {
+  std::lock_guard lock(mutex_);
+  if (free_.empty()) {
+    throw std::runtime_error("array: kv_block_pool is exhausted.");
+  }
+  auto b = free_.back();
+  free_.pop_back();
+  return b;
+}
+
+inline void kv_block_pool::release(size_t block) {
+  std::lock_guard lock(mutex_);
+  free_.push_back(block);
+}
+
+inline array<float> kv_block_pool::keys(size_t block, size_t rows) const {
+  return k_.rows(block * block_rows_, block * block_rows_ + rows);
+}
+
+inline array<float> kv_block_pool::values(size_t block, size_t rows) const {
+  return v_.rows(block * block_rows_, block * block_rows_ + rows);
+}
+
+//-----------------------------------------------------------------------------
+
+inline kv_cache::kv_cache(size_t max_seq, size_t dim)
+    : pool_(std::make_shared<kv_block_pool>(max_seq, 1, dim)),
+      max_seq_(max_seq),
+      dim_(dim) {
+  blocks_.push_back(pool_->acquire());
+}
+
+inline kv_cache::kv_cache(std::shared_ptr<kv_block_pool> pool, size_t max_seq)
+    : pool_(std::move(pool)), max_seq_(max_seq), paged_(true) {
+  if (!pool_) throw std::runtime_error("array: kv_cache requires a pool.");
+  dim_ = pool_->dim();
+  blocks_.reserve((max_seq + pool_->block_rows() - 1) / pool_->block_rows());
+}
+
+inline kv_cache::~kv_cache() { release_blocks_(); }
+
+inline kv_cache::kv_cache(kv_cache &&rhs) noexcept
+    : pool_(std::move(rhs.pool_)),
+      blocks_(std::move(rhs.blocks_)),
+      max_seq_(rhs.max_seq_),
+      dim_(rhs.dim_),
+      size_(rhs.size_),
+      paged_(rhs.paged_) {
+  rhs.blocks_.clear();
+  rhs.max_seq_ = 0;
+  rhs.size_ = 0;
+}
+
+inline kv_cache &kv_cache::operator=(kv_cache &&rhs) noexcept {
+  if (this != &rhs) {
+    release_blocks_();
+    pool_ = std::move(rhs.pool_);
+    blocks_ = std::move(rhs.blocks_);
+    max_seq_ = rhs.max_seq_;
+    dim_ = rhs.dim_;
+    size_ = rhs.size_;
+    paged_ = rhs.paged_;
+    rhs.blocks_.clear();
+    rhs.max_seq_ = 0;
+    rhs.size_ = 0;
+  }
+  return *this;
+}
+
+inline void kv_cache::release_blocks_() {
+  if (!pool_) return;
+  for (auto b : blocks_) pool_->release(b);
+  blocks_.clear();
+}
+
+inline void kv_cache::check_pool_(const char *what) const {
+  if (!pool_) {
+    throw std::runtime_error(std::string("array: kv_cache ") + what +
+                             " on a moved-from cache.");
+  }
+}
+
+inline void kv_cache::clear() {
+  if (paged_) release_blocks_();
+  size_ = 0;
+}
+
+inline void kv_cache::append(const array<float> &k, const array<float> &v) {
+  check_pool_("append");
+  auto d = dim();
+  if (k.dimension() != 2 || k.shape() != v.shape() || k.shape()[1] != d) {
+    throw std::runtime_error("array: kv_cache append requires (n, dim) K/V.");
+  }
+  auto n = k.shape()[0];
+  if (size_ + n > max_seq_) {
+    throw std::runtime_error("array: kv_cache capacity exceeded.");
+  }
+
+  auto kc = detail::attention_contiguous_(k);
+  auto vc = detail::attention_contiguous_(v);
+  const float *ks = kc.buffer_data();
+  const float *vs = vc.buffer_data();
+
+  // Take every block the rows need before copying, handing them back if
+  // the pool runs out, so a failed append leaves the cache as it was
+  auto rows = pool_->block_rows();
+  auto held = blocks_.size();
+  try {
+    while (blocks_.size() * rows < size_ + n) {
+      blocks_.push_back(pool_->acquire());
+    }
+  } catch (...) {
+    for (auto i = held; i < blocks_.size(); i++) pool_->release(blocks_[i]);
+    blocks_.resize(held);
+    throw;
+  }
+
+  for (size_t done = 0; done < n;) {
+    auto pos = size_ + done;
+    auto block = blocks_[pos / rows];
+    auto r = pos % rows;
+    auto count = std::min(rows - r, n - done);
+    std::memcpy(pool_->key_rows(block) + r * d, ks + done * d,
+                count * d * sizeof(float));
+    std::memcpy(pool_->value_rows(block) + r * d, vs + done * d,
+                count * d * sizeof(float));
+    done += count;
+  }
+  size_ += n;
+}
+
+inline array<float> kv_cache::gather_(bool values) const {
+  if (blocks_.empty()) return array<float>();
+  if (blocks_.size() == 1) {
+    return values ? pool_->values(blocks_[0], size_)
+                  : pool_->keys(blocks_[0], size_);
+  }
+
+  auto d = dim(), rows = pool_->block_rows();
+  auto out = array<float>({size_, d}, 0.0f);
+  float *dst = out.buffer_data();
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    auto count = std::min(rows, size_ - i * rows);
+    auto *src = values ? pool_->value_rows(blocks_[i])
+                       : pool_->key_rows(blocks_[i]);
+    std::memcpy(dst + i * rows * d, src, count * d * sizeof(float));
+  }
+  return out;
+}
+
+inline array<float> kv_cache::keys() const { return gather_(false); }
+
+inline array<float> kv_cache::values() const { return gather_(true); }
+
+inline array<float> kv_cache::attention(const array<float> &q,
+                                        float scale) const {
+  check_pool_("attention");
+  auto d = dim();
+  if (q.dimension() != 2 || q.shape()[1] != d || q.shape()[0] > size_ ||
+      q.shape()[0] == 0) {
+    throw std::runtime_error("array: kv_cache attention shape mismatch.");
+  }
+  if (scale == 0.0f) scale = 1.0f / std::sqrt(static_cast<float>(d));
+
+  auto n = q.shape()[0];
+  auto qc = detail::attention_contiguous_(q);
+  const float *qp = qc.buffer_data();
+  auto out = array<float>({n, d}, 0.0f);
+  float *op = out.buffer_data();
+
+  auto s = detail::attention_shape_{1, n, size_, d, d};
+  auto rows = pool_->block_rows();
+  auto kv_at = [&](size_t k0) {
+    auto block = blocks_[k0 / rows];
+    auto r = k0 % rows;
+    return detail::attention_kv_run_{pool_->key_rows(block) + r * d,
+                                     pool_->value_rows(block) + r * d,
+                                     rows - r};
+  };
+
+  auto q_blocks = (n + detail::kAttentionBlockQ - 1) / detail::kAttentionBlockQ;
+  detail::parallel_for(q_blocks, [&](size_t task) {
+    auto q0 = task * detail::kAttentionBlockQ;
+    auto bq = std::min(detail::kAttentionBlockQ, n - q0);
+    detail::attention_query_block_(qp, nullptr, true, s, scale, q0, bq, kv_at,
+                                   op + q0 * d);
+  });
+  return out;
+}
+
+};  // namespace sil
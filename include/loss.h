@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array.h>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Losses (CPU)
+//-----------------------------------------------------------------------------
+
+// Loss value plus, when requested, its gradient w.r.t. the prediction
+// (empty otherwise).
+struct loss_grad {
+  float loss = 0.0f;
+  array<float> grad;
+};
+
+// Mean over rows of -log softmax(logits)[label] for logits (N, classes) and
+// int labels (N). The gradient (softmax - one_hot) / N comes out of the same
+// row-parallel pass; no one-hot matrix is built.
+loss_grad cross_entropy(const array<float> &logits, const array<int> &labels,
+                        bool with_grad = true);
+
+// mean((pred - target)^2) as a single reduction; the gradient is
+// 2 (pred - target) / n.
+loss_grad mean_square_error(const array<float> &pred,
+                            const array<float> &target,
+                            bool with_grad = false);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+inline loss_grad cross_entropy(const array<float> &logits,
+                               const array<int> &labels, bool with_grad) {
+  if (logits.dimension() != 2) {
+    throw std::runtime_error("array: cross_entropy requires 2D logits.");
+  }
+  auto rows = logits.shape()[0], cols = logits.shape()[1];
+  if (labels.dimension() != 1 || labels.element_count() != rows) {
+    throw std::runtime_error("array: cross_entropy labels shape mismatch.");
+  }
+  if (rows == 0 || cols == 0) {
+    throw std::runtime_error("array: cross_entropy requires non-empty logits.");
+  }
+
+  auto x = logits.is_contiguous() ? logits : logits.clone();
+  auto ids = labels.is_contiguous() ? labels : labels.clone();
+  const int *ip = ids.buffer_data();
+  for (size_t i = 0; i < rows; i++) {
+    if (ip[i] < 0 || static_cast<size_t>(ip[i]) >= cols) {
+      throw std::runtime_error("array: cross_entropy label is out of range.");
+    }
+  }
+
+  auto result = loss_grad{};
+  float *dp = nullptr;
+  if (with_grad) {
+    result.grad = array<float>(logits.shape(), 0.0f);
+    dp = result.grad.buffer_data();
+  }
+  auto scale = 1.0f / static_cast<float>(rows);
+  auto total = cpu::cross_entropy(x.buffer_data(), ip, dp, rows, cols, scale);
+  result.loss = static_cast<float>(total / rows);
+  return result;
+}
+
+inline loss_grad mean_square_error(const array<float> &pred,
+                                   const array<float> &target,
+                                   bool with_grad) {
+  if (pred.shape() != target.shape()) {
+    throw std::runtime_error("array: mean_square_error shape mismatch.");
+  }
+  if (pred.element_count() == 0) {
+    throw std::runtime_error(
+        "array: mean_square_error requires non-empty arrays.");
+  }
+  auto a = pred.is_contiguous() ? pred : pred.clone();
+  auto b = target.is_contiguous() ? target : target.clone();
+  auto n = pred.element_count();
+
+  auto result = loss_grad{};
+  float *gp = nullptr;
+  if (with_grad) {
+    result.grad = array<float>(pred.shape(), 0.0f);
+    gp = result.grad.buffer_data();
+  }
+  auto scale = 2.0f / static_cast<float>(n);
+  auto total = cpu::squared_error(a.buffer_data(), b.buffer_data(), gp, n,
+                                  scale);
+  result.loss = static_cast<float>(total / n);
+  return result;
+}
+
+};  // namespace sil
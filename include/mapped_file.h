@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Memory-mapped files
+//-----------------------------------------------------------------------------
+
+// A whole file mapped copy-on-write: pages fault in from the page cache on
+// first touch, and writes through an array viewing the mapping stay
+// private. Arrays made by view() share ownership, so the mapping lives as
+// long as any of them.
+class mapped_file : public std::enable_shared_from_this<mapped_file> {
+ public:
+  static std::shared_ptr<mapped_file> open(const std::filesystem::path& path);
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  const char* data() const { return static_cast<const char*>(addr_); }
+  size_t size() const { return size_; }
+
+  // Zero-copy view of the elements at byte `offset`, which must be aligned
+  // for T (strides as for array::wrap)
+  template <value_type T>
+  array<T> view(size_t offset, const shape_type& shape,
+                const strides_type& strides = {});
+
+ private:
+  mapped_file() = default;
+  void* addr_ = nullptr;
+  size_t size_ = 0;
+};
+
+namespace detail {
+
+// Little-endian fields of file formats (the byte order of every host this
+// library targets)
+template <typename U>
+inline U load_le_(const char* p) {
+  U v;
+  std::memcpy(&v, p, sizeof(U));
+  return v;
+}
+
+template <typename U>
+inline void store_le_(std::string& out, U v) {
+  out.append(reinterpret_cast<const char*>(&v), sizeof(U));
+}
+
+// Write every buffer with as few writev calls as IOV_MAX and short writes
+// allow (one, for typical files)
+inline void write_all_(const std::filesystem::path& path,
+                       std::vector<iovec> iov, const char* op) {
+  auto fail = [&](const char* what) {
+    throw std::runtime_error(std::string("array: ") + op + " " + what + " '" +
+                             path.string() + "'.");
+  };
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) fail("cannot open");
+
+  size_t i = 0;
+  while (i < iov.size()) {
+    auto count = static_cast<int>(std::min<size_t>(iov.size() - i, IOV_MAX));
+    auto n = ::writev(fd, iov.data() + i, count);
+    if (n < 0) {
+      ::close(fd);
+      fail("cannot write");
+    }
+    // Skip what was written, trimming a partially written buffer
+    auto done = static_cast<size_t>(n);
+    while (i < iov.size() && done >= iov[i].iov_len) done -= iov[i++].iov_len;
+    if (done) {
+      iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + done;
+      iov[i].iov_len -= done;
+    }
+  }
+  if (::close(fd) != 0) fail("cannot write");
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+inline std::shared_ptr<mapped_file> mapped_file::open(
+    const std::filesystem::path& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("array: cannot open '" + path.string() + "'.");
+  }
+  struct stat sb;
+  if (fstat(fd, &sb) != 0) {
+    ::close(fd);
+    throw std::runtime_error("array: cannot stat '" + path.string() + "'.");
+  }
+
+  auto file = std::shared_ptr<mapped_file>(new mapped_file());
+  file->size_ = static_cast<size_t>(sb.st_size);
+  if (file->size_) {
+    auto* addr = ::mmap(nullptr, file->size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("array: cannot map '" + path.string() + "'.");
+    }
+    file->addr_ = addr;
+  }
+  ::close(fd);  // the mapping keeps the file open
+  return file;
+}
+
+inline mapped_file::~mapped_file() {
+  if (addr_) ::munmap(addr_, size_);
+}
+
+template <value_type T>
+inline array<T> mapped_file::view(size_t offset, const shape_type& shape,
+                                  const strides_type& strides) {
+  auto* p = static_cast<char*>(addr_) + offset;
+  return array<T>::wrap(reinterpret_cast<T*>(p), shape, strides,
+                        [self = shared_from_this()](T*) {});
+}
+
+};  // namespace sil
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <array.h>
+
+#include <string>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Normalization layers (CPU)
+//-----------------------------------------------------------------------------
+
+// All norms work over the last axis; every other axis is flattened into
+// rows, which are split across cores. The forward pass reads each row once
+// for its statistics (Welford for layer_norm) and once more from cache to
+// write the output.
+
+// Per-row statistics saved by the forward pass, each of shape (rows).
+// rms_norm leaves `mean` empty.
+struct norm_stats {
+  array<float> mean;
+  array<float> rstd;
+};
+
+struct layer_norm_grads {
+  array<float> dx;
+  array<float> dgamma;
+  array<float> dbeta;
+};
+
+struct rms_norm_grads {
+  array<float> dx;
+  array<float> dgamma;
+};
+
+// (x - mean) * rstd * gamma + beta, with rstd = 1 / sqrt(var + eps)
+array<float> layer_norm(const array<float> &x, const array<float> &gamma,
+                        const array<float> &beta, norm_stats &stats,
+                        float eps = 1e-5f);
+
+// dx, dgamma and dbeta in one sweep over (dout, x), reusing the saved
+// statistics; dgamma/dbeta are summed per chunk of rows, then combined.
+layer_norm_grads layer_norm_backward(const array<float> &dout,
+                                     const array<float> &x,
+                                     const array<float> &gamma,
+                                     const norm_stats &stats);
+
+// x * rstd * gamma, with rstd = 1 / sqrt(mean(x^2) + eps)
+array<float> rms_norm(const array<float> &x, const array<float> &gamma,
+                      float eps = 1e-5f);
+array<float> rms_norm(const array<float> &x, const array<float> &gamma,
+                      norm_stats &stats, float eps = 1e-5f);
+
+rms_norm_grads rms_norm_backward(const array<float> &dout,
+                                 const array<float> &x,
+                                 const array<float> &gamma,
+                                 const norm_stats &stats);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+struct norm_rows_ {
+  size_t rows, cols;
+};
+
+inline norm_rows_ norm_rows_of_(const array<float> &x,
+                                const array<float> &gamma, const char *op) {
+  if (x.dimension() == 0 || x.shape().back() == 0) {
+    throw std::runtime_error(std::string("array: ") + op +
+                             " requires a non-empty last axis.");
+  }
+  auto cols = x.shape().back();
+  if (gamma.element_count() != cols) {
+    throw std::runtime_error(std::string("array: ") + op +
+                             " gamma must match the last axis.");
+  }
+  return {x.element_count() / cols, cols};
+}
+
+inline void check_norm_backward_(const array<float> &dout,
+                                 const array<float> &x, const array<float> &rstd,
+                                 size_t rows, const char *op) {
+  if (dout.shape() != x.shape() || rstd.element_count() != rows) {
+    throw std::runtime_error(std::string("array: ") + op + " shape mismatch.");
+  }
+}
+
+inline array<float> norm_contiguous_(const array<float> &a) {
+  return a.is_contiguous() ? a : a.clone();
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+inline array<float> layer_norm(const array<float> &x, const array<float> &gamma,
+                               const array<float> &beta, norm_stats &stats,
+                               float eps) {
+  auto [rows, cols] = detail::norm_rows_of_(x, gamma, "layer_norm");
+  if (beta.element_count() != cols) {
+    throw std::runtime_error("array: layer_norm beta must match the last axis.");
+  }
+
+  auto src = detail::norm_contiguous_(x);
+  auto g = detail::norm_contiguous_(gamma);
+  auto b = detail::norm_contiguous_(beta);
+  auto out = array<float>(x.shape(), 0.0f);
+  stats = {array<float>({rows}, 0.0f), array<float>({rows}, 0.0f)};
+  cpu::layer_norm(src.buffer_data(), out.buffer_data(), g.buffer_data(),
+                  b.buffer_data(), rows, cols, eps, stats.mean.buffer_data(),
+                  stats.rstd.buffer_data());
+  return out;
+}
+
+inline layer_norm_grads layer_norm_backward(const array<float> &dout,
+                                            const array<float> &x,
+                                            const array<float> &gamma,
+                                            const norm_stats &stats) {
+  auto [rows, cols] = detail::norm_rows_of_(x, gamma, "layer_norm_backward");
+  detail::check_norm_backward_(dout, x, stats.rstd, rows,
+                               "layer_norm_backward");
+  if (stats.mean.element_count() != rows) {
+    throw std::runtime_error("array: layer_norm_backward shape mismatch.");
+  }
+
+  auto dy = detail::norm_contiguous_(dout);
+  auto src = detail::norm_contiguous_(x);
+  auto g = detail::norm_contiguous_(gamma);
+  auto mean = detail::norm_contiguous_(stats.mean);
+  auto rstd = detail::norm_contiguous_(stats.rstd);
+  auto grads = layer_norm_grads{array<float>(x.shape(), 0.0f),
+                                array<float>({cols}, 0.0f),
+                                array<float>({cols}, 0.0f)};
+  cpu::layer_norm_backward(dy.buffer_data(), src.buffer_data(),
+                           mean.buffer_data(), rstd.buffer_data(),
+                           g.buffer_data(), grads.dx.buffer_data(),
+                           grads.dgamma.buffer_data(),
+                           grads.dbeta.buffer_data(), rows, cols);
+  return grads;
+}
+
+inline array<float> rms_norm(const array<float> &x, const array<float> &gamma,
+                             float eps) {
+  auto [rows, cols] = detail::norm_rows_of_(x, gamma, "rms_norm");
+  auto src = detail::norm_contiguous_(x);
+  auto g = detail::norm_contiguous_(gamma);
+  auto out = array<float>(x.shape(), 0.0f);
+  cpu::rms_norm(src.buffer_data(), out.buffer_data(), g.buffer_data(), rows,
+                cols, eps);
+  return out;
+}
+
+inline array<float> rms_norm(const array<float> &x, const array<float> &gamma,
+                             norm_stats &stats, float eps) {
+  auto [rows, cols] = detail::norm_rows_of_(x, gamma, "rms_norm");
+  auto src = detail::norm_contiguous_(x);
+  auto g = detail::norm_contiguous_(gamma);
+  auto out = array<float>(x.shape(), 0.0f);
+  stats = {array<float>(), array<float>({rows}, 0.0f)};
+  cpu::rms_norm(src.buffer_data(), out.buffer_data(), g.buffer_data(), rows,
+                cols, eps, stats.rstd.buffer_data());
+  return out;
+}
+
+inline rms_norm_grads rms_norm_backward(const array<float> &dout,
+                                        const array<float> &x,
+                                        const array<float> &gamma,
+                                        const norm_stats &stats) {
+  auto [rows, cols] = detail::norm_rows_of_(x, gamma, "rms_norm_backward");
+  detail::check_norm_backward_(dout, x, stats.rstd, rows, "rms_norm_backward");
+
+  auto dy = detail::norm_contiguous_(dout);
+  auto src = detail::norm_contiguous_(x);
+  auto g = detail::norm_contiguous_(gamma);
+  auto rstd = detail::norm_contiguous_(stats.rstd);
+  auto grads = rms_norm_grads{array<float>(x.shape(), 0.0f),
+                              array<float>({cols}, 0.0f)};
+  cpu::rms_norm_backward(dy.buffer_data(), src.buffer_data(),
+                         rstd.buffer_data(), g.buffer_data(),
+                         grads.dx.buffer_data(), grads.dgamma.buffer_data(),
+                         rows, cols);
+  return grads;
+}
+
+};  // namespace sil
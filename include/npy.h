@@ -0,0 +1,611 @@
+#pragma once
+
+#include <mapped_file.h>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// NumPy .npy and .npz files
+//-----------------------------------------------------------------------------
+
+// load_npy maps the file and, when the stored dtype is T's own ('<f4',
+// '<i4', '|b1') and the payload is aligned (numpy pads headers to 64
+// bytes), returns a view over the page cache: loading costs page faults,
+// not parsing. The mapping is copy-on-write, so the array can be updated
+// without touching the file. Other numeric dtypes, big-endian data and
+// misaligned payloads are converted in one pass over the mapping.
+// Fortran-ordered files load as column-major strided arrays.
+//
+// Conversions narrow: '<f8' rounds to float precision and floats truncate
+// to int, but a value outside the target's range, or an integer ('<i8',
+// '<u4', ...) that int can't hold exactly, throws rather than wrap.
+//
+//   auto w = load_npy<float>("w.npy");
+//   save_npy("w.npy", w);                  // header and data in one writev
+
+template <value_type T>
+array<T> load_npy(const std::filesystem::path& path);
+
+template <value_type T>
+void save_npy(const std::filesystem::path& path, const array<T>& a);
+
+using npy_value = std::variant<array<float>, array<int>, array<bool>>;
+
+// Archives of named arrays as written by np.savez (stored entries;
+// np.savez_compressed archives are rejected). Each entry loads like
+// load_npy as float, int or bool by its dtype kind. save_npz pads every
+// header so the payloads land 64-byte aligned in the archive and load back
+// zero-copy. Entries wider than float or int narrow as in load_npy.
+//
+//   auto m = load_npz("model.npz");
+//   auto& w1 = std::get<array<float>>(m["W1"]);
+//   save_npz("model.npz", {{"W1", w1}, {"b1", b1}});
+
+std::map<std::string, npy_value> load_npz(const std::filesystem::path& path);
+
+void save_npz(const std::filesystem::path& path,
+              const std::vector<std::pair<std::string, npy_value>>& arrays);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Payload alignment save_npy/save_npz pad to, as numpy does
+constexpr size_t kNpyAlign = 64;
+
+struct npy_dtype_ {
+  char kind = 0;  // 'f', 'i', 'u' or 'b'
+  size_t size = 0;
+  bool swap = false;  // big-endian on disk
+};
+
+struct npy_header_ {
+  npy_dtype_ dtype;
+  bool fortran = false;
+  shape_type shape;
+  size_t data = 0;  // payload offset from the start of the .npy
+};
+
+template <value_type T>
+inline npy_dtype_ npy_dtype_of_() {
+  if constexpr (std::same_as<T, float>) {
+    return {'f', 4};
+  } else if constexpr (std::same_as<T, int>) {
+    return {'i', 4};
+  } else {
+    return {'b', 1};
+  }
+}
+
+// Parse the magic, version and header dict of a .npy starting at p.
+// `what` names the file in errors.
+inline npy_header_ npy_parse_(const char* p, size_t size,
+                              const std::string& what) {
+  auto fail = [&](const std::string& why) {
+    throw std::runtime_error("array: " + what + " " + why);
+  };
+  if (size < 10 || std::memcmp(p, "\x93NUMPY", 6) != 0) {
+    fail("is not an .npy file.");
+  }
+  size_t len = 0, start = 0;
+  switch (p[6]) {
+    case 1:
+      len = load_le_<uint16_t>(p + 8);
+      start = 10;
+      break;
+    case 2:
+    case 3:
+      if (size < 12) fail("is truncated.");
+      len = load_le_<uint32_t>(p + 8);
+      start = 12;
+      break;
+    default:
+      fail("has an unsupported .npy version.");
+  }
+  if (start + len > size) fail("is truncated.");
+  auto dict = std::string_view(p + start, len);
+
+  // Text following "'key':" in the dict
+  auto value_of = [&](std::string_view key) {
+    auto at = dict.find(key);
+    if (at == dict.npos) fail("has no '" + std::string(key) + "' entry.");
+    at = dict.find(':', at + key.size());
+    if (at == dict.npos) fail("has a malformed header.");
+    at = dict.find_first_not_of(' ', at + 1);
+    return at == dict.npos ? std::string_view() : dict.substr(at);
+  };
+
+  npy_header_ h;
+  auto descr = value_of("'descr'");
+  auto end = descr.find(descr.empty() ? '\'' : descr[0], 1);
+  if (descr.empty() || end == descr.npos) fail("has a malformed header.");
+  descr = descr.substr(1, end - 1);
+  auto type = std::string(descr);
+  if (!descr.empty() && std::string_view("<>|=").contains(descr[0])) {
+    h.dtype.swap = descr[0] == '>';
+    descr.remove_prefix(1);
+  }
+  if (descr.size() == 2 && descr[1] >= '1' && descr[1] <= '8') {
+    h.dtype.kind = descr[0];
+    h.dtype.size = descr[1] - '0';
+  }
+  auto ok = false;
+  switch (h.dtype.kind) {
+    case 'f': ok = h.dtype.size == 4 || h.dtype.size == 8; break;
+    case 'i':
+    case 'u': ok = std::has_single_bit(h.dtype.size); break;
+    case 'b': ok = h.dtype.size == 1; break;
+  }
+  if (!ok) fail("has an unsupported dtype '" + type + "'.");
+  h.dtype.swap = h.dtype.swap && h.dtype.size > 1;
+
+  h.fortran = value_of("'fortran_order'").starts_with("True");
+
+  auto shape = value_of("'shape'");
+  if (!shape.starts_with('(')) fail("has a malformed header.");
+  size_t dim = 0;
+  auto digits = false;
+  for (size_t i = 1; i < shape.size() && shape[i - 1] != ')'; i++) {
+    auto c = shape[i];
+    if (c >= '0' && c <= '9') {
+      dim = dim * 10 + (c - '0');
+      digits = true;
+    } else if ((c == ',' || c == ')') && digits) {
+      h.shape.push_back(dim);
+      dim = 0;
+      digits = false;
+    }
+  }
+
+  h.data = start + len;
+  size_t count = 1;
+  for (auto d : h.shape) count *= d;
+  if (h.data + count * h.dtype.size > size) fail("is truncated.");
+  return h;
+}
+
+// Whether a stored value converts to T without leaving its range;
+// integers converted to int must also be exact
+template <value_type T, typename U>
+inline bool npy_fits_(U v) {
+  if constexpr (std::same_as<T, int> && std::integral<U>) {
+    return std::in_range<int>(v);
+  } else if constexpr (std::same_as<T, int>) {
+    return v > -2147483649.0 && v < 2147483648.0;
+  } else if constexpr (std::same_as<T, float> && std::same_as<U, double>) {
+    return !std::isfinite(v) ||
+           std::abs(v) <= std::numeric_limits<float>::max();
+  } else {
+    return true;
+  }
+}
+
+template <typename U, value_type T>
+inline void npy_cast_(const char* src, bool swap, T* dst, size_t n) {
+  std::atomic<bool> lossy = false;
+  parallel_chunks(n, kParallelGrain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      U v;
+      std::memcpy(&v, src + i * sizeof(U), sizeof(U));
+      if constexpr (sizeof(U) > 1) {
+        using bits = std::conditional_t<
+            sizeof(U) == 2, uint16_t,
+            std::conditional_t<sizeof(U) == 4, uint32_t, uint64_t>>;
+        if (swap) v = std::bit_cast<U>(std::byteswap(std::bit_cast<bits>(v)));
+      }
+      if (!npy_fits_<T>(v)) {
+        lossy.store(true, std::memory_order_relaxed);
+        continue;
+      }
+      dst[i] = static_cast<T>(v);
+    }
+  });
+  if (lossy) {
+    throw std::runtime_error("array: .npy value is out of range for the "
+                             "loaded element type.");
+  }
+}
+
+// Convert n stored elements of any supported dtype into T
+template <value_type T>
+inline void npy_convert_(const char* src, const npy_dtype_& dt, T* dst,
+                         size_t n) {
+  auto same = npy_dtype_of_<T>();
+  if (dt.kind == same.kind && dt.size == same.size && !dt.swap) {
+    std::memcpy(dst, src, n * sizeof(T));
+    return;
+  }
+  auto s = dt.swap;
+  switch (dt.kind) {
+    case 'f':
+      if (dt.size == 4) return npy_cast_<float>(src, s, dst, n);
+      return npy_cast_<double>(src, s, dst, n);
+    case 'i':
+      if (dt.size == 1) return npy_cast_<int8_t>(src, s, dst, n);
+      if (dt.size == 2) return npy_cast_<int16_t>(src, s, dst, n);
+      if (dt.size == 4) return npy_cast_<int32_t>(src, s, dst, n);
+      return npy_cast_<int64_t>(src, s, dst, n);
+    case 'u':
+      if (dt.size == 1) return npy_cast_<uint8_t>(src, s, dst, n);
+      if (dt.size == 2) return npy_cast_<uint16_t>(src, s, dst, n);
+      if (dt.size == 4) return npy_cast_<uint32_t>(src, s, dst, n);
+      return npy_cast_<uint64_t>(src, s, dst, n);
+    default:
+      return npy_cast_<uint8_t>(src, s, dst, n);
+  }
+}
+
+// The .npy at byte `begin` of the mapping: a view when the dtype matches
+// and the payload is aligned, otherwise a converted copy
+template <value_type T>
+inline array<T> npy_load_(mapped_file& file, size_t begin,
+                          const npy_header_& h) {
+  strides_type strides;
+  if (h.fortran && h.shape.size() > 1) {
+    size_t stride = 1;
+    for (auto d : h.shape) {
+      strides.push_back(stride);
+      stride *= d;
+    }
+  }
+
+  auto offset = begin + h.data;
+  const char* src = file.data() + offset;
+  auto same = npy_dtype_of_<T>();
+  if (h.dtype.kind == same.kind && h.dtype.size == same.size &&
+      !h.dtype.swap && reinterpret_cast<uintptr_t>(src) % alignof(T) == 0) {
+    return file.view<T>(offset, h.shape, strides);
+  }
+
+  size_t n = 1;
+  for (auto d : h.shape) n *= d;
+  if (strides.empty()) {
+    auto out = array<T>(h.shape, T{});
+    npy_convert_(src, h.dtype, out.buffer_data(), n);
+    return out;
+  }
+  auto* buf = new T[std::max<size_t>(n, 1)];
+  npy_convert_(src, h.dtype, buf, n);
+  return array<T>::wrap(buf, h.shape, strides, [](T* p) { delete[] p; });
+}
+
+inline npy_value npy_load_value_(mapped_file& file, size_t begin,
+                                 const npy_header_& h) {
+  switch (h.dtype.kind) {
+    case 'f': return npy_load_<float>(file, begin, h);
+    case 'b': return npy_load_<bool>(file, begin, h);
+    default: return npy_load_<int>(file, begin, h);
+  }
+}
+
+// A version 1.0 header for a, padded so the payload starts on a kNpyAlign
+// boundary when the .npy itself starts at byte `at` of the file
+template <value_type T>
+inline std::string npy_header_of_(const array<T>& a, size_t at) {
+  auto dict = std::string("{'descr': '");
+  dict += std::same_as<T, float> ? "<f4" : std::same_as<T, int> ? "<i4" : "|b1";
+  dict += "', 'fortran_order': False, 'shape': (";
+  for (size_t d = 0; d < a.dimension(); d++) {
+    if (d) dict += ", ";
+    dict += std::to_string(a.shape()[d]);
+  }
+  dict += a.dimension() == 1 ? ",), }" : "), }";
+
+  auto used = at + 10 + dict.size() + 1;  // magic, version, length, '\n'
+  dict.append((kNpyAlign - used % kNpyAlign) % kNpyAlign, ' ');
+  dict += '\n';
+  if (dict.size() > UINT16_MAX) {
+    throw std::runtime_error("array: npy header is too long.");
+  }
+
+  auto header = std::string("\x93NUMPY\x01\x00", 8);
+  store_le_(header, static_cast<uint16_t>(dict.size()));
+  return header + dict;
+}
+
+// CRC-32 (zip's polynomial), eight bytes per step
+inline uint32_t crc32_(uint32_t crc, const void* data, size_t n) {
+  static const auto table = [] {
+    std::array<std::array<uint32_t, 256>, 8> t{};
+    for (uint32_t i = 0; i < 256; i++) {
+      auto r = i;
+      for (int k = 0; k < 8; k++) r = (r >> 1) ^ (0xEDB88320u & (0u - (r & 1)));
+      t[0][i] = r;
+    }
+    for (size_t s = 1; s < 8; s++) {
+      for (size_t i = 0; i < 256; i++) {
+        t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+      }
+    }
+    return t;
+  }();
+
+  auto* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (; n >= 8; n -= 8, p += 8) {
+    uint32_t lo, hi;
+    std::memcpy(&lo, p, 4);
+    std::memcpy(&hi, p + 4, 4);
+    lo ^= crc;
+    crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^
+          table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+          table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^
+          table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+  }
+  for (; n; n--) crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline array<T> load_npy(const std::filesystem::path& path) {
+  auto file = mapped_file::open(path);
+  auto h = detail::npy_parse_(file->data(), file->size(),
+                              "load_npy '" + path.string() + "'");
+  return detail::npy_load_<T>(*file, 0, h);
+}
+
+template <value_type T>
+inline void save_npy(const std::filesystem::path& path, const array<T>& a) {
+  auto src = a.is_contiguous() ? a : a.clone();
+  auto header = detail::npy_header_of_(src, 0);
+  std::vector<iovec> iov{
+      {header.data(), header.size()},
+      {src.buffer_data(), src.element_count() * sizeof(T)},
+  };
+  detail::write_all_(path, std::move(iov), "save_npy");
+}
+
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// A stored archive entry: the .npy at `begin` of the file and the CRC-32
+// recorded for it in the central directory
+struct npz_entry_ {
+  std::string name;
+  size_t begin = 0, size = 0;
+  uint32_t crc = 0;
+};
+
+inline std::vector<npz_entry_> npz_scan_(const mapped_file& file,
+                                         const std::string& what) {
+  auto fail = [&](const std::string& why) {
+    throw std::runtime_error("array: " + what + " " + why);
+  };
+  const char* p = file.data();
+  auto size = file.size();
+
+  // End of central directory record, followed by at most 64 KB of comment
+  if (size < 22) fail("is not a zip archive.");
+  auto eocd = size;
+  auto lowest = size - 22 - std::min<size_t>(size - 22, UINT16_MAX);
+  for (auto i = size - 22 + 1; i-- > lowest;) {
+    if (load_le_<uint32_t>(p + i) == 0x06054b50) {
+      eocd = i;
+      break;
+    }
+  }
+  if (eocd == size) fail("is not a zip archive.");
+  uint64_t entries = load_le_<uint16_t>(p + eocd + 10);
+  uint64_t cd_size = load_le_<uint32_t>(p + eocd + 12);
+  uint64_t cd = load_le_<uint32_t>(p + eocd + 16);
+
+  // Zip64 end record, through the locator just before the classic one
+  if (eocd >= 20 && load_le_<uint32_t>(p + eocd - 20) == 0x07064b50) {
+    auto z = load_le_<uint64_t>(p + eocd - 20 + 8);
+    if (size < 56 || z > size - 56 || load_le_<uint32_t>(p + z) != 0x06064b50) {
+      fail("has a corrupt zip64 record.");
+    }
+    entries = load_le_<uint64_t>(p + z + 32);
+    cd_size = load_le_<uint64_t>(p + z + 40);
+    cd = load_le_<uint64_t>(p + z + 48);
+  }
+  if (cd > size || cd_size > size - cd) fail("is truncated.");
+
+  std::vector<npz_entry_> out;
+  auto at = cd, cd_end = cd + cd_size;
+  for (uint64_t e = 0; e < entries; e++) {
+    if (at + 46 > cd_end || load_le_<uint32_t>(p + at) != 0x02014b50) {
+      fail("has a corrupt central directory.");
+    }
+    auto method = load_le_<uint16_t>(p + at + 10);
+    auto crc = load_le_<uint32_t>(p + at + 16);
+    uint64_t csize = load_le_<uint32_t>(p + at + 20);
+    uint64_t usize = load_le_<uint32_t>(p + at + 24);
+    uint64_t local = load_le_<uint32_t>(p + at + 42);
+    size_t name_len = load_le_<uint16_t>(p + at + 28);
+    size_t extra_len = load_le_<uint16_t>(p + at + 30);
+    size_t comment_len = load_le_<uint16_t>(p + at + 32);
+    if (at + 46 + name_len + extra_len > cd_end) {
+      fail("has a corrupt central directory.");
+    }
+    auto name = std::string(p + at + 46, name_len);
+
+    // A zip64 extra field holds the values saturated at 0xFFFFFFFF, in
+    // this order
+    auto* x = p + at + 46 + name_len, *x_end = x + extra_len;
+    for (; x + 4 <= x_end; x += 4 + load_le_<uint16_t>(x + 2)) {
+      if (load_le_<uint16_t>(x) != 1) continue;
+      auto* f = x + 4;
+      if (usize == UINT32_MAX) usize = load_le_<uint64_t>(f), f += 8;
+      if (csize == UINT32_MAX) csize = load_le_<uint64_t>(f), f += 8;
+      if (local == UINT32_MAX) local = load_le_<uint64_t>(f);
+    }
+    at += 46 + name_len + extra_len + comment_len;
+
+    if (method != 0) {
+      fail("entry '" + name +
+           "' is compressed; save it with np.savez, not np.savez_compressed.");
+    }
+    if (size < 30 || local > size - 30 || load_le_<uint32_t>(p + local) != 0x04034b50) {
+      fail("has a corrupt entry '" + name + "'.");
+    }
+    auto begin = local + 30 + load_le_<uint16_t>(p + local + 26) +
+                 load_le_<uint16_t>(p + local + 28);
+    if (begin > size || usize > size - begin || csize != usize) {
+      fail("has a corrupt entry '" + name + "'.");
+    }
+    out.push_back({std::move(name), begin, usize, crc});
+  }
+  return out;
+}
+
+inline std::map<std::string, npy_value> npz_load_(
+    mapped_file& file, const std::vector<npz_entry_>& entries,
+    const std::string& what) {
+  std::map<std::string, npy_value> out;
+  for (auto& e : entries) {
+    auto h = npy_parse_(file.data() + e.begin, e.size,
+                        what + " entry '" + e.name + "'");
+    auto name = e.name;
+    if (name.ends_with(".npy")) name.resize(name.size() - 4);
+    out.insert_or_assign(name, npy_load_value_(file, e.begin, h));
+  }
+  return out;
+}
+
+// save_npz in two steps. npz_prepare_ runs on the caller's thread: it
+// takes contiguous references to the arrays (copying only strided views)
+// and lays out the archive. npz_write_ only reads raw bytes, so it may run
+// on another thread while the sources are kept alive.
+struct npz_archive_ {
+  struct entry {
+    std::string name, local, header;
+    const void* data;
+    size_t bytes, offset;
+  };
+  std::vector<npy_value> sources;
+  std::vector<entry> entries;
+  size_t size = 0;  // of the local headers and entries
+};
+
+inline npz_archive_ npz_prepare_(
+    const std::vector<std::pair<std::string, npy_value>>& arrays) {
+  npz_archive_ ar;
+  ar.sources.reserve(arrays.size());
+  ar.entries.resize(arrays.size());
+  for (size_t i = 0; i < arrays.size(); i++) {
+    auto& e = ar.entries[i];
+    e.name = arrays[i].first + ".npy";
+    e.offset = ar.size;
+    std::visit(
+        [&](const auto& a) {
+          auto src = a.is_contiguous() ? a : a.clone();
+          e.header = npy_header_of_(src, ar.size + 30 + e.name.size());
+          e.data = src.buffer_data();
+          e.bytes = src.element_count() * sizeof(*src.buffer_data());
+          ar.sources.emplace_back(std::move(src));
+        },
+        arrays[i].second);
+
+    // Plain zip: sizes and offsets must fit 32 bits
+    if (e.header.size() + e.bytes > UINT32_MAX || ar.size > UINT32_MAX) {
+      throw std::runtime_error("array: save_npz archives are limited to 4 GB.");
+    }
+    ar.size += 30 + e.name.size() + e.header.size() + e.bytes;
+  }
+  if (ar.size > UINT32_MAX) {
+    throw std::runtime_error("array: save_npz archives are limited to 4 GB.");
+  }
+  if (ar.entries.size() > UINT16_MAX) {
+    throw std::runtime_error("array: save_npz takes at most 65535 arrays.");
+  }
+  return ar;
+}
+
+inline void npz_write_(const std::filesystem::path& path, npz_archive_& ar,
+                       const char* op) {
+  auto tail = std::string();
+  for (auto& e : ar.entries) {
+    auto size = static_cast<uint32_t>(e.header.size() + e.bytes);
+    auto crc = crc32_(crc32_(0, e.header.data(), e.header.size()), e.data,
+                      e.bytes);
+
+    // Local header: stored, no data descriptor, dated 1980-01-01
+    e.local.clear();
+    store_le_<uint32_t>(e.local, 0x04034b50);
+    store_le_<uint16_t>(e.local, 20);  // version needed
+    store_le_<uint16_t>(e.local, 0);   // flags
+    store_le_<uint16_t>(e.local, 0);   // method
+    store_le_<uint16_t>(e.local, 0);   // time
+    store_le_<uint16_t>(e.local, 0x21);
+    store_le_<uint32_t>(e.local, crc);
+    store_le_<uint32_t>(e.local, size);
+    store_le_<uint32_t>(e.local, size);
+    store_le_<uint16_t>(e.local, e.name.size());
+    store_le_<uint16_t>(e.local, 0);  // extra length
+    e.local += e.name;
+
+    store_le_<uint32_t>(tail, 0x02014b50);
+    store_le_<uint16_t>(tail, 20);  // version made by
+    store_le_<uint16_t>(tail, 20);  // version needed
+    store_le_<uint16_t>(tail, 0);
+    store_le_<uint16_t>(tail, 0);
+    store_le_<uint16_t>(tail, 0);
+    store_le_<uint16_t>(tail, 0x21);
+    store_le_<uint32_t>(tail, crc);
+    store_le_<uint32_t>(tail, size);
+    store_le_<uint32_t>(tail, size);
+    store_le_<uint16_t>(tail, e.name.size());
+    store_le_<uint16_t>(tail, 0);  // extra length
+    store_le_<uint16_t>(tail, 0);  // comment length
+    store_le_<uint16_t>(tail, 0);  // disk
+    store_le_<uint16_t>(tail, 0);  // internal attributes
+    store_le_<uint32_t>(tail, 0);  // external attributes
+    store_le_<uint32_t>(tail, e.offset);
+    tail += e.name;
+  }
+  auto cd_size = tail.size();
+  store_le_<uint32_t>(tail, 0x06054b50);
+  store_le_<uint16_t>(tail, 0);  // disk
+  store_le_<uint16_t>(tail, 0);  // directory disk
+  store_le_<uint16_t>(tail, ar.entries.size());
+  store_le_<uint16_t>(tail, ar.entries.size());
+  store_le_<uint32_t>(tail, cd_size);
+  store_le_<uint32_t>(tail, ar.size);
+  store_le_<uint16_t>(tail, 0);  // comment length
+
+  std::vector<iovec> iov;
+  for (auto& e : ar.entries) {
+    iov.push_back({e.local.data(), e.local.size()});
+    iov.push_back({e.header.data(), e.header.size()});
+    iov.push_back({const_cast<void*>(e.data), e.bytes});
+  }
+  iov.push_back({tail.data(), tail.size()});
+  write_all_(path, std::move(iov), op);
+}
+
+}  // namespace detail
+
+inline std::map<std::string, npy_value> load_npz(
+    const std::filesystem::path& path) {
+  auto what = "load_npz '" + path.string() + "'";
+  auto file = mapped_file::open(path);
+  return detail::npz_load_(*file, detail::npz_scan_(*file, what), what);
+}
+
+inline void save_npz(
+    const std::filesystem::path& path,
+    const std::vector<std::pair<std::string, npy_value>>& arrays) {
+  auto ar = detail::npz_prepare_(arrays);
+  detail::npz_write_(path, ar, "save_npz");
+}
+
+};  // namespace sil
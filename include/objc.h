@@ -69,6 +69,12 @@ inline void* send(void* obj, const char* sel_name, const void* a, size_t b, size
       objc_msgSend)(obj, sel(sel_name), a, b, c);
 }
 
+inline void* send(void* obj, const char* sel_name, void* a, size_t b, size_t c,
+                  void* d) {
+  return reinterpret_cast<void*(*)(void*, SEL, void*, size_t, size_t, void*)>(
+      objc_msgSend)(obj, sel(sel_name), a, b, c, d);
+}
+
 inline void* send(void* obj, const char* sel_name, size_t a, size_t b) {
   return reinterpret_cast<void*(*)(void*, SEL, size_t, size_t)>(
       objc_msgSend)(obj, sel(sel_name), a, b);
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cpu_kernels.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Philox4x32-10 counter-based RNG
+//-----------------------------------------------------------------------------
+
+// Every value is a pure function of (seed, counter): a fill of n values
+// takes counters [offset, offset + ceil(n / 4)) and advances offset. Output
+// is bit-identical for any thread count, and a fill is replayed by setting
+// the offset back (e.g. dropout's mask in the backward pass).
+class philox {
+ public:
+  explicit philox(uint64_t seed = 0, uint64_t offset = 0);
+  philox(const philox &rhs);
+  philox &operator=(const philox &rhs);
+
+  uint64_t seed() const { return seed_; }
+  uint64_t offset() const { return offset_.load(); }
+  void set_offset(uint64_t offset) { offset_.store(offset); }
+
+  void uniform(float *out, size_t n, float lo = 0.0f, float hi = 1.0f);
+  void normal(float *out, size_t n, float mean = 0.0f, float stddev = 1.0f);
+
+  // Normal values redrawn until they lie within [lo, hi] standard deviations
+  void truncated_normal(float *out, size_t n, float mean = 0.0f,
+                        float stddev = 1.0f, float lo = -2.0f, float hi = 2.0f);
+
+  // 1 with probability p, else 0
+  void bernoulli(float *out, size_t n, float p);
+
+  // out = x / (1 - p) where a uniform draw >= p, else 0. The mask is never
+  // stored; rerunning at the same offset on dout gives the gradient.
+  void dropout(const float *x, float *out, size_t n, float p);
+
+  // Claims the counters for n values and returns the first one
+  uint64_t reserve(size_t n) { return offset_.fetch_add((n + 3) / 4); }
+
+ private:
+  uint64_t seed_;
+  std::atomic<uint64_t> offset_;
+};
+
+// Generator behind random() and the other sil::random_* helpers; seeded
+// from std::random_device unless manual_seed() is called.
+philox &default_generator();
+void manual_seed(uint64_t seed);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+constexpr uint32_t kPhiloxM0 = 0xD2511F53;
+constexpr uint32_t kPhiloxM1 = 0xCD9E8D57;
+constexpr uint32_t kPhiloxW0 = 0x9E3779B9;
+constexpr uint32_t kPhiloxW1 = 0xBB67AE85;
+
+// Counters per tile. Tiles are the unit of parallel work and of every
+// vectorized transform, so results never depend on where chunks split.
+constexpr size_t kPhiloxTile = 256;
+
+// One counter (c0, c1) = 64-bit index, c2 = stream, c3 = 0
+inline void philox4x32_(uint32_t c[4], uint32_t k0, uint32_t k1) {
+  for (int r = 0; r < 10; r++) {
+    if (r) k0 += kPhiloxW0, k1 += kPhiloxW1;
+    auto p0 = uint64_t(kPhiloxM0) * c[0];
+    auto p1 = uint64_t(kPhiloxM1) * c[2];
+    uint32_t next[4] = {uint32_t(p1 >> 32) ^ c[1] ^ k0, uint32_t(p1),
+                        uint32_t(p0 >> 32) ^ c[3] ^ k1, uint32_t(p0)};
+    for (int i = 0; i < 4; i++) c[i] = next[i];
+  }
+}
+
+// Four counters at once; c[w] holds word w of each counter
+inline void philox4x32x4_(uint32x4_t c[4], uint32_t k0, uint32_t k1) {
+  auto m0 = vdupq_n_u32(kPhiloxM0), m1 = vdupq_n_u32(kPhiloxM1);
+  for (int r = 0; r < 10; r++) {
+    if (r) k0 += kPhiloxW0, k1 += kPhiloxW1;
+    auto p0l = vreinterpretq_u32_u64(vmull_u32(vget_low_u32(c[0]), vget_low_u32(m0)));
+    auto p0h = vreinterpretq_u32_u64(vmull_high_u32(c[0], m0));
+    auto p1l = vreinterpretq_u32_u64(vmull_u32(vget_low_u32(c[2]), vget_low_u32(m1)));
+    auto p1h = vreinterpretq_u32_u64(vmull_high_u32(c[2], m1));
+    auto lo0 = vuzp1q_u32(p0l, p0h), hi0 = vuzp2q_u32(p0l, p0h);
+    auto lo1 = vuzp1q_u32(p1l, p1h), hi1 = vuzp2q_u32(p1l, p1h);
+    c[0] = veorq_u32(veorq_u32(hi1, c[1]), vdupq_n_u32(k0));
+    c[1] = lo1;
+    c[2] = veorq_u32(veorq_u32(hi0, c[3]), vdupq_n_u32(k1));
+    c[3] = lo0;
+  }
+}
+
+// 4 words per counter for counters [first, first + count), counter-major
+inline void philox_words_(uint64_t first, size_t count, uint32_t stream,
+                          uint64_t seed, uint32_t *out) {
+  auto k0 = uint32_t(seed), k1 = uint32_t(seed >> 32);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32_t lo[4], hi[4];
+    for (size_t j = 0; j < 4; j++) {
+      lo[j] = uint32_t(first + i + j);
+      hi[j] = uint32_t((first + i + j) >> 32);
+    }
+    uint32x4_t c[4] = {vld1q_u32(lo), vld1q_u32(hi), vdupq_n_u32(stream),
+                       vdupq_n_u32(0)};
+    philox4x32x4_(c, k0, k1);
+    vst4q_u32(out + i * 4, uint32x4x4_t{{c[0], c[1], c[2], c[3]}});
+  }
+  for (; i < count; i++) {
+    uint32_t c[4] = {uint32_t(first + i), uint32_t((first + i) >> 32), stream,
+                     0};
+    philox4x32_(c, k0, k1);
+    for (int w = 0; w < 4; w++) out[i * 4 + w] = c[w];
+  }
+}
+
+// [0, 1) with 24 random bits
+inline float philox_unit_(uint32_t w) { return float(w >> 8) * 0x1p-24f; }
+
+inline float32x4_t philox_unit_x4_(const uint32_t *w) {
+  return vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(vld1q_u32(w), 8)), 0x1p-24f);
+}
+
+// Runs fn(words, first value, value count) for each tile of the n values
+// starting at counter `offset`, tiles spread over the thread pool
+template <typename F>
+inline void philox_tiles_(uint64_t seed, uint64_t offset, size_t n, F &&fn) {
+  auto counters = (n + 3) / 4;
+  auto tiles = (counters + kPhiloxTile - 1) / kPhiloxTile;
+  auto grain = std::max<size_t>(1, kParallelGrain / (4 * kPhiloxTile));
+  parallel_chunks(tiles, grain, [&](size_t begin, size_t end) {
+    uint32_t words[4 * kPhiloxTile];
+    for (size_t t = begin; t < end; t++) {
+      auto c0 = t * kPhiloxTile;
+      auto count = std::min(kPhiloxTile, counters - c0);
+      philox_words_(offset + c0, count, 0, seed, words);
+      fn(words, c0 * 4, std::min(count * 4, n - c0 * 4));
+    }
+  });
+}
+
+// Box-Muller on word pairs (2k, 2k + 1) into z[0, n)
+inline void philox_normals_(const uint32_t *w, size_t n, float *z) {
+  constexpr size_t kPairs = 2 * kPhiloxTile;
+  float r[kPairs], theta[kPairs], s[kPairs], c[kPairs];
+  auto pairs = static_cast<int>((n + 1) / 2);
+  for (int k = 0; k < pairs; k++) {
+    r[k] = float((w[2 * k] >> 8) + 1) * 0x1p-24f;  // (0, 1]
+    theta[k] = 6.28318530717958648f * philox_unit_(w[2 * k + 1]);
+  }
+  vvlogf(r, r, &pairs);
+  for (int k = 0; k < pairs; k++) r[k] *= -2.0f;
+  vvsqrtf(r, r, &pairs);
+  vvsincosf(s, c, theta, &pairs);
+  for (size_t i = 0; i < n; i++) {
+    z[i] = r[i / 2] * (i % 2 ? s[i / 2] : c[i / 2]);
+  }
+}
+
+// Same value as philox_normals_ would give for word `lane` of one counter
+inline float philox_normal_at_(const uint32_t w[4], size_t lane) {
+  auto pair = lane & ~size_t(1);
+  auto u1 = float((w[pair] >> 8) + 1) * 0x1p-24f;
+  auto theta = 6.28318530717958648f * philox_unit_(w[pair + 1]);
+  auto r = std::sqrt(-2.0f * std::log(u1));
+  return r * (lane % 2 ? std::sin(theta) : std::cos(theta));
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+inline philox::philox(uint64_t seed, uint64_t offset)
+    : seed_(seed), offset_(offset) {}
+
+inline philox::philox(const philox &rhs)
+    : seed_(rhs.seed_), offset_(rhs.offset_.load()) {}
+
+inline philox &philox::operator=(const philox &rhs) {
+  seed_ = rhs.seed_;
+  offset_.store(rhs.offset_.load());
+  return *this;
+}
+
+inline void philox::uniform(float *out, size_t n, float lo, float hi) {
+  auto scale = hi - lo;
+  detail::philox_tiles_(seed_, reserve(n), n,
+                        [&](const uint32_t *w, size_t first, size_t count) {
+    float *o = out + first;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      vst1q_f32(o + i, vfmaq_n_f32(vdupq_n_f32(lo),
+                                   detail::philox_unit_x4_(w + i), scale));
+    }
+    for (; i < count; i++) o[i] = lo + scale * detail::philox_unit_(w[i]);
+  });
+}
+
+inline void philox::normal(float *out, size_t n, float mean, float stddev) {
+  detail::philox_tiles_(seed_, reserve(n), n,
+                        [&](const uint32_t *w, size_t first, size_t count) {
+    float *o = out + first;
+    detail::philox_normals_(w, count, o);
+    for (size_t i = 0; i < count; i++) o[i] = mean + stddev * o[i];
+  });
+}
+
+inline void philox::truncated_normal(float *out, size_t n, float mean,
+                                     float stddev, float lo, float hi) {
+  if (!(lo < hi)) {
+    throw std::runtime_error("philox: truncated_normal needs lo < hi.");
+  }
+  constexpr uint32_t kMaxStreams = 64;
+  auto offset = reserve(n);
+  detail::philox_tiles_(seed_, offset, n,
+                        [&](const uint32_t *w, size_t first, size_t count) {
+    float *o = out + first;
+    detail::philox_normals_(w, count, o);
+    for (size_t i = 0; i < count; i++) {
+      // Redraw from stream 1, 2, ... of the same counter: still a pure
+      // function of the value's index
+      auto v = o[i];
+      for (uint32_t s = 1; (v < lo || v > hi) && s < kMaxStreams; s++) {
+        uint32_t words[4];
+        detail::philox_words_(offset + (first + i) / 4, 1, s, seed_, words);
+        v = detail::philox_normal_at_(words, (first + i) % 4);
+      }
+      o[i] = mean + stddev * std::clamp(v, lo, hi);
+    }
+  });
+}
+
+inline void philox::bernoulli(float *out, size_t n, float p) {
+  detail::philox_tiles_(seed_, reserve(n), n,
+                        [&](const uint32_t *w, size_t first, size_t count) {
+    float *o = out + first;
+    for (size_t i = 0; i < count; i++) {
+      o[i] = detail::philox_unit_(w[i]) < p ? 1.0f : 0.0f;
+    }
+  });
+}
+
+inline void philox::dropout(const float *x, float *out, size_t n, float p) {
+  if (p < 0.0f || p > 1.0f) {
+    throw std::runtime_error("philox: dropout probability must be in [0, 1].");
+  }
+  auto scale = p < 1.0f ? 1.0f / (1.0f - p) : 0.0f;
+  detail::philox_tiles_(seed_, reserve(n), n,
+                        [&](const uint32_t *w, size_t first, size_t count) {
+    const float *xi = x + first;
+    float *o = out + first;
+    auto vp = vdupq_n_f32(p);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      auto keep = vcgeq_f32(detail::philox_unit_x4_(w + i), vp);
+      auto v = vmulq_n_f32(vld1q_f32(xi + i), scale);
+      vst1q_f32(o + i, vreinterpretq_f32_u32(
+                           vandq_u32(vreinterpretq_u32_f32(v), keep)));
+    }
+    for (; i < count; i++) {
+      o[i] = detail::philox_unit_(w[i]) >= p ? xi[i] * scale : 0.0f;
+    }
+  });
+}
+
+inline philox &default_generator() {
+  static philox gen(std::random_device{}() |
+                    (uint64_t(std::random_device{}()) << 32));
+  return gen;
+}
+
+inline void manual_seed(uint64_t seed) { default_generator() = philox(seed); }
+
+};  // namespace sil
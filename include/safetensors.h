@@ -0,0 +1,572 @@
+#pragma once
+
+#include <npy.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// safetensors weight files
+//-----------------------------------------------------------------------------
+
+// A safetensors file opened lazily: the constructor maps the file and parses
+// only the JSON header, so nothing is read or allocated per tensor until it
+// is asked for. get() returns an F32 (I32, BOOL) tensor as a zero-copy view
+// of the mapping, and converts other dtypes (F16, BF16, F64, I8..I64, U8)
+// on first use, caching the result. Views and cached tensors are shared
+// across calls, and the mapping is copy-on-write, as with load_npy.
+//
+//   weights_file w("model.safetensors");
+//   auto wq = w.get("layers.0.attn.wq.weight");   // array<float>
+class weights_file {
+ public:
+  explicit weights_file(const std::filesystem::path& path);
+
+  size_t size() const { return tensors_.size(); }
+  bool contains(const std::string& name) const;
+  std::vector<std::string> names() const;  // in payload order
+
+  const std::string& dtype(const std::string& name) const;  // "F32", "BF16", ..
+  const shape_type& shape(const std::string& name) const;
+  const std::map<std::string, std::string>& metadata() const {
+    return metadata_;
+  }
+
+  template <value_type T = float>
+  array<T> get(const std::string& name);
+
+  // Drop cached conversions (views are unaffected)
+  void release(const std::string& name) { cache_.erase(name); }
+
+ private:
+  struct tensor_ {
+    std::string dtype;
+    shape_type shape;
+    size_t begin = 0, end = 0;  // in the payload
+  };
+
+  std::string what_;
+  std::shared_ptr<mapped_file> file_;
+  size_t payload_ = 0;  // file offset of the payload
+  std::map<std::string, tensor_> tensors_;
+  std::map<std::string, std::string> metadata_;
+  std::map<std::string, npy_value> cache_;
+
+  const tensor_& find_(const std::string& name) const;
+};
+
+// Layout of one tensor written by weights_writer
+struct weights_entry {
+  std::string name;
+  shape_type shape;
+  std::string dtype = "F32";  // F32, F16 or BF16 (from float), I32, BOOL
+};
+
+// Writes a safetensors file one tensor at a time, so a checkpoint never has
+// to exist in memory as a whole. The layout is declared up front: the
+// header goes out first and each write() lands at its tensor's offset.
+// Tensors are ordered by element size, as the reference writer does, so
+// every payload stays aligned for zero-copy loads.
+//
+//   weights_writer out("ckpt.safetensors",
+//                      {{"W1", {784, 128}}, {"b1", {128}, "BF16"}});
+//   out.write("W1", W1);
+//   out.write("b1", b1);  // converted to bfloat16 in bounded chunks
+//   out.close();
+class weights_writer {
+ public:
+  weights_writer(const std::filesystem::path& path,
+                 std::vector<weights_entry> entries,
+                 const std::map<std::string, std::string>& metadata = {});
+  ~weights_writer();
+
+  weights_writer(const weights_writer&) = delete;
+  weights_writer& operator=(const weights_writer&) = delete;
+
+  template <value_type T>
+  void write(const std::string& name, const array<T>& a);
+
+  // Throws if a declared tensor was never written
+  void close();
+
+ private:
+  struct slot_ {
+    weights_entry entry;
+    size_t offset = 0;  // in the file
+    bool written = false;
+  };
+
+  std::string what_;
+  int fd_ = -1;
+  std::map<std::string, slot_> slots_;
+
+  void pwrite_(const void* data, size_t bytes, size_t offset);
+};
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Bytes per element of a safetensors dtype (0 if unsupported), and the
+// matching npy kind for the types npy_convert_ handles
+inline npy_dtype_ weights_dtype_(std::string_view dtype) {
+  if (dtype == "F32") return {'f', 4};
+  if (dtype == "F64") return {'f', 8};
+  if (dtype == "F16") return {'h', 2};
+  if (dtype == "BF16") return {'B', 2};
+  if (dtype == "I8") return {'i', 1};
+  if (dtype == "I16") return {'i', 2};
+  if (dtype == "I32") return {'i', 4};
+  if (dtype == "I64") return {'i', 8};
+  if (dtype == "U8") return {'u', 1};
+  if (dtype == "BOOL") return {'b', 1};
+  return {};
+}
+
+// fp16/bf16 <-> float. Plain loops the compiler turns into fcvtl/fcvtn and
+// shift/narrow sequences; bf16 rounds to nearest even and keeps NaNs quiet.
+inline void f16_to_f32_(const char* src, float* dst, size_t n) {
+  parallel_chunks(n, kParallelGrain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      _Float16 h;
+      std::memcpy(&h, src + i * 2, 2);
+      dst[i] = static_cast<float>(h);
+    }
+  });
+}
+
+inline void bf16_to_f32_(const char* src, float* dst, size_t n) {
+  parallel_chunks(n, kParallelGrain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      uint16_t b;
+      std::memcpy(&b, src + i * 2, 2);
+      dst[i] = std::bit_cast<float>(static_cast<uint32_t>(b) << 16);
+    }
+  });
+}
+
+inline void f32_to_f16_(const float* src, uint16_t* dst, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = std::bit_cast<uint16_t>(static_cast<_Float16>(src[i]));
+  }
+}
+
+inline void f32_to_bf16_(const float* src, uint16_t* dst, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    auto u = std::bit_cast<uint32_t>(src[i]);
+    auto rounded = (u + 0x7FFF + ((u >> 16) & 1)) >> 16;
+    dst[i] = static_cast<uint16_t>(src[i] != src[i] ? (u >> 16) | 0x40
+                                                    : rounded);
+  }
+}
+
+// Just enough JSON for safetensors headers: objects, strings, integer
+// arrays, and skipping anything else
+struct json_cursor_ {
+  std::string_view s;
+  size_t at = 0;
+  const std::string& what;
+
+  [[noreturn]] void fail() const {
+    throw std::runtime_error("array: " + what + " has a malformed header.");
+  }
+  void ws() {
+    while (at < s.size() && std::string_view(" \t\r\n").contains(s[at])) at++;
+  }
+  bool peek(char c) {
+    ws();
+    return at < s.size() && s[at] == c;
+  }
+  bool accept(char c) {
+    if (!peek(c)) return false;
+    at++;
+    return true;
+  }
+  void expect(char c) {
+    if (!accept(c)) fail();
+  }
+
+  std::string string() {
+    expect('"');
+    std::string out;
+    while (at < s.size() && s[at] != '"') {
+      auto c = s[at++];
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (at >= s.size()) fail();
+      switch (auto e = s[at++]) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u': {
+          if (at + 4 > s.size()) fail();
+          auto code = std::stoul(std::string(s.substr(at, 4)), nullptr, 16);
+          at += 4;
+          // UTF-8 (surrogate pairs aren't combined)
+          if (code < 0x80) {
+            out += char(code);
+          } else if (code < 0x800) {
+            out += char(0xC0 | code >> 6);
+            out += char(0x80 | (code & 0x3F));
+          } else {
+            out += char(0xE0 | code >> 12);
+            out += char(0x80 | ((code >> 6) & 0x3F));
+            out += char(0x80 | (code & 0x3F));
+          }
+          break;
+        }
+        default: out += e;
+      }
+    }
+    expect('"');
+    return out;
+  }
+
+  size_t integer() {
+    ws();
+    size_t v = 0, start = at;
+    while (at < s.size() && s[at] >= '0' && s[at] <= '9') {
+      v = v * 10 + (s[at++] - '0');
+    }
+    if (at == start) fail();
+    return v;
+  }
+
+  std::vector<size_t> integers() {
+    std::vector<size_t> out;
+    expect('[');
+    if (accept(']')) return out;
+    do {
+      out.push_back(integer());
+    } while (accept(','));
+    expect(']');
+    return out;
+  }
+
+  // Calls fn(key) with the cursor at each member's value
+  template <typename F>
+  void object(F&& fn) {
+    expect('{');
+    if (accept('}')) return;
+    do {
+      auto key = string();
+      expect(':');
+      fn(key);
+    } while (accept(','));
+    expect('}');
+  }
+
+  void skip() {
+    ws();
+    if (peek('"')) {
+      string();
+    } else if (peek('{')) {
+      object([&](const std::string&) { skip(); });
+    } else if (accept('[')) {
+      if (accept(']')) return;
+      do {
+        skip();
+      } while (accept(','));
+      expect(']');
+    } else {
+      while (at < s.size() && !std::string_view(",}] \t\r\n").contains(s[at])) {
+        at++;
+      }
+    }
+  }
+};
+
+inline void json_quote_(std::string& out, std::string_view s) {
+  out += '"';
+  for (auto c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+inline weights_file::weights_file(const std::filesystem::path& path)
+    : what_("weights_file '" + path.string() + "'"),
+      file_(mapped_file::open(path)) {
+  auto size = file_->size();
+  if (size < 8) throw std::runtime_error("array: " + what_ + " is truncated.");
+  auto len = detail::load_le_<uint64_t>(file_->data());
+  if (len > size - 8) {
+    throw std::runtime_error("array: " + what_ + " is truncated.");
+  }
+  payload_ = 8 + len;
+
+  auto json = detail::json_cursor_{{file_->data() + 8, len}, 0, what_};
+  json.object([&](const std::string& name) {
+    if (name == "__metadata__") {
+      json.object([&](const std::string& key) {
+        metadata_[key] = json.string();
+      });
+      return;
+    }
+    tensor_ t;
+    std::vector<size_t> offsets;
+    json.object([&](const std::string& key) {
+      if (key == "dtype") {
+        t.dtype = json.string();
+      } else if (key == "shape") {
+        t.shape = json.integers();
+      } else if (key == "data_offsets") {
+        offsets = json.integers();
+      } else {
+        json.skip();
+      }
+    });
+
+    size_t count = 1;
+    for (auto d : t.shape) count *= d;
+    auto dt = detail::weights_dtype_(t.dtype);
+    if (!dt.size) {
+      throw std::runtime_error("array: " + what_ + " tensor '" + name +
+                               "' has an unsupported dtype '" + t.dtype + "'.");
+    }
+    if (offsets.size() != 2 || offsets[0] > offsets[1] ||
+        offsets[1] > size - payload_ ||
+        offsets[1] - offsets[0] != count * dt.size) {
+      throw std::runtime_error("array: " + what_ + " tensor '" + name +
+                               "' has corrupt offsets.");
+    }
+    t.begin = offsets[0];
+    t.end = offsets[1];
+    tensors_[name] = std::move(t);
+  });
+}
+
+inline bool weights_file::contains(const std::string& name) const {
+  return tensors_.contains(name);
+}
+
+inline std::vector<std::string> weights_file::names() const {
+  std::vector<std::string> out;
+  for (const auto &[name, t] : tensors_) out.push_back(name);
+  std::ranges::stable_sort(out, {}, [&](const std::string& name) {
+    return tensors_.at(name).begin;
+  });
+  return out;
+}
+
+inline const weights_file::tensor_& weights_file::find_(
+    const std::string& name) const {
+  auto it = tensors_.find(name);
+  if (it == tensors_.end()) {
+    throw std::runtime_error("array: " + what_ + " has no tensor '" + name +
+                             "'.");
+  }
+  return it->second;
+}
+
+inline const std::string& weights_file::dtype(const std::string& name) const {
+  return find_(name).dtype;
+}
+
+inline const shape_type& weights_file::shape(const std::string& name) const {
+  return find_(name).shape;
+}
+
+template <value_type T>
+inline array<T> weights_file::get(const std::string& name) {
+  const auto& t = find_(name);
+  auto dt = detail::weights_dtype_(t.dtype);
+  auto same = detail::npy_dtype_of_<T>();
+  auto offset = payload_ + t.begin;
+  const char* src = file_->data() + offset;
+  if (dt.kind == same.kind && dt.size == same.size &&
+      reinterpret_cast<uintptr_t>(src) % alignof(T) == 0) {
+    return file_->view<T>(offset, t.shape);
+  }
+
+  if (auto it = cache_.find(name); it != cache_.end()) {
+    if (auto* cached = std::get_if<array<T>>(&it->second)) return *cached;
+  }
+  auto out = array<T>(t.shape, T{});
+  auto n = out.element_count();
+  if (dt.kind == 'h' || dt.kind == 'B') {
+    if constexpr (std::same_as<T, float>) {
+      if (dt.kind == 'h') {
+        detail::f16_to_f32_(src, out.buffer_data(), n);
+      } else {
+        detail::bf16_to_f32_(src, out.buffer_data(), n);
+      }
+    } else {
+      throw std::runtime_error("array: " + what_ + " tensor '" + name +
+                               "' is " + t.dtype + "; get it as float.");
+    }
+  } else {
+    detail::npy_convert_(src, dt, out.buffer_data(), n);
+  }
+  cache_.insert_or_assign(name, out);
+  return out;
+}
+
+//-----------------------------------------------------------------------------
+
+inline weights_writer::weights_writer(
+    const std::filesystem::path& path, std::vector<weights_entry> entries,
+    const std::map<std::string, std::string>& metadata)
+    : what_("weights_writer '" + path.string() + "'") {
+  // Widest elements first keeps every tensor aligned with no gaps
+  std::ranges::stable_sort(entries, std::greater<>(), [](const auto& e) {
+    return detail::weights_dtype_(e.dtype).size;
+  });
+
+  auto header = std::string("{");
+  if (!metadata.empty()) {
+    header += "\"__metadata__\":{";
+    for (const auto &[key, value] : metadata) {
+      if (header.back() != '{') header += ',';
+      detail::json_quote_(header, key);
+      header += ':';
+      detail::json_quote_(header, value);
+    }
+    header += '}';
+  }
+
+  size_t offset = 0;
+  for (auto& e : entries) {
+    auto dt = detail::weights_dtype_(e.dtype);
+    if (e.dtype != "F32" && e.dtype != "F16" && e.dtype != "BF16" &&
+        e.dtype != "I32" && e.dtype != "BOOL") {
+      throw std::runtime_error("array: " + what_ + " can't write dtype '" +
+                               e.dtype + "'.");
+    }
+    size_t bytes = dt.size;
+    for (auto d : e.shape) bytes *= d;
+
+    if (header.size() > 1) header += ',';
+    detail::json_quote_(header, e.name);
+    header += ":{\"dtype\":\"" + e.dtype + "\",\"shape\":[";
+    for (size_t d = 0; d < e.shape.size(); d++) {
+      if (d) header += ',';
+      header += std::to_string(e.shape[d]);
+    }
+    header += "],\"data_offsets\":[" + std::to_string(offset) + "," +
+              std::to_string(offset + bytes) + "]}";
+
+    auto name = e.name;
+    if (!slots_.emplace(name, slot_{std::move(e), offset}).second) {
+      throw std::runtime_error("array: " + what_ + " has duplicate tensor '" +
+                               name + "'.");
+    }
+    offset += bytes;
+  }
+  header += '}';
+  header.append((8 - header.size() % 8) % 8, ' ');
+
+  auto prefix = std::string();
+  detail::store_le_<uint64_t>(prefix, header.size());
+  prefix += header;
+  for (auto &[name, s] : slots_) s.offset += prefix.size();
+
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) throw std::runtime_error("array: " + what_ + " cannot open.");
+  try {
+    pwrite_(prefix.data(), prefix.size(), 0);
+    if (::ftruncate(fd_, static_cast<off_t>(prefix.size() + offset)) != 0) {
+      throw std::runtime_error("array: " + what_ + " cannot write.");
+    }
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+}
+
+inline weights_writer::~weights_writer() {
+  if (fd_ >= 0) ::close(fd_);
+}
+
+inline void weights_writer::pwrite_(const void* data, size_t bytes,
+                                    size_t offset) {
+  auto* p = static_cast<const char*>(data);
+  while (bytes) {
+    auto n = ::pwrite(fd_, p, bytes, static_cast<off_t>(offset));
+    if (n <= 0) throw std::runtime_error("array: " + what_ + " cannot write.");
+    p += n;
+    offset += n;
+    bytes -= n;
+  }
+}
+
+template <value_type T>
+inline void weights_writer::write(const std::string& name, const array<T>& a) {
+  auto it = slots_.find(name);
+  if (fd_ < 0 || it == slots_.end()) {
+    throw std::runtime_error("array: " + what_ + " has no tensor '" + name +
+                             "'.");
+  }
+  auto& s = it->second;
+  auto dt = detail::weights_dtype_(s.entry.dtype);
+  auto same = detail::npy_dtype_of_<T>();
+  auto half = dt.kind == 'h' || dt.kind == 'B';
+  if (a.shape() != s.entry.shape ||
+      (dt.kind != same.kind && !(half && std::same_as<T, float>))) {
+    throw std::runtime_error("array: " + what_ + " tensor '" + name +
+                             "' doesn't match its declared shape and dtype.");
+  }
+
+  auto src = a.is_contiguous() ? a : a.clone();
+  const T* p = src.buffer_data();
+  auto n = src.element_count();
+  if (!half) {
+    pwrite_(p, n * sizeof(T), s.offset);
+  } else if constexpr (std::same_as<T, float>) {
+    // Convert through a bounded buffer
+    constexpr size_t kChunk = 1 << 18;
+    std::vector<uint16_t> buf(std::min(n, kChunk));
+    for (size_t i = 0; i < n; i += kChunk) {
+      auto count = std::min(kChunk, n - i);
+      if (dt.kind == 'h') {
+        detail::f32_to_f16_(p + i, buf.data(), count);
+      } else {
+        detail::f32_to_bf16_(p + i, buf.data(), count);
+      }
+      pwrite_(buf.data(), count * 2, s.offset + i * 2);
+    }
+  }
+  s.written = true;
+}
+
+inline void weights_writer::close() {
+  if (fd_ < 0) return;
+  for (const auto &[name, s] : slots_) {
+    if (!s.written) {
+      throw std::runtime_error("array: " + what_ + " tensor '" + name +
+                               "' was never written.");
+    }
+  }
+  auto fd = std::exchange(fd_, -1);
+  if (::close(fd) != 0) {
+    throw std::runtime_error("array: " + what_ + " cannot write.");
+  }
+}
+
+};  // namespace sil
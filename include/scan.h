@@ -0,0 +1,189 @@
+#pragma once
+
+#include <indexing.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Cumulative scans (CPU)
+//-----------------------------------------------------------------------------
+
+// Inclusive scans along `axis`: out[.., i, ..] = in[.., 0, ..] op ... op
+// in[.., i, ..]. Long contiguous lines are split across cores with a
+// reduce-then-scan pass (two reads and one write per element); other axes
+// combine whole slices row by row, vectorized across the slice.
+
+template <value_type T>
+array<T> cumsum(const array<T> &a, size_t axis);
+
+template <value_type T>
+array<T> cumprod(const array<T> &a, size_t axis);
+
+// log(cumsum(exp(a))), combined pairwise so large inputs don't overflow
+array<float> logcumsumexp(const array<float> &a, size_t axis);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Scratch block for chunk totals; small enough to stay in L1
+constexpr size_t kScanBlock = 4096;
+
+template <value_type T>
+inline T scan_identity_(scan_op op) {
+  switch (op) {
+    case scan_op::sum: return T(0);
+    case scan_op::prod: return T(1);
+    case scan_op::logaddexp:
+      if constexpr (std::floating_point<T>) return -INFINITY;
+      break;
+  }
+  return T(0);
+}
+
+template <value_type T>
+inline T scan_step_(scan_op op, T a, T b) {
+  if constexpr (std::same_as<T, float>) {
+    return scan_combine_(op, a, b);
+  } else {
+    return op == scan_op::prod ? a * b : a + b;
+  }
+}
+
+// Contiguous scan of in[0, n) from `carry`; returns the last value
+template <value_type T>
+inline T scan_run_(scan_op op, const T *in, T *out, size_t n, T carry) {
+  if constexpr (std::same_as<T, float>) {
+    return cpu::kernels().scan(op, in, out, n, carry);
+  } else {
+    for (size_t i = 0; i < n; i++) out[i] = carry = scan_step_(op, carry, in[i]);
+    return carry;
+  }
+}
+
+// Fold of in[0, n) into `carry`. Goes through the scan kernel so the chunk
+// totals round the same way as the final pass; the scratch never leaves L1.
+template <value_type T>
+inline T scan_total_(scan_op op, const T *in, size_t n, T carry) {
+  T scratch[kScanBlock];
+  for (size_t i = 0; i < n; i += kScanBlock) {
+    carry = scan_run_(op, in + i, scratch, std::min(kScanBlock, n - i), carry);
+  }
+  return carry;
+}
+
+// One long contiguous line. Pass 1 folds every chunk but the last (chunk 0
+// writes its final output right away), the chunk carries are combined
+// serially, then pass 2 scans the remaining chunks from their carries.
+template <value_type T>
+inline void scan_line_(scan_op op, const T *in, T *out, size_t n) {
+  auto id = scan_identity_<T>(op);
+  auto chunks = std::min(cpu_features().cores, n / kParallelGrain);
+  if (chunks <= 1) {
+    scan_run_(op, in, out, n, id);
+    return;
+  }
+
+  auto bound = [&](size_t c) { return n * c / chunks; };
+  std::vector<T> carry(chunks, id);
+  parallel_for(chunks - 1, [&](size_t c) {
+    auto b = bound(c), len = bound(c + 1) - b;
+    carry[c + 1] = c == 0 ? scan_run_(op, in, out, len, id)
+                          : scan_total_(op, in + b, len, id);
+  });
+  for (size_t c = 2; c < chunks; c++) {
+    carry[c] = scan_step_(op, carry[c - 1], carry[c]);
+  }
+  parallel_for(chunks - 1, [&](size_t c) {
+    auto b = bound(c + 1), len = bound(c + 2) - b;
+    scan_run_(op, in + b, out + b, len, carry[c + 1]);
+  });
+}
+
+// out[0, n) = prev op in, element-wise
+template <value_type T>
+inline void scan_slices_(scan_op op, const T *prev, const T *in, T *out,
+                         size_t n) {
+  if constexpr (std::same_as<T, float>) {
+    if (op == scan_op::sum) return cpu::kernels().add(prev, n, in, n, out, n);
+    if (op == scan_op::prod) return cpu::kernels().mul(prev, n, in, n, out, n);
+  }
+  for (size_t i = 0; i < n; i++) out[i] = scan_step_(op, prev[i], in[i]);
+}
+
+template <value_type T>
+inline array<T> scan_(const array<T> &a, size_t axis, scan_op op,
+                      const char *name) {
+  auto sp = axis_split_of_(a.shape(), axis, name);
+  auto out = array<T>(a.shape(), T{});
+  if (out.element_count() == 0) return out;
+
+  auto src = indexing_contiguous_(a);
+  const T *in = src.buffer_data();
+  T *dst = out.buffer_data();
+  auto line = sp.extent * sp.inner;
+
+  if (sp.inner == 1) {
+    // Few long lines: parallelize within each line; otherwise across lines
+    if (sp.outer < cpu_features().cores && sp.extent >= 2 * kParallelGrain) {
+      for (size_t o = 0; o < sp.outer; o++) {
+        scan_line_(op, in + o * line, dst + o * line, sp.extent);
+      }
+      return out;
+    }
+    auto id = scan_identity_<T>(op);
+    auto grain = std::max<size_t>(1, kParallelGrain / sp.extent);
+    parallel_chunks(sp.outer, grain, [&](size_t begin, size_t end) {
+      for (size_t o = begin; o < end; o++) {
+        scan_run_(op, in + o * line, dst + o * line, sp.extent, id);
+      }
+    });
+    return out;
+  }
+
+  // Strided axis: each (outer, column block) task runs down the axis
+  // combining the previous output slice with the next input slice
+  auto cols = std::min(sp.inner, kScanBlock);
+  auto blocks = (sp.inner + cols - 1) / cols;
+  auto grain = std::max<size_t>(1, kParallelGrain / (sp.extent * cols));
+  parallel_chunks(sp.outer * blocks, grain, [&](size_t begin, size_t end) {
+    for (size_t t = begin; t < end; t++) {
+      auto c0 = (t % blocks) * cols;
+      auto w = std::min(cols, sp.inner - c0);
+      auto base = (t / blocks) * line + c0;
+      std::memcpy(dst + base, in + base, w * sizeof(T));
+      for (size_t j = 1; j < sp.extent; j++) {
+        auto off = base + j * sp.inner;
+        scan_slices_(op, dst + off - sp.inner, in + off, dst + off, w);
+      }
+    }
+  });
+  return out;
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline array<T> cumsum(const array<T> &a, size_t axis) {
+  return detail::scan_(a, axis, scan_op::sum, "cumsum");
+}
+
+template <value_type T>
+inline array<T> cumprod(const array<T> &a, size_t axis) {
+  return detail::scan_(a, axis, scan_op::prod, "cumprod");
+}
+
+inline array<float> logcumsumexp(const array<float> &a, size_t axis) {
+  return detail::scan_(a, axis, scan_op::logaddexp, "logcumsumexp");
+}
+
+};  // namespace sil
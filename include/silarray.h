@@ -4,3 +4,22 @@
 #include "./cpu.h"
 #include "./gpu.h"
 #include "./array.h"
+#include "./indexing.h"
+#include "./concat.h"
+#include "./sort.h"
+#include "./scan.h"
+#include "./sparse.h"
+#include "./data_loader.h"
+#include "./mapped_file.h"
+#include "./npy.h"
+#include "./safetensors.h"
+#include "./csv.h"
+#include "./idx.h"
+#include "./checkpoint.h"
+#include "./interop.h"
+#include "./conv.h"
+#include "./norm.h"
+#include "./loss.h"
+#include "./attention.h"
+#include "./kv_cache.h"
+#include "./autotune.h"
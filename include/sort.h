@@ -0,0 +1,226 @@
+#pragma once
+
+#include <indexing.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Sorting and selection
+//-----------------------------------------------------------------------------
+
+// Every op works on the 1D lines along `axis`, split across cores. Order is
+// total: NaN ranks above every number, and equal values keep their original
+// order, so results don't depend on the thread count.
+
+template <value_type T>
+struct topk_result {
+  array<T> values;
+  array<int> indices;  // positions along `axis`
+};
+
+// The k largest (or smallest) entries of each line, best first; `axis` of
+// the result has extent k. Small k keeps a bounded sorted buffer and
+// rejects most elements with a single compare; larger k uses introselect.
+template <value_type T>
+topk_result<T> topk(const array<T> &a, size_t k, size_t axis,
+                    bool largest = true);
+
+template <value_type T>
+array<T> sort(const array<T> &a, size_t axis, bool descending = false);
+
+// Positions along `axis` that would sort each line
+template <value_type T>
+array<int> argsort(const array<T> &a, size_t axis, bool descending = false);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// At or below these sizes insertion beats std::sort / nth_element
+constexpr size_t kSortInsertionMax = 32;
+constexpr size_t kTopkBufferMax = 32;
+
+template <value_type T>
+struct sort_key_ {
+  T value;
+  int index;
+};
+
+template <value_type T>
+inline bool ranks_before_(const sort_key_<T> &a, const sort_key_<T> &b,
+                          bool descending) {
+  if constexpr (std::floating_point<T>) {
+    bool na = std::isnan(a.value), nb = std::isnan(b.value);
+    if (na || nb) {
+      if (na && nb) return a.index < b.index;
+      return descending ? na : nb;
+    }
+  }
+  if (a.value != b.value) {
+    return descending ? a.value > b.value : a.value < b.value;
+  }
+  return a.index < b.index;
+}
+
+template <value_type T>
+inline void insertion_sort_(sort_key_<T> *keys, size_t n, bool descending) {
+  for (size_t i = 1; i < n; i++) {
+    auto key = keys[i];
+    size_t j = i;
+    for (; j > 0 && ranks_before_(key, keys[j - 1], descending); j--) {
+      keys[j] = keys[j - 1];
+    }
+    keys[j] = key;
+  }
+}
+
+template <value_type T>
+inline void sort_keys_(sort_key_<T> *keys, size_t n, bool descending) {
+  if (n <= kSortInsertionMax) return insertion_sort_(keys, n, descending);
+  std::sort(keys, keys + n, [descending](const auto &a, const auto &b) {
+    return ranks_before_(a, b, descending);
+  });
+}
+
+template <value_type T>
+inline void load_line_(const T *src, size_t stride, size_t n,
+                       sort_key_<T> *keys) {
+  for (size_t j = 0; j < n; j++) {
+    keys[j] = {src[j * stride], static_cast<int>(j)};
+  }
+}
+
+// Best k of a line into keys[0, k), best first. `keys` holds the whole line.
+template <value_type T>
+inline void select_line_(const T *src, size_t stride, size_t n, size_t k,
+                         bool largest, sort_key_<T> *keys) {
+  if (k > kTopkBufferMax || k == n) {
+    load_line_(src, stride, n, keys);
+    auto before = [largest](const auto &a, const auto &b) {
+      return ranks_before_(a, b, largest);
+    };
+    if (k < n) std::nth_element(keys, keys + k, keys + n, before);
+    return sort_keys_(keys, k, largest);
+  }
+
+  // Bounded buffer: a candidate must beat the current k-th entry. Later
+  // positions lose ties, so a plain compare rejects almost everything; on
+  // contiguous lines whole blocks are rejected by one vectorized test (a
+  // NaN fails the compare and so always gets a closer look).
+  load_line_(src, stride, k, keys);
+  insertion_sort_(keys, k, largest);
+  auto offer = [&](size_t j) {
+    auto key = sort_key_<T>{src[j * stride], static_cast<int>(j)};
+    if (!ranks_before_(key, keys[k - 1], largest)) return;
+    size_t i = k - 1;
+    for (; i > 0 && ranks_before_(key, keys[i - 1], largest); i--) {
+      keys[i] = keys[i - 1];
+    }
+    keys[i] = key;
+  };
+
+  constexpr size_t kBlock = 16;
+  size_t j = k;
+  if (stride == 1) {
+    for (; j + kBlock <= n; j += kBlock) {
+      auto worst = keys[k - 1].value;
+      int hits = 0;
+      if (largest) {
+        for (size_t b = 0; b < kBlock; b++) hits += !(src[j + b] < worst);
+      } else {
+        for (size_t b = 0; b < kBlock; b++) hits += !(src[j + b] > worst);
+      }
+      if (!hits) continue;
+      for (size_t b = 0; b < kBlock; b++) offer(j + b);
+    }
+  }
+  for (; j < n; j++) offer(j);
+}
+
+// Run fn(src, dst_offset, keys) for each line along the axis, in parallel
+// chunks of lines. dst_offset locates the line in an output whose axis has
+// extent `out_extent`; both input and output lines have stride sp.inner.
+template <value_type T, typename F>
+inline void for_each_line_(const T *data, const axis_split_ &sp,
+                           size_t out_extent, F &&fn) {
+  auto lines = sp.outer * sp.inner;
+  auto grain =
+      std::max<size_t>(1, kParallelGrain / std::max<size_t>(sp.extent, 1));
+  parallel_chunks(lines, grain, [&](size_t begin, size_t end) {
+    std::vector<sort_key_<T>> keys(sp.extent);
+    for (size_t l = begin; l < end; l++) {
+      auto o = l / sp.inner, i = l % sp.inner;
+      fn(data + o * sp.extent * sp.inner + i, o * out_extent * sp.inner + i,
+         keys.data());
+    }
+  });
+}
+
+template <value_type T>
+inline void sort_lines_(const array<T> &a, size_t axis, bool descending,
+                        T *values, int *indices) {
+  auto sp = axis_split_of_(a.shape(), axis, "sort");
+  auto src = indexing_contiguous_(a);
+  for_each_line_(src.buffer_data(), sp, sp.extent,
+                 [&](const T *line, size_t off, sort_key_<T> *keys) {
+    load_line_(line, sp.inner, sp.extent, keys);
+    sort_keys_(keys, sp.extent, descending);
+    for (size_t j = 0; j < sp.extent; j++) {
+      if (values) values[off + j * sp.inner] = keys[j].value;
+      if (indices) indices[off + j * sp.inner] = keys[j].index;
+    }
+  });
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline topk_result<T> topk(const array<T> &a, size_t k, size_t axis,
+                           bool largest) {
+  auto sp = detail::axis_split_of_(a.shape(), axis, "topk");
+  if (k == 0 || k > sp.extent) {
+    throw std::runtime_error("array: topk k is out of range.");
+  }
+
+  auto shape = a.shape();
+  shape[axis] = k;
+  auto result = topk_result<T>{array<T>(shape, T{}), array<int>(shape, 0)};
+  T *vp = result.values.buffer_data();
+  int *ip = result.indices.buffer_data();
+  auto src = detail::indexing_contiguous_(a);
+  detail::for_each_line_(src.buffer_data(), sp, k,
+                         [&](const T *line, size_t off, auto *keys) {
+    detail::select_line_(line, sp.inner, sp.extent, k, largest, keys);
+    for (size_t j = 0; j < k; j++) {
+      vp[off + j * sp.inner] = keys[j].value;
+      ip[off + j * sp.inner] = keys[j].index;
+    }
+  });
+  return result;
+}
+
+template <value_type T>
+inline array<T> sort(const array<T> &a, size_t axis, bool descending) {
+  auto out = array<T>(a.shape(), T{});
+  detail::sort_lines_(a, axis, descending, out.buffer_data(),
+                      static_cast<int *>(nullptr));
+  return out;
+}
+
+template <value_type T>
+inline array<int> argsort(const array<T> &a, size_t axis, bool descending) {
+  auto out = array<int>(a.shape(), 0);
+  detail::sort_lines_(a, axis, descending, static_cast<T *>(nullptr),
+                      out.buffer_data());
+  return out;
+}
+
+};  // namespace sil
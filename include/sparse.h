@@ -0,0 +1,304 @@
+#pragma once
+
+#include <array.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Sparse CSR matrices (CPU)
+//-----------------------------------------------------------------------------
+
+// Compressed sparse rows: row r holds the entries [row_offsets()[r],
+// row_offsets()[r + 1]) of col_indices()/values(), with column indices
+// strictly increasing within a row. Storage is O(rows + nnz).
+//
+//   csr_array<float> s(dense);                   // drops exact zeros
+//   csr_array<float> s(rows, cols, r, c, v);     // COO triplets
+//   auto y = spmv(s, x);                         // (rows)
+//   auto dx = spmm(s, dy, true);                 // S^T dy, for backward
+template <value_type T>
+class csr_array {
+ public:
+  csr_array() = default;
+  explicit csr_array(const array<T> &dense);
+
+  // Triplets in any order; duplicate (row, col) entries are summed
+  csr_array(size_t rows, size_t cols, const array<int> &row_indices,
+            const array<int> &col_indices, const array<T> &values);
+
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+  size_t nnz() const { return values_.size(); }
+  shape_type shape() const { return {rows_, cols_}; }
+
+  const std::vector<size_t> &row_offsets() const { return row_ptr_; }
+  const std::vector<int> &col_indices() const { return col_idx_; }
+  const std::vector<T> &values() const { return values_; }
+
+  array<T> to_dense() const;
+
+  // A^T as CSR: one counting sort over the entries, O(nnz + cols)
+  csr_array transpose() const;
+
+ private:
+  size_t rows_ = 0, cols_ = 0;
+  std::vector<size_t> row_ptr_{0};
+  std::vector<int> col_idx_;
+  std::vector<T> values_;
+};
+
+// A x for x of shape (cols), or A^T x for x of shape (rows)
+template <value_type T>
+array<T> spmv(const csr_array<T> &a, const array<T> &x, bool trans_a = false);
+
+// A B for dense B of shape (cols, n), or A^T B for B of shape (rows, n).
+// Rows are split across cores by nonzero count, so a few dense rows don't
+// serialize the product. The transposed forms build a.transpose() first;
+// keep the transpose around when applying it repeatedly.
+template <value_type T>
+array<T> spmm(const csr_array<T> &a, const array<T> &b, bool trans_a = false);
+
+//-----------------------------------------------------------------------------
+// Implementation
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+template <value_type T>
+inline array<T> sparse_contiguous_(const array<T> &a) {
+  return a.is_contiguous() ? a : a.clone();
+}
+
+// Row boundaries of `parts` chunks of roughly equal work, counting a row as
+// its nonzeros plus one (the output row it writes). The cost prefix
+// row_ptr[r] + r is strictly increasing, so each boundary is a binary search.
+inline std::vector<size_t> csr_partition_(const std::vector<size_t> &row_ptr,
+                                          size_t parts) {
+  auto rows = row_ptr.size() - 1;
+  auto total = row_ptr[rows] + rows;
+  std::vector<size_t> bounds(parts + 1, rows);
+  bounds[0] = 0;
+  for (size_t p = 1; p < parts; p++) {
+    auto target = total * p / parts;
+    size_t lo = bounds[p - 1], hi = rows;
+    while (lo < hi) {
+      auto mid = lo + (hi - lo) / 2;
+      if (row_ptr[mid] + mid < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    bounds[p] = lo;
+  }
+  return bounds;
+}
+
+// Run fn(begin, end) over row ranges balanced by nonzeros; `width` is the
+// work per nonzero (output columns)
+template <typename F>
+inline void csr_rows_(const std::vector<size_t> &row_ptr, size_t width,
+                      F &&fn) {
+  auto rows = row_ptr.size() - 1;
+  auto work = (row_ptr[rows] + rows) * std::max<size_t>(width, 1);
+  auto parts = std::min(cpu_features().cores, work / kParallelGrain);
+  if (parts <= 1) {
+    if (rows) fn(size_t(0), rows);
+    return;
+  }
+  auto bounds = csr_partition_(row_ptr, parts);
+  parallel_for(parts, [&](size_t p) {
+    if (bounds[p] < bounds[p + 1]) fn(bounds[p], bounds[p + 1]);
+  });
+}
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline csr_array<T>::csr_array(const array<T> &dense) {
+  if (dense.dimension() != 2) {
+    throw std::runtime_error("array: csr_array requires a 2D array.");
+  }
+  rows_ = dense.shape()[0];
+  cols_ = dense.shape()[1];
+  auto src = detail::sparse_contiguous_(dense);
+  const T *p = src.buffer_data();
+
+  // Count per row, prefix, then fill: two parallel sweeps over the dense rows
+  row_ptr_.assign(rows_ + 1, 0);
+  auto grain =
+      std::max<size_t>(1, detail::kParallelGrain / std::max<size_t>(cols_, 1));
+  detail::parallel_chunks(rows_, grain, [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; r++) {
+      const T *row = p + r * cols_;
+      size_t count = 0;
+      for (size_t c = 0; c < cols_; c++) count += row[c] != T{};
+      row_ptr_[r + 1] = count;
+    }
+  });
+  for (size_t r = 0; r < rows_; r++) row_ptr_[r + 1] += row_ptr_[r];
+
+  col_idx_.resize(row_ptr_[rows_]);
+  values_.resize(row_ptr_[rows_]);
+  detail::parallel_chunks(rows_, grain, [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; r++) {
+      const T *row = p + r * cols_;
+      auto k = row_ptr_[r];
+      for (size_t c = 0; c < cols_; c++) {
+        if (row[c] != T{}) {
+          col_idx_[k] = static_cast<int>(c);
+          values_[k++] = row[c];
+        }
+      }
+    }
+  });
+}
+
+template <value_type T>
+inline csr_array<T>::csr_array(size_t rows, size_t cols,
+                               const array<int> &row_indices,
+                               const array<int> &col_indices,
+                               const array<T> &values)
+    : rows_(rows), cols_(cols) {
+  auto n = values.element_count();
+  if (row_indices.element_count() != n || col_indices.element_count() != n) {
+    throw std::runtime_error("array: csr_array triplet lengths differ.");
+  }
+  auto ri = detail::sparse_contiguous_(row_indices);
+  auto ci = detail::sparse_contiguous_(col_indices);
+  auto vs = detail::sparse_contiguous_(values);
+  const int *rp = ri.buffer_data();
+  const int *cp = ci.buffer_data();
+  const T *vp = vs.buffer_data();
+  for (size_t i = 0; i < n; i++) {
+    if (rp[i] < 0 || static_cast<size_t>(rp[i]) >= rows || cp[i] < 0 ||
+        static_cast<size_t>(cp[i]) >= cols) {
+      throw std::runtime_error("array: csr_array index is out of range.");
+    }
+  }
+
+  // Counting sort by row, then order each row by column and merge
+  // duplicates in place
+  std::vector<size_t> start(rows + 1, 0);
+  for (size_t i = 0; i < n; i++) start[rp[i] + 1]++;
+  for (size_t r = 0; r < rows; r++) start[r + 1] += start[r];
+  std::vector<size_t> pos(start.begin(), start.end() - 1);
+  std::vector<std::pair<int, T>> entries(n);
+  for (size_t i = 0; i < n; i++) entries[pos[rp[i]]++] = {cp[i], vp[i]};
+
+  row_ptr_.assign(rows + 1, 0);
+  col_idx_.reserve(n);
+  values_.reserve(n);
+  for (size_t r = 0; r < rows; r++) {
+    auto b = entries.begin() + start[r], e = entries.begin() + start[r + 1];
+    std::stable_sort(b, e, [](const auto &x, const auto &y) {
+      return x.first < y.first;
+    });
+    for (auto it = b; it != e; ++it) {
+      if (values_.size() > row_ptr_[r] && col_idx_.back() == it->first) {
+        values_.back() += it->second;
+      } else {
+        col_idx_.push_back(it->first);
+        values_.push_back(it->second);
+      }
+    }
+    row_ptr_[r + 1] = values_.size();
+  }
+}
+
+template <value_type T>
+inline array<T> csr_array<T>::to_dense() const {
+  auto out = array<T>({rows_, cols_}, T{});
+  T *p = out.buffer_data();
+  for (size_t r = 0; r < rows_; r++) {
+    for (auto k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) {
+      p[r * cols_ + col_idx_[k]] = values_[k];
+    }
+  }
+  return out;
+}
+
+template <value_type T>
+inline csr_array<T> csr_array<T>::transpose() const {
+  auto t = csr_array<T>();
+  t.rows_ = cols_;
+  t.cols_ = rows_;
+  t.row_ptr_.assign(cols_ + 1, 0);
+  for (auto c : col_idx_) t.row_ptr_[c + 1]++;
+  for (size_t c = 0; c < cols_; c++) t.row_ptr_[c + 1] += t.row_ptr_[c];
+
+  // Rows are visited in order, so each transposed row comes out sorted
+  std::vector<size_t> pos(t.row_ptr_.begin(), t.row_ptr_.end() - 1);
+  t.col_idx_.resize(nnz());
+  t.values_.resize(nnz());
+  for (size_t r = 0; r < rows_; r++) {
+    for (auto k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) {
+      auto dst = pos[col_idx_[k]]++;
+      t.col_idx_[dst] = static_cast<int>(r);
+      t.values_[dst] = values_[k];
+    }
+  }
+  return t;
+}
+
+//-----------------------------------------------------------------------------
+
+template <value_type T>
+inline array<T> spmv(const csr_array<T> &a, const array<T> &x, bool trans_a) {
+  if (trans_a) return spmv(a.transpose(), x);
+  if (x.dimension() != 1 || x.element_count() != a.cols()) {
+    throw std::runtime_error("array: spmv shape mismatch.");
+  }
+  auto src = detail::sparse_contiguous_(x);
+  const T *xp = src.buffer_data();
+  auto out = array<T>({a.rows()}, T{});
+  T *yp = out.buffer_data();
+  const auto &ptr = a.row_offsets();
+  const int *ci = a.col_indices().data();
+  const T *vs = a.values().data();
+  detail::csr_rows_(ptr, 1, [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; r++) {
+      T acc{};
+      for (auto k = ptr[r]; k < ptr[r + 1]; k++) acc += vs[k] * xp[ci[k]];
+      yp[r] = acc;
+    }
+  });
+  return out;
+}
+
+template <value_type T>
+inline array<T> spmm(const csr_array<T> &a, const array<T> &b, bool trans_a) {
+  if (trans_a) return spmm(a.transpose(), b);
+  if (b.dimension() != 2 || b.shape()[0] != a.cols()) {
+    throw std::runtime_error("array: spmm shape mismatch.");
+  }
+  auto n = b.shape()[1];
+  auto src = detail::sparse_contiguous_(b);
+  const T *bp = src.buffer_data();
+  auto out = array<T>({a.rows(), n}, T{});
+  T *cp = out.buffer_data();
+  const auto &ptr = a.row_offsets();
+  const int *ci = a.col_indices().data();
+  const T *vs = a.values().data();
+
+  // Each nonzero adds a scaled row of B into the output row, which stays in
+  // cache while the row's entries stream past
+  detail::csr_rows_(ptr, n, [&](size_t begin, size_t end) {
+    for (size_t r = begin; r < end; r++) {
+      T *c = cp + r * n;
+      for (auto k = ptr[r]; k < ptr[r + 1]; k++) {
+        auto v = vs[k];
+        const T *brow = bp + static_cast<size_t>(ci[k]) * n;
+        for (size_t j = 0; j < n; j++) c[j] += v * brow[j];
+      }
+    }
+  });
+  return out;
+}
+
+};  // namespace sil
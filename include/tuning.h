@@ -0,0 +1,151 @@
+#pragma once
+
+#include <sys/sysctl.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace sil {
+
+//-----------------------------------------------------------------------------
+// Dispatch thresholds
+//-----------------------------------------------------------------------------
+
+// Crossover points between kernel variants. The defaults match what the
+// library used before tuning existed; autotune() measures them on the
+// current host and persists the result to tuning_cache_path().
+struct tuning_params {
+  // Accelerate affine: use the single-pass NEON FMA at or above this size
+  size_t neon_affine_threshold = 5'000'000;
+  // Elementwise / row-wise CPU kernels split across cores at this size
+  size_t parallel_threshold = 1 << 18;
+  // MPS sum(): reduce on the CPU below this many elements
+  size_t gpu_sum_threshold = 0;
+  // STEEL GEMM requires M, N, K >= this
+  size_t steel_min_dim = 8;
+  // GPU reductions: threads per threadgroup (power of two, <= 1024) and
+  // maximum number of partial sums
+  size_t reduction_tg_size = 1024;
+  size_t reduction_max_tgs = 256;
+  // Packed CPU GEMM blocking (scalar/NEON tiers)
+  size_t gemm_mc = 128;
+  size_t gemm_kc = 256;
+  size_t gemm_nc = 4096;
+};
+
+// Bump when fields are added or their meaning changes; older caches are
+// ignored.
+constexpr int kTuningCacheVersion = 1;
+
+namespace detail {
+
+inline int sysctl_int_(const char *name, int fallback = 0) {
+  int value = 0;
+  size_t len = sizeof(value);
+  if (sysctlbyname(name, &value, &len, nullptr, 0) != 0) return fallback;
+  return value;
+}
+
+inline std::string sysctl_string_(const char *name) {
+  size_t len = 0;
+  if (sysctlbyname(name, nullptr, &len, nullptr, 0) != 0 || len == 0) return {};
+  std::string s(len, '\0');
+  if (sysctlbyname(name, s.data(), &len, nullptr, 0) != 0) return {};
+  s.resize(std::strlen(s.c_str()));
+  return s;
+}
+
+inline std::string tuning_host_() {
+  return sysctl_string_("machdep.cpu.brand_string");
+}
+
+template <typename F>
+inline void for_each_tuning_field_(tuning_params &p, F &&fn) {
+  fn("neon_affine_threshold", p.neon_affine_threshold);
+  fn("parallel_threshold", p.parallel_threshold);
+  fn("gpu_sum_threshold", p.gpu_sum_threshold);
+  fn("steel_min_dim", p.steel_min_dim);
+  fn("reduction_tg_size", p.reduction_tg_size);
+  fn("reduction_max_tgs", p.reduction_max_tgs);
+  fn("gemm_mc", p.gemm_mc);
+  fn("gemm_kc", p.gemm_kc);
+  fn("gemm_nc", p.gemm_nc);
+}
+
+}  // namespace detail
+
+// $SIL_TUNING_CACHE, else ~/Library/Caches/sil/tuning.txt
+inline std::filesystem::path tuning_cache_path() {
+  if (auto env = std::getenv("SIL_TUNING_CACHE")) return env;
+  auto home = std::getenv("HOME");
+  return std::filesystem::path(home ? home : ".") / "Library" / "Caches" /
+         "sil" / "tuning.txt";
+}
+
+// Cache file format (one entry per line):
+//   sil-tuning <version>
+//   host <cpu brand string>
+//   <field> <value>
+inline bool save_tuning(const tuning_params &params,
+                        const std::filesystem::path &path = tuning_cache_path()) {
+  std::error_code ec;
+  if (path.has_parent_path())
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+  std::ofstream out(path);
+  if (!out) return false;
+  out << "sil-tuning " << kTuningCacheVersion << "\n";
+  out << "host " << detail::tuning_host_() << "\n";
+  auto p = params;
+  detail::for_each_tuning_field_(
+      p, [&](const char *key, size_t &v) { out << key << " " << v << "\n"; });
+  return bool(out);
+}
+
+// Returns false (leaving `params` untouched) when the file is missing,
+// from another version, or was written on a different CPU.
+inline bool load_tuning(tuning_params &params,
+                        const std::filesystem::path &path = tuning_cache_path()) {
+  std::ifstream in(path);
+  if (!in) return false;
+
+  std::string magic, host;
+  int version = 0;
+  if (!(in >> magic >> version) || magic != "sil-tuning" ||
+      version != kTuningCacheVersion)
+    return false;
+
+  std::string key;
+  in >> key;
+  std::getline(in >> std::ws, host);
+  if (key != "host" || host != detail::tuning_host_()) return false;
+
+  auto loaded = params;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream ss(line);
+    size_t value;
+    if (!(ss >> key >> value)) continue;
+    detail::for_each_tuning_field_(loaded, [&](const char *k, size_t &v) {
+      if (key == k) v = value;
+    });
+  }
+  params = loaded;
+  return true;
+}
+
+// Active thresholds; loaded from the cache on first use.
+inline tuning_params &tuning() {
+  static tuning_params params = [] {
+    tuning_params p;
+    load_tuning(p);
+    return p;
+  }();
+  return params;
+}
+
+};  // namespace sil
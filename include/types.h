@@ -8,4 +8,19 @@ template <typename T>
 concept value_type =
     std::same_as<T, float> || std::same_as<T, int> || std::same_as<T, bool>;
 
+// Element-wise float functions shared by the CPU and GPU backends
+enum class unary_op { exp, log, tanh, gelu, silu, sqrt, rsqrt, abs, clamp };
+
+// Associative combines for inclusive scans; logaddexp is log(exp(a) + exp(b))
+enum class scan_op { sum, prod, logaddexp };
+
+// Kernels compute out[i] = f(in[i] * scale + offset) * post_scale +
+// post_offset, so scalar arithmetic on either side of f (deferred by the
+// lazy evaluator) costs no extra pass. lo/hi are the clamp bounds.
+struct unary_args {
+  float scale = 1.0f, offset = 0.0f;
+  float post_scale = 1.0f, post_offset = 0.0f;
+  float lo = 0.0f, hi = 0.0f;
+};
+
 };  // namespace sil
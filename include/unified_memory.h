@@ -2,12 +2,23 @@
 
 #include <objc.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <unistd.h>
+
 extern "C" void* MTLCreateSystemDefaultDevice(void);
 
 namespace sil {
@@ -22,6 +33,76 @@ struct storage {
   size_t len = 0;
 
   static storage make(size_t bytes);
+
+  // Shares external memory without copying; `release` runs once the last
+  // reference is gone. Metal maps whole pages, so `data` is the start of
+  // the page holding `ptr`. mtl_buf stays null if Metal refuses the range.
+  static storage adopt(void* ptr, size_t bytes, std::function<void()> release);
+};
+
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+// Buffers (storage::buf) a background writer such as a checkpoint is still
+// reading. In-place operators and mutable accessors write a captured buffer
+// out of place instead, so the writer keeps the values it captured without
+// copying them up front.
+class capture_set {
+ public:
+  static capture_set& instance() {
+    static capture_set s;
+    return s;
+  }
+
+  void add(const void* buf) {
+    std::lock_guard lock(mutex_);
+    bufs_.insert(buf);
+    count_.fetch_add(1, std::memory_order_release);
+  }
+
+  void remove(const void* buf) {
+    std::lock_guard lock(mutex_);
+    if (auto it = bufs_.find(buf); it != bufs_.end()) {
+      bufs_.erase(it);
+      count_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  // A single atomic load when nothing is captured
+  bool contains(const void* buf) const {
+    if (count_.load(std::memory_order_acquire) == 0) return false;
+    std::lock_guard lock(mutex_);
+    return bufs_.contains(buf);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::atomic<size_t> count_ = 0;
+  std::unordered_multiset<const void*> bufs_;
+};
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+
+// Snapshot of buffer_pool counters returned by memory_stats().
+// Size classes are power-of-two buckets; `bytes` is the bucket's upper bound.
+struct memory_info {
+  struct size_class {
+    size_t bytes = 0;
+    size_t live = 0;      // buffers currently owned by storage
+    size_t cached = 0;    // buffers parked in the free lists
+    size_t acquires = 0;  // acquire() calls since startup
+  };
+
+  size_t live_bytes = 0;
+  size_t cached_bytes = 0;
+  size_t peak_bytes = 0;   // high-water mark of live_bytes
+  size_t allocations = 0;  // Metal buffers created (== pool_misses)
+  size_t pool_hits = 0;
+  size_t pool_misses = 0;
+  std::vector<size_class> size_classes;  // non-empty buckets, ascending
 };
 
 //-----------------------------------------------------------------------------
@@ -36,23 +117,103 @@ class buffer_pool {
   }
 
   void* acquire(size_t bytes) {
+    auto& sc = classes_[size_class_(bytes)];
+    sc.acquires++;
+    sc.live++;
+    live_bytes_ += bytes;
+    peak_bytes_ = std::max(peak_bytes_, live_bytes_);
+    scope_peak_bytes_ = std::max(scope_peak_bytes_, live_bytes_);
+
     auto it = free_buffers_.find(bytes);
     if (it != free_buffers_.end() && !it->second.empty()) {
       auto buf = it->second.back();
       it->second.pop_back();
+      sc.cached--;
+      cached_bytes_ -= bytes;
+      hits_++;
       return buf;
     }
+    misses_++;
     // MTLResourceStorageModeShared = 0
     return objc::send(device, "newBufferWithLength:options:", bytes, 0ul);
   }
 
   void release(void* buf, size_t bytes) {
+    auto& sc = classes_[size_class_(bytes)];
+    sc.live--;
+    sc.cached++;
+    live_bytes_ -= bytes;
+    cached_bytes_ += bytes;
     free_buffers_[bytes].push_back(buf);
   }
 
+  memory_info stats() const {
+    memory_info info;
+    info.live_bytes = live_bytes_;
+    info.cached_bytes = cached_bytes_;
+    info.peak_bytes = peak_bytes_;
+    info.allocations = misses_;
+    info.pool_hits = hits_;
+    info.pool_misses = misses_;
+    for (size_t i = 0; i < classes_.size(); i++) {
+      auto& sc = classes_[i];
+      if (sc.acquires == 0) continue;
+      info.size_classes.push_back({size_t(1) << i, sc.live, sc.cached,
+                                   sc.acquires});
+    }
+    return info;
+  }
+
+  // Release cached buffers, largest first, until at most max_cached_bytes
+  // remain in the free lists. Returns the number of bytes given back.
+  size_t trim(size_t max_cached_bytes) {
+    std::vector<size_t> sizes;
+    for (auto& [bytes, list] : free_buffers_)
+      if (!list.empty()) sizes.push_back(bytes);
+    std::ranges::sort(sizes, std::greater<>());
+
+    size_t freed = 0;
+    for (auto bytes : sizes) {
+      if (cached_bytes_ <= max_cached_bytes) break;
+      auto& list = free_buffers_[bytes];
+      auto& sc = classes_[size_class_(bytes)];
+      while (!list.empty() && cached_bytes_ > max_cached_bytes) {
+        objc::release(list.back());
+        list.pop_back();
+        sc.cached--;
+        cached_bytes_ -= bytes;
+        freed += bytes;
+      }
+    }
+    std::erase_if(free_buffers_, [](const auto& kv) { return kv.second.empty(); });
+    return freed;
+  }
+
  private:
+  friend class peak_memory_scope;
+
+  struct class_counters {
+    size_t live = 0;
+    size_t cached = 0;
+    size_t acquires = 0;
+  };
+
   std::unordered_map<size_t, std::vector<void*>> free_buffers_;
 
+  // Plain counters: the pool is not thread-safe, and the bookkeeping is a
+  // handful of adds on a path that already does a map lookup.
+  size_t live_bytes_ = 0;
+  size_t cached_bytes_ = 0;
+  size_t peak_bytes_ = 0;
+  size_t scope_peak_bytes_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  std::array<class_counters, 64> classes_{};
+
+  static size_t size_class_(size_t bytes) {
+    return bytes <= 1 ? 0 : std::bit_width(bytes - 1);
+  }
+
   buffer_pool() {
     device = MTLCreateSystemDefaultDevice();
     if (!device) {
@@ -63,6 +224,46 @@ class buffer_pool {
 
 //-----------------------------------------------------------------------------
 
+// Records the peak live bytes reached while the scope is alive.
+// Scopes nest; the outer scope sees the inner peak once the inner one ends.
+class peak_memory_scope {
+ public:
+  peak_memory_scope() {
+    auto& pool = buffer_pool::instance();
+    saved_peak_ = pool.scope_peak_bytes_;
+    base_bytes_ = pool.live_bytes_;
+    pool.scope_peak_bytes_ = pool.live_bytes_;
+  }
+
+  ~peak_memory_scope() {
+    auto& pool = buffer_pool::instance();
+    pool.scope_peak_bytes_ = std::max(saved_peak_, pool.scope_peak_bytes_);
+  }
+
+  peak_memory_scope(const peak_memory_scope&) = delete;
+  peak_memory_scope& operator=(const peak_memory_scope&) = delete;
+
+  // Peak live bytes since construction
+  size_t peak_bytes() const {
+    return buffer_pool::instance().scope_peak_bytes_;
+  }
+
+  // Growth of the peak over live bytes at construction
+  size_t delta_bytes() const { return peak_bytes() - base_bytes_; }
+
+ private:
+  size_t saved_peak_ = 0;
+  size_t base_bytes_ = 0;
+};
+
+inline memory_info memory_stats() { return buffer_pool::instance().stats(); }
+
+inline size_t trim_pool(size_t max_cached_bytes = 0) {
+  return buffer_pool::instance().trim(max_cached_bytes);
+}
+
+//-----------------------------------------------------------------------------
+
 inline storage storage::make(size_t bytes) {
   auto& pool = buffer_pool::instance();
   auto* buf = pool.acquire(bytes);
@@ -78,4 +279,30 @@ inline storage storage::make(size_t bytes) {
   return s;
 }
 
+inline storage storage::adopt(void* ptr, size_t bytes,
+                              std::function<void()> release) {
+  auto page = static_cast<uintptr_t>(getpagesize());
+  auto addr = reinterpret_cast<uintptr_t>(ptr);
+  auto base = addr & ~(page - 1);
+  auto length = (addr + bytes - base + page - 1) & ~(page - 1);
+
+  // MTLResourceStorageModeShared = 0; a nil deallocator leaves the memory
+  // to `release`
+  auto* buf = objc::send(buffer_pool::instance().device,
+                         "newBufferWithBytesNoCopy:length:options:deallocator:",
+                         reinterpret_cast<void*>(base), size_t(length), 0ul,
+                         static_cast<void*>(nullptr));
+
+  storage s;
+  s.buf = std::shared_ptr<void>(ptr, [buf, release = std::move(release)](void*) {
+    if (buf) objc::release(buf);
+    if (release) release();
+  });
+  s.data = buf ? reinterpret_cast<void*>(base) : ptr;
+  s.mtl_buf = buf;
+  s.off = 0;
+  s.len = 0;
+  return s;
+}
+
 };  // namespace sil
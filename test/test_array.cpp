@@ -1,5 +1,9 @@
 #include <silarray.h>
 
+#include <sys/mman.h>
+
+#include <functional>
+#include <list>
 #include <ranges>
 
 #include "doctest.h"
@@ -60,6 +64,61 @@ TEST_CASE("array: vector ranges") {
   CHECK(array_equal(v, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
 }
 
+TEST_CASE("array: construction from iterators and ranges") {
+  // Matching contiguous sources are one memcpy; others convert element-wise
+  auto src = std::vector<float>{1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f};
+  CHECK(array_equal(array<float>({2, 3}, src.data()), {{1.5f, 2.5f, 3.5f}, {4.5f, 5.5f, 6.5f}}));
+  CHECK(array_equal(array<float>(src), {1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f}));
+  auto doubles = std::vector<double>{1, 2, 3};
+  CHECK(array_equal(array<float>({3}, doubles.begin()), {1, 2, 3}));
+  auto list = std::list<int>{4, 5, 6};
+  CHECK(array_equal(array<int>({3}, list), {4, 5, 6}));
+
+  // set() on a strided view still goes through the strides
+  auto m = array<int>({2, 2}, 0);
+  auto t = m.transpose();
+  t.set(std::vector<int>{1, 2, 3, 4}.begin());
+  CHECK(array_equal(m, {{1, 3}, {2, 4}}));
+}
+
+TEST_CASE("array: wrap external memory") {
+  auto page = static_cast<size_t>(getpagesize());
+  auto *mem = mmap(nullptr, page, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  REQUIRE(mem != MAP_FAILED);
+  auto *p = static_cast<float *>(mem);
+  for (size_t i = 0; i < 6; i++) p[i] = float(i);
+
+  int released = 0;
+  {
+    auto a = array<float>::wrap(p, {2, 3}, {}, [&](float *q) {
+      released++;
+      munmap(q, page);
+    });
+    CHECK(array_equal(a, {{0, 1, 2}, {3, 4, 5}}));
+    CHECK(a.sum() == 15.0f);
+    CHECK(array_equal(a + 1.0f, {{1, 2, 3}, {4, 5, 6}}));
+
+    // Column-major view of the same memory
+    auto c = array<float>::wrap(static_cast<const float *>(p), {3, 2}, {1, 3});
+    CHECK(array_equal(c, a.transpose()));
+
+    auto b = a;
+    a = array<float>();
+    CHECK(released == 0);
+    CHECK(b.at(5) == 5.0f);
+  }
+  CHECK(released == 1);
+
+  // An interior pointer keeps its offset within the mapped pages
+  auto buf = std::vector<float>(64, 1.0f);
+  auto w = array<float>::wrap(buf.data() + 3, {4});
+  CHECK(array_equal(w * 2.0f, {2, 2, 2, 2}));
+
+  CHECK_THROWS(array<float>::wrap(p, {2, 3}, {1}));
+  CHECK_THROWS(array<float>::wrap(static_cast<float *>(nullptr), {2}));
+}
+
 TEST_CASE("array: vector `clone`") {
   auto a = ones<float>({8});
   auto b = a;
@@ -546,6 +605,180 @@ TEST_CASE("array: layer_norm") {
   }
 }
 
+TEST_CASE("norm: layer_norm and rms_norm with backward") {
+  // Double-precision reference over the last axis: y = xhat * gamma (+ beta)
+  auto reference = [](const std::vector<double> &x, size_t cols,
+                      const array<float> &gamma, const array<float> *beta,
+                      bool rms) {
+    std::vector<double> y(x.size());
+    for (size_t r = 0; r < x.size() / cols; r++) {
+      const double *row = x.data() + r * cols;
+      double mu = 0, var = 0;
+      if (!rms) {
+        for (size_t c = 0; c < cols; c++) mu += row[c] / cols;
+      }
+      for (size_t c = 0; c < cols; c++) var += (row[c] - mu) * (row[c] - mu) / cols;
+      auto inv = 1.0 / std::sqrt(var + 1e-5);
+      for (size_t c = 0; c < cols; c++) {
+        y[r * cols + c] = (row[c] - mu) * inv * gamma.at(c) + (beta ? beta->at(c) : 0.0);
+      }
+    }
+    return y;
+  };
+  auto as_double = [](const array<float> &a) {
+    std::vector<double> v(a.element_count());
+    for (size_t i = 0; i < v.size(); i++) v[i] = a.at(i);
+    return v;
+  };
+
+  // Rows with a large common offset check the single-pass statistics
+  auto x = (sil::random({3, 4, 37}) - array<float>(0.5f)) * 4.0f + 100.0f;
+  auto gamma = sil::random({37}) + array<float>(0.5f);
+  auto beta = sil::random({37});
+  auto dout = sil::random({3, 4, 37}) - array<float>(0.5f);
+
+  for (auto rms : {false, true}) {
+    CAPTURE(rms);
+    norm_stats stats;
+    auto y = rms ? rms_norm(x, gamma, stats) : layer_norm(x, gamma, beta, stats);
+    REQUIRE(y.shape() == x.shape());
+    CHECK(stats.rstd.shape() == shape_type{12});
+    CHECK(stats.mean.dimension() == (rms ? 0u : 1u));
+
+    auto xd = as_double(x);
+    auto expected = reference(xd, 37, gamma, rms ? nullptr : &beta, rms);
+    for (size_t i = 0; i < expected.size(); i++) {
+      CHECK(y.at(i) == doctest::Approx(expected[i]).epsilon(1e-3));
+    }
+    if (rms) {
+      CHECK(allclose(y, rms_norm(x, gamma), 1e-6f));
+    } else {
+      auto flat = x.clone();
+      flat.reshape({12, 37});
+      auto member = flat.layer_norm(gamma, beta);
+      member.reshape({3, 4, 37});
+      CHECK(allclose(y, member, 1e-3f));
+    }
+
+    // dx of sum(dout * y) by central differences on a few elements
+    auto grads_dx = array<float>();
+    auto grads_dgamma = array<float>();
+    if (rms) {
+      auto g = rms_norm_backward(dout, x, gamma, stats);
+      grads_dx = g.dx;
+      grads_dgamma = g.dgamma;
+    } else {
+      auto g = layer_norm_backward(dout, x, gamma, stats);
+      grads_dx = g.dx;
+      grads_dgamma = g.dgamma;
+
+      auto dbeta = std::vector<double>(37, 0.0);
+      for (size_t i = 0; i < dout.element_count(); i++) dbeta[i % 37] += dout.at(i);
+      for (size_t c = 0; c < 37; c++) {
+        CHECK(g.dbeta.at(c) == doctest::Approx(dbeta[c]).epsilon(1e-4));
+      }
+    }
+    REQUIRE(grads_dx.shape() == x.shape());
+    auto loss = [&](const std::vector<double> &v) {
+      auto out = reference(v, 37, gamma, rms ? nullptr : &beta, rms);
+      double l = 0;
+      for (size_t i = 0; i < out.size(); i++) l += out[i] * dout.at(i);
+      return l;
+    };
+    for (size_t i : {0ul, 5ul, 36ul, 200ul, 443ul}) {
+      auto up = xd, down = xd;
+      up[i] += 1e-3;
+      down[i] -= 1e-3;
+      auto slope = (loss(up) - loss(down)) / 2e-3;
+      CHECK(grads_dx.at(i) == doctest::Approx(slope).epsilon(1e-2));
+    }
+
+    // dgamma = sum over rows of dout * xhat
+    auto ones = sil::ones<float>({37});
+    auto xhat = reference(xd, 37, ones, nullptr, rms);
+    for (size_t c = 0; c < 37; c++) {
+      double dg = 0;
+      for (size_t r = 0; r < 12; r++) dg += dout.at(r * 37 + c) * xhat[r * 37 + c];
+      CHECK(grads_dgamma.at(c) == doctest::Approx(dg).epsilon(1e-3));
+    }
+  }
+
+  // Enough rows to split dgamma/dbeta into per-chunk partial sums
+  auto big = sil::random({4096, 96});
+  auto big_gamma = sil::ones<float>({96});
+  auto big_dout = sil::random({4096, 96});
+  norm_stats stats;
+  layer_norm(big, big_gamma, sil::zeros<float>({96}), stats);
+  auto g = layer_norm_backward(big_dout, big, big_gamma, stats);
+  CHECK(allclose(g.dbeta, big_dout.sum(0), 1e-2f));
+  for (size_t r = 0; r < 4096; r += 511) {
+    CHECK(is_close(g.dx[r].sum(), 0.0f, 1e-3f));  // dx is orthogonal to 1
+  }
+
+  CHECK_THROWS(layer_norm(x, sil::ones<float>({36}), beta, stats));
+  auto flat_dout = dout.clone();
+  flat_dout.reshape({12, 37});
+  CHECK_THROWS(rms_norm_backward(flat_dout, x, gamma, stats));
+}
+
+TEST_CASE("loss: cross_entropy and mean_square_error") {
+  auto logits = array<float>{{2.0f, -1.0f, 0.5f, 0.0f},
+                             {100.0f, 99.0f, -50.0f, 98.0f},
+                             {0.0f, 0.0f, 0.0f, 0.0f}};
+  auto labels = array<int>{0, 3, 2};
+
+  // Reference: softmax probabilities and -log p[label], averaged over rows
+  double expected = 0;
+  auto probs = std::vector<double>(12);
+  for (size_t r = 0; r < 3; r++) {
+    double m = logits.at(r * 4), s = 0;
+    for (size_t c = 0; c < 4; c++) m = std::max<double>(m, logits.at(r * 4 + c));
+    for (size_t c = 0; c < 4; c++) s += std::exp(logits.at(r * 4 + c) - m);
+    for (size_t c = 0; c < 4; c++) probs[r * 4 + c] = std::exp(logits.at(r * 4 + c) - m) / s;
+    expected -= std::log(probs[r * 4 + labels.at(r)]) / 3;
+  }
+
+  auto ce = cross_entropy(logits, labels);
+  CHECK(ce.loss == doctest::Approx(expected).epsilon(1e-5));
+  REQUIRE(ce.grad.shape() == logits.shape());
+  for (size_t i = 0; i < 12; i++) {
+    auto onehot = (i % 4) == static_cast<size_t>(labels.at(i / 4)) ? 1.0 : 0.0;
+    CHECK(ce.grad.at(i) == doctest::Approx((probs[i] - onehot) / 3).epsilon(1e-5));
+  }
+  CHECK(cross_entropy(logits, labels, false).loss == ce.loss);
+  CHECK(cross_entropy(logits, labels, false).grad.dimension() == 0);
+
+  // Many rows: the row-parallel path agrees with the composed softmax
+  auto big = sil::random({8192, 10}) * 6.0f;
+  auto big_labels = array<int>({8192}, 0);
+  for (size_t i = 0; i < 8192; i++) big_labels.at(i) = static_cast<int>(i * 7 % 10);
+  auto p = big.softmax();
+  double composed = 0;
+  for (size_t i = 0; i < 8192; i++) composed -= std::log(p.at(i * 10 + big_labels.at(i)));
+  auto big_ce = cross_entropy(big, big_labels);
+  CHECK(big_ce.loss == doctest::Approx(composed / 8192).epsilon(1e-4));
+  CHECK(allclose(big_ce.grad, (p - big_labels.one_hot<float>(10)) / 8192.0f, 1e-6f));
+
+  CHECK_THROWS(cross_entropy(logits, array<int>{0, 4, 1}));
+  CHECK_THROWS(cross_entropy(logits, array<int>{0, 1}));
+
+  // MSE: value and gradient from one reduction, matching the composed form
+  auto a = sil::random({300, 7});
+  auto b = sil::random({300, 7});
+  auto mse = mean_square_error(a, b, true);
+  CHECK(mse.loss == doctest::Approx((a - b).pow(2).mean()).epsilon(1e-5));
+  CHECK(a.mean_square_error(b) == doctest::Approx(mse.loss).epsilon(1e-6));
+  CHECK(allclose(mse.grad, (a - b) * (2.0f / 2100.0f), 1e-6f));
+  CHECK(mean_square_error(a, b).grad.dimension() == 0);
+  CHECK(a.transpose().mean_square_error(b.transpose()) ==
+        doctest::Approx(mse.loss).epsilon(1e-6));
+  CHECK_THROWS(mean_square_error(a, b.transpose()));
+
+  // Empty inputs have no mean
+  CHECK_THROWS(cross_entropy(array<float>({0, 4}, 0.0f), array<int>({0}, 0)));
+  CHECK_THROWS(mean_square_error(array<float>({0}, 0.0f), array<float>({0}, 0.0f)));
+}
+
 TEST_CASE("array: softmax") {
   auto v = array<int>{1, 2, 3, 4, 5, 6};
   auto m = array<int>{{7, 8, 9}, {10, 11, 12}};
@@ -705,3 +938,1265 @@ TEST_CASE("msl: add float broadcast") {
   CHECK(array_equal(result, {11.0f, 12.0f, 13.0f, 14.0f}));
 }
 
+
+TEST_CASE("memory: stats, peak scope and trim") {
+  trim_pool();
+  auto before = memory_stats();
+  constexpr size_t bytes = 1024 * sizeof(float);
+
+  {
+    peak_memory_scope scope;
+    auto a = zeros<float>({1024});
+    auto b = zeros<float>({1024});
+    CHECK(scope.delta_bytes() >= 2 * bytes);
+    CHECK(memory_stats().live_bytes >= before.live_bytes + 2 * bytes);
+  }
+
+  auto after = memory_stats();
+  CHECK(after.live_bytes == before.live_bytes);
+  CHECK(after.cached_bytes >= 2 * bytes);
+  CHECK(after.peak_bytes >= before.live_bytes + 2 * bytes);
+
+  auto hits = after.pool_hits;
+  auto c = zeros<float>({1024});
+  CHECK(memory_stats().pool_hits == hits + 1);
+
+  auto stats = memory_stats();
+  auto it = std::ranges::find_if(stats.size_classes,
+                                 [](auto &sc) { return sc.bytes == bytes; });
+  CHECK(it != stats.size_classes.end());
+  CHECK(it->live >= 1);
+
+  CHECK(trim_pool() > 0);
+  CHECK(memory_stats().cached_bytes == 0);
+}
+
+TEST_CASE("cpu: kernel tiers agree") {
+  auto saved = cpu_features().tier;
+  CHECK(cpu_features().cores >= 1);
+
+  // Odd sizes exercise vector tails and GEMM edge tiles
+  auto a = sil::random({37, 29}) - sil::array<float>(0.5f);
+  auto b = sil::random({29, 41});
+  auto bias = sil::random({29});
+  auto beta = sil::zeros<float>({29});
+  size_t n = a.element_count();
+
+  auto run = [&](cpu_tier tier) {
+    use_cpu_tier(tier);
+    CHECK(cpu::kernels().tier == tier);
+    std::vector<float> out;
+    std::vector<float> tmp(n);
+
+    cpu::kernels().add(a.buffer_data(), n, bias.buffer_data(), 29, tmp.data(), n);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    cpu::kernels().div(a.buffer_data(), 1, bias.buffer_data(), 29, tmp.data(), 29);
+    out.insert(out.end(), tmp.begin(), tmp.begin() + 29);
+    cpu::sigmoid(a.buffer_data(), tmp.data(), n);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    cpu::relu(a.buffer_data(), tmp.data(), n);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    cpu::affine(a.buffer_data(), tmp.data(), n, 2.0f, -1.0f);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    std::vector<uint8_t> bytes(n);
+    for (size_t i = 0; i < n; i++) bytes[i] = static_cast<uint8_t>(i * 7);
+    cpu::kernels().u8_affine(bytes.data(), tmp.data(), n, 1.0f / 255, -0.5f);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+
+    // Unary ops, plain and with fused scalar arithmetic, on a positive copy
+    // so that log/sqrt/rsqrt stay finite
+    std::vector<float> pos(n);
+    for (size_t i = 0; i < n; i++) pos[i] = std::fabs(a.buffer_data()[i]) + 0.1f;
+    auto fused = unary_args{.scale = 1.5f, .offset = 0.25f, .post_scale = 2.0f,
+                            .post_offset = -1.0f, .lo = 0.3f, .hi = 0.6f};
+    for (auto op : {unary_op::exp, unary_op::log, unary_op::tanh,
+                    unary_op::gelu, unary_op::silu, unary_op::sqrt,
+                    unary_op::rsqrt, unary_op::abs, unary_op::clamp}) {
+      for (auto args : {unary_args{.lo = 0.3f, .hi = 0.6f}, fused}) {
+        cpu::unary(op, pos.data(), tmp.data(), n, args);
+        out.insert(out.end(), tmp.begin(), tmp.end());
+      }
+      cpu::unary_backward(op, a.buffer_data(), pos.data(), tmp.data(), n, fused);
+      out.insert(out.end(), tmp.begin(), tmp.end());
+    }
+    cpu::softmax(a.buffer_data(), tmp.data(), 37, 29);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    std::vector<float> stats(2 * 37), dgamma(2 * 29);
+    cpu::layer_norm(a.buffer_data(), tmp.data(), bias.buffer_data(),
+                    beta.buffer_data(), 37, 29, 1e-5f, stats.data(),
+                    stats.data() + 37);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    out.insert(out.end(), stats.begin(), stats.end());
+    cpu::layer_norm_backward(b.buffer_data(), a.buffer_data(), stats.data(),
+                             stats.data() + 37, bias.buffer_data(), tmp.data(),
+                             dgamma.data(), dgamma.data() + 29, 37, 29);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    out.insert(out.end(), dgamma.begin(), dgamma.end());
+    cpu::rms_norm(a.buffer_data(), tmp.data(), bias.buffer_data(), 37, 29,
+                  1e-5f, stats.data());
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    cpu::rms_norm_backward(b.buffer_data(), a.buffer_data(), stats.data(),
+                           bias.buffer_data(), tmp.data(), dgamma.data(), 37, 29);
+    out.insert(out.end(), tmp.begin(), tmp.end());
+    out.insert(out.end(), dgamma.begin(), dgamma.begin() + 29);
+    std::vector<int> labels(37);
+    for (size_t i = 0; i < 37; i++) labels[i] = static_cast<int>(i % 29);
+    out.push_back(cpu::kernels().cross_entropy(a.buffer_data(), labels.data(),
+                                               tmp.data(), 37, 29, 0.5f));
+    out.insert(out.end(), tmp.begin(), tmp.begin() + 37 * 29);
+    out.push_back(cpu::kernels().squared_error(a.buffer_data(), b.buffer_data(),
+                                               tmp.data(), n, 2.0f));
+    out.insert(out.end(), tmp.begin(), tmp.begin() + n);
+    for (auto op : {scan_op::sum, scan_op::logaddexp}) {
+      out.push_back(cpu::kernels().scan(op, a.buffer_data(), tmp.data(), n, 0.5f));
+      out.insert(out.end(), tmp.begin(), tmp.begin() + n);
+    }
+    out.push_back(cpu::kernels().scan(scan_op::prod, pos.data(), tmp.data(), 29, 2.0f));
+    out.insert(out.end(), tmp.begin(), tmp.begin() + 29);
+    out.push_back(cpu::sum<float>(a.buffer_data(), n));
+    out.push_back(cpu::min(a.buffer_data(), n));
+    out.push_back(cpu::max(a.buffer_data(), n));
+
+    std::vector<float> c(37 * 41);
+    cpu::sgemm(false, false, 37, 41, 29, a.buffer_data(), 29, b.buffer_data(),
+               41, c.data(), 41);
+    out.insert(out.end(), c.begin(), c.end());
+    // A * A^T through the transposed-B packing path
+    cpu::sgemm(false, true, 37, 37, 29, a.buffer_data(), 29, a.buffer_data(),
+               29, c.data(), 37);
+    out.insert(out.end(), c.begin(), c.begin() + 37 * 37);
+    return out;
+  };
+
+  auto expected = run(cpu_tier::accelerate);
+  for (auto tier : {cpu_tier::scalar, cpu_tier::neon}) {
+    auto actual = run(tier);
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+      CHECK(actual[i] == doctest::Approx(expected[i]).epsilon(1e-4));
+    }
+  }
+
+  use_cpu_tier(saved);
+}
+
+TEST_CASE("tuning: cache round trip") {
+  auto path = std::filesystem::temp_directory_path() / "sil_tuning_test.txt";
+
+  tuning_params p;
+  p.neon_affine_threshold = 123456;
+  p.steel_min_dim = 32;
+  p.gemm_kc = 512;
+  CHECK(save_tuning(p, path));
+
+  tuning_params q;
+  CHECK(load_tuning(q, path));
+  CHECK(q.neon_affine_threshold == 123456);
+  CHECK(q.steel_min_dim == 32);
+  CHECK(q.gemm_kc == 512);
+  CHECK(q.parallel_threshold == tuning_params{}.parallel_threshold);
+
+  // Other versions are ignored
+  {
+    std::ofstream out(path);
+    out << "sil-tuning " << kTuningCacheVersion + 1 << "\n";
+  }
+  tuning_params r;
+  CHECK_FALSE(load_tuning(r, path));
+  CHECK(r.neon_affine_threshold == tuning_params{}.neon_affine_threshold);
+
+  std::filesystem::remove(path);
+  CHECK_FALSE(load_tuning(r, path));
+}
+
+TEST_CASE("conv: conv2d matches direct sum") {
+  // 1 image, 2 channels, 4x4, two 3x3 filters, padding 1
+  auto x = array<float>({1, 2, 4, 4}, itoa(32));
+  auto w = array<float>({2, 2, 3, 3}, 0.0f);
+  w.at({0, 0, 1, 1}) = 1.0f;   // identity on channel 0
+  w.at({1, 1, 0, 0}) = 2.0f;   // 2 * channel 1 shifted by (-1, -1)
+
+  auto b = array<float>{0.5f, -1.0f};
+  auto y = conv2d(x, w, b, {.pad_h = 1, .pad_w = 1});
+  CHECK(y.shape() == shape_type{1, 2, 4, 4});
+  CHECK(y.at({0, 0, 2, 3}) == doctest::Approx(x.at({0, 0, 2, 3}) + 0.5f));
+  CHECK(y.at({0, 1, 0, 0}) == doctest::Approx(-1.0f));
+  CHECK(y.at({0, 1, 2, 3}) == doctest::Approx(2.0f * x.at({0, 1, 1, 2}) - 1.0f));
+
+  // Same convolution in NHWC via im2col (stride 2)
+  auto x_nhwc = array<float>({1, 4, 4, 2}, 0.0f);
+  for (size_t c = 0; c < 2; c++)
+    for (size_t h = 0; h < 4; h++)
+      for (size_t v = 0; v < 4; v++) x_nhwc.at({0, h, v, c}) = x.at({0, c, h, v});
+  conv2d_params p{.stride_h = 2, .stride_w = 2, .pad_h = 1, .pad_w = 1,
+                  .layout = data_layout::nhwc};
+  auto y2 = conv2d(x_nhwc, w, b, p);
+  CHECK(y2.shape() == shape_type{1, 2, 2, 2});
+  for (size_t c = 0; c < 2; c++)
+    for (size_t h = 0; h < 2; h++)
+      for (size_t v = 0; v < 2; v++)
+        CHECK(y2.at({0, h, v, c}) == doctest::Approx(y.at({0, c, h * 2, v * 2})));
+
+  CHECK_THROWS(conv2d(x, w, {.groups = 3}));
+}
+
+TEST_CASE("conv: conv2d backward matches finite differences") {
+  auto x = sil::random({2, 4, 5, 5}) - sil::array<float>(0.5f);
+  auto w = sil::random({6, 2, 3, 3}) - sil::array<float>(0.5f);
+  conv2d_params p{.stride_h = 2, .stride_w = 1, .pad_h = 1, .pad_w = 1,
+                  .dilation_h = 1, .dilation_w = 2, .groups = 2};
+
+  // loss = sum(conv2d(x, w)) → dout = ones
+  auto y = conv2d(x, w, p);
+  auto g = conv2d_backward(sil::ones<float>(y.shape()), x, w, p);
+  CHECK(g.dx.shape() == x.shape());
+  CHECK(g.dw.shape() == w.shape());
+  CHECK(g.db.element_count() == 6);
+  CHECK(g.db.at(0) == doctest::Approx(float(y.element_count() / 6)));
+
+  auto loss = [&](const array<float> &xx, const array<float> &ww) {
+    return conv2d(xx, ww, p).sum();
+  };
+  constexpr float h = 1e-2f;
+  for (size_t i : {0, 7, 33, 99}) {
+    auto xp = x.clone(), xm = x.clone();
+    xp.at(i) += h;
+    xm.at(i) -= h;
+    CHECK(g.dx.at(i) == doctest::Approx((loss(xp, w) - loss(xm, w)) / (2 * h)).epsilon(1e-2));
+  }
+  for (size_t i : {0, 5, 17, 53}) {
+    auto wp = w.clone(), wm = w.clone();
+    wp.at(i) += h;
+    wm.at(i) -= h;
+    CHECK(g.dw.at(i) == doctest::Approx((loss(x, wp) - loss(x, wm)) / (2 * h)).epsilon(1e-2));
+  }
+}
+
+TEST_CASE("conv: max and avg pooling") {
+  auto x = array<float>({1, 1, 4, 4}, itoa(16));
+
+  auto m = max_pool2d(x);
+  CHECK(m.shape() == shape_type{1, 1, 2, 2});
+  CHECK(array_equal(array<float>({4}, m.buffer_data()), {6.0f, 8.0f, 14.0f, 16.0f}));
+
+  auto a = avg_pool2d(x);
+  CHECK(allclose(array<float>({4}, a.buffer_data()), {3.5f, 5.5f, 11.5f, 13.5f}));
+
+  auto dm = max_pool2d_backward(sil::ones<float>(m.shape()), x);
+  CHECK(dm.sum() == doctest::Approx(4.0f));
+  CHECK(dm.at(5) == 1.0f);
+  CHECK(dm.at(0) == 0.0f);
+
+  auto da = avg_pool2d_backward(sil::ones<float>(a.shape()), x);
+  CHECK(da.all(0.25f));
+
+  // Overlapping windows (stride < kernel)
+  pool2d_params p{.kernel_h = 3, .kernel_w = 3, .stride_h = 1, .stride_w = 1};
+  auto dm2 = max_pool2d_backward(sil::ones<float>({1, 1, 2, 2}), x, p);
+  CHECK(dm2.at(15) == 1.0f);
+  CHECK(dm2.sum() == doctest::Approx(4.0f));
+}
+
+TEST_CASE("conv: strided views match their packed copies") {
+  auto check = [](const array<float> &x, const array<float> &w,
+                  const array<float> &b) {
+    REQUIRE(!x.is_contiguous());
+    REQUIRE(!w.is_contiguous());
+
+    conv2d_params p{.pad_h = 1, .pad_w = 1};
+    auto y = conv2d(x, w, b, p);
+    CHECK(array_equal(y, conv2d(x.clone(), w.clone(), b.clone(), p)));
+    CHECK(array_equal(conv2d(x, w), conv2d(x.clone(), w.clone())));
+
+    // Width slice of a wider gradient
+    auto ys = y.shape();
+    auto dout = sil::random({ys[0], ys[1], ys[2], ys[3] + 3}).slice(3, 2, ys[3] + 2);
+    auto g = conv2d_backward(dout, x, w, p);
+    auto gc = conv2d_backward(dout.clone(), x.clone(), w.clone(), p);
+    CHECK(array_equal(g.dx, gc.dx));
+    CHECK(array_equal(g.dw, gc.dw));
+    CHECK(array_equal(g.db, gc.db));
+
+    auto m = max_pool2d(x);
+    CHECK(array_equal(m, max_pool2d(x.clone())));
+    CHECK(array_equal(avg_pool2d(x), avg_pool2d(x.clone())));
+
+    auto ms = m.shape();
+    auto dm = sil::random({1, ms[1], ms[2], ms[3]}).broadcast(ms);
+    CHECK(array_equal(max_pool2d_backward(dm, x),
+                      max_pool2d_backward(dm.clone(), x.clone())));
+    CHECK(array_equal(avg_pool2d_backward(dm, x),
+                      avg_pool2d_backward(dm.clone(), x.clone())));
+  };
+
+  // Batch broadcasts are stride-0 views over a single image
+  check(sil::random({1, 3, 6, 5}).broadcast({2, 3, 6, 5}),
+        sil::random({1, 3, 3, 3}).broadcast({4, 3, 3, 3}), sil::random({4}));
+
+  // Width slices are strided views of wider arrays
+  auto b = sil::random({4, 2}).slice(1, 1, 2);
+  REQUIRE(!b.is_contiguous());
+  check(sil::random({2, 3, 6, 7}).slice(3, 1, 6),
+        sil::random({4, 3, 3, 5}).slice(3, 1, 4), b);
+}
+
+TEST_CASE("attention: matches composed softmax(QKᵀ)V") {
+  auto Q = sil::random({37, 16}) - sil::array<float>(0.5f);
+  auto K = sil::random({70, 16}) - sil::array<float>(0.5f);
+  auto V = sil::random({70, 8}) - sil::array<float>(0.5f);
+  auto scale = 0.25f;
+
+  auto ref = (Q.dot(K.transpose()) * scale).softmax().dot(V);
+  auto out = scaled_dot_product_attention(Q, K, V);
+  CHECK(out.shape() == shape_type{37, 8});
+  CHECK(allclose(out, ref, 1e-4f));
+
+  // Naive reference with a causal mask and an additive bias
+  auto naive = [](const float *q, const float *k, const float *v,
+                  const float *bias, bool causal, size_t sq, size_t sk,
+                  size_t d, size_t dv, float scale, float *o) {
+    for (size_t i = 0; i < sq; i++) {
+      std::vector<float> s(sk, -INFINITY);
+      auto m = -INFINITY;
+      for (size_t j = 0; j < sk; j++) {
+        if (causal && j > sk - sq + i) continue;
+        auto dot = 0.0f;
+        for (size_t c = 0; c < d; c++) dot += q[i * d + c] * k[j * d + c];
+        s[j] = dot * scale + (bias ? bias[i * sk + j] : 0.0f);
+        m = std::max(m, s[j]);
+      }
+      auto l = 0.0f;
+      for (auto &x : s) l += (x = std::exp(x - m));
+      for (size_t c = 0; c < dv; c++) {
+        auto acc = 0.0f;
+        for (size_t j = 0; j < sk; j++) acc += s[j] * v[j * dv + c];
+        o[i * dv + c] = acc / l;
+      }
+    }
+  };
+
+  // 3 heads, decoding-style causal offset (seq_k > seq_q), per-head bias
+  constexpr size_t H = 3, SQ = 33, SK = 130, D = 8, DV = 12;
+  auto Q3 = sil::random({H, SQ, D}) - sil::array<float>(0.5f);
+  auto K3 = sil::random({H, SK, D}) - sil::array<float>(0.5f);
+  auto V3 = sil::random({H, SK, DV}) - sil::array<float>(0.5f);
+  auto bias = sil::random({H, SQ, SK});
+  auto expected = array<float>({H, SQ, DV}, 0.0f);
+  for (size_t h = 0; h < H; h++) {
+    naive(Q3.buffer_data() + h * SQ * D, K3.buffer_data() + h * SK * D,
+          V3.buffer_data() + h * SK * DV, bias.buffer_data() + h * SQ * SK,
+          true, SQ, SK, D, DV, scale, expected.buffer_data() + h * SQ * DV);
+  }
+
+  attention_mask mask(bias);
+  mask.is_causal = true;
+  auto out3 = scaled_dot_product_attention(Q3, K3, V3, mask, scale);
+  CHECK(out3.shape() == shape_type{H, SQ, DV});
+  CHECK(allclose(out3, expected, 1e-4f));
+
+  // Causal only, 2D, default scale: the first query sees only the first key
+  auto out_c = scaled_dot_product_attention(Q, Q, Q, attention_mask::causal());
+  for (size_t c = 0; c < 16; c++) CHECK(out_c.at({0, c}) == doctest::Approx(Q.at({0, c})));
+  CHECK_THROWS(scaled_dot_product_attention(K, Q, Q, attention_mask::causal()));
+  CHECK_THROWS(scaled_dot_product_attention(Q, K, Q));
+}
+
+TEST_CASE("kv_cache: append, prefix views and paged attention") {
+  constexpr size_t D = 8, N = 45;
+  auto K = sil::random({N, D}) - sil::array<float>(0.5f);
+  auto V = sil::random({N, D}) - sil::array<float>(0.5f);
+  auto Q = sil::random({N, D}) - sil::array<float>(0.5f);
+
+  // Contiguous: the prefix is a view into the preallocated block
+  kv_cache cache(64, D);
+  cache.append(K.rows(0, 40), V.rows(0, 40));
+  cache.append(K.rows(40, N), V.rows(40, N));
+  CHECK(cache.size() == N);
+  CHECK(cache.capacity() == 64);
+  auto keys = cache.keys();
+  CHECK(keys.shape() == shape_type{N, D});
+  CHECK(array_equal(keys, K));
+  CHECK(array_equal(cache.values(), V));
+  CHECK(cache.keys().buffer_data() == keys.buffer_data());
+  CHECK_THROWS(cache.append(sil::zeros<float>({20, D}), sil::zeros<float>({20, D})));
+
+  auto expected = scaled_dot_product_attention(Q, K, V, attention_mask::causal());
+  CHECK(allclose(cache.attention(Q), expected, 1e-4f));
+
+  // Decoding step: the last query against every cached key
+  auto last = scaled_dot_product_attention(Q.rows(N - 1, N), K, V);
+  CHECK(allclose(cache.attention(Q.rows(N - 1, N)), last, 1e-4f));
+
+  // Paged: two sequences share one pool of 16-row blocks
+  auto pool = std::make_shared<kv_block_pool>(16, 6, D);
+  {
+    kv_cache a(pool, N), b(pool, N);
+    for (size_t i = 0; i < N; i++) {
+      a.append(K.rows(i, i + 1), V.rows(i, i + 1));
+      if (i < 20) b.append(V.rows(i, i + 1), K.rows(i, i + 1));
+    }
+    CHECK(a.block_count() == 3);
+    CHECK(b.block_count() == 2);
+    CHECK(pool->free_blocks() == 1);
+    CHECK(array_equal(a.keys(), K));
+    CHECK(array_equal(b.values(), K.rows(0, 20)));
+    CHECK(allclose(a.attention(Q), expected, 1e-4f));
+    CHECK_THROWS(kv_cache(pool, N).append(K.rows(0, 33), V.rows(0, 33)));
+
+    // An append the pool can't cover hands back the blocks it took
+    kv_cache c(pool, N);
+    CHECK_THROWS(c.append(K.rows(0, 33), V.rows(0, 33)));
+    CHECK(c.size() == 0);
+    CHECK(c.block_count() == 0);
+    CHECK(pool->free_blocks() == 1);
+
+    // Moved-from: empty, keeps dim(), refuses new rows
+    kv_cache moved(std::move(b));
+    CHECK(moved.size() == 20);
+    CHECK(b.size() == 0);
+    CHECK(b.capacity() == 0);
+    CHECK(b.dim() == D);
+    CHECK_THROWS(b.append(K.rows(0, 1), V.rows(0, 1)));
+    CHECK_THROWS(b.attention(Q.rows(0, 1)));
+  }
+  CHECK(pool->free_blocks() == 6);
+}
+
+TEST_CASE("indexing: take, index_select and embedding") {
+  auto a = array<float>({3, 4}, itoa(12));
+  auto ids = array<int>({2, 2}, std::vector<int>{11, 0, 5, 5}.data());
+
+  auto t = take(a, ids);
+  CHECK(t.shape() == shape_type{2, 2});
+  CHECK(array_equal(t, array<float>({2, 2}, std::vector<float>{12, 1, 6, 6}.data())));
+
+  auto rows = index_select(a, 0, array<int>{2, 0, 2});
+  CHECK(rows.shape() == shape_type{3, 4});
+  CHECK(array_equal(rows[0], a[2]));
+  CHECK(array_equal(rows[1], a[0]));
+
+  auto cols = index_select(a, 1, array<int>{3, 1});
+  CHECK(array_equal(cols, array<float>({3, 2}, std::vector<float>{4, 2, 8, 6, 12, 10}.data())));
+
+  // Transposed input goes through a contiguous copy
+  auto tc = index_select(a.transpose(), 0, array<int>{1});
+  CHECK(array_equal(tc, array<float>({1, 3}, std::vector<float>{2, 6, 10}.data())));
+
+  auto e = embedding(a, array<int>({2, 2}, std::vector<int>{2, 0, 1, 1}.data()));
+  CHECK(e.shape() == shape_type{2, 2, 4});
+  CHECK(e.at({0, 1, 3}) == 4.0f);
+  CHECK(e.at({1, 0, 2}) == 7.0f);
+
+  CHECK_THROWS(take(a, array<int>{12}));
+  CHECK_THROWS(index_select(a, 2, array<int>{0}));
+  CHECK_THROWS(embedding(a, array<int>{-1}));
+}
+
+TEST_CASE("indexing: gather and scatter_add") {
+  auto logits = array<float>({3, 4}, itoa(12));
+  auto labels = array<int>({3, 1}, std::vector<int>{2, 0, 3}.data());
+
+  auto picked = gather(logits, 1, labels);
+  CHECK(picked.shape() == shape_type{3, 1});
+  CHECK(array_equal(picked, array<float>({3, 1}, std::vector<float>{3, 5, 12}.data())));
+
+  // Repeated indices accumulate
+  auto g = scatter_add(sil::zeros<float>({3, 4}), 1,
+                       array<int>({3, 2}, std::vector<int>{1, 1, 0, 3, 2, 2}.data()),
+                       sil::ones<float>({3, 2}));
+  CHECK(g.at({0, 1}) == 2.0f);
+  CHECK(g.at({1, 0}) == 1.0f);
+  CHECK(g.at({1, 3}) == 1.0f);
+  CHECK(g.sum() == doctest::Approx(6.0f));
+
+  // 1D scatter large enough to run partitioned across threads
+  constexpr size_t N = 1 << 17, M = 1000;
+  std::vector<int> idx(N);
+  for (size_t i = 0; i < N; i++) idx[i] = static_cast<int>(i % M);
+  auto s = scatter_add(sil::zeros<float>({M}), 0, array<int>({N}, idx.data()),
+                       sil::ones<float>({N}));
+  for (size_t i = 0; i < M; i += 97) {
+    CHECK(s.at(i) == float(N / M + (i < N % M ? 1 : 0)));
+  }
+
+  // embedding_backward sums dout rows per id
+  auto ids = array<int>{1, 3, 1};
+  auto dout = array<float>({3, 2}, itoa(6));
+  auto dt = embedding_backward(dout, ids, 4);
+  CHECK(dt.shape() == shape_type{4, 2});
+  CHECK(array_equal(dt, array<float>({4, 2}, std::vector<float>{0, 0, 6, 8, 0, 0, 3, 4}.data())));
+}
+
+TEST_CASE("concat: rows and slice views of one array") {
+  auto a = array<float>({4, 3}, itoa(12));
+
+  auto r = a.rows(1, 3);
+  CHECK(r.shape() == shape_type{2, 3});
+  CHECK(array_equal(r, a.slice(0, 1, 3)));
+  CHECK(array_equal(r.clone(), array<float>({2, 3}, itoa(6, 4))));
+
+  // A column slice of the row view walks the parent's strides
+  auto col = r.slice(1, 2, 3);
+  CHECK(col.shape() == shape_type{2, 1});
+  CHECK(array_equal(col.clone(), array<float>({2, 1}, std::vector<float>{6, 9}.data())));
+
+  a.at(4) = 100.0f;
+  CHECK(r.at(1) == 100.0f);
+  CHECK_THROWS(a.slice(1, 2, 4));
+  CHECK_THROWS(a.rows(3, 5));
+}
+
+TEST_CASE("concat: concat, stack, split and chunk") {
+  auto a = array<float>({2, 3}, itoa(6));
+  auto b = array<float>({1, 3}, itoa(3, 7));
+  auto c = array<float>({2, 2}, itoa(4, 10));
+
+  auto rows = concat({a, b});
+  CHECK(rows.shape() == shape_type{3, 3});
+  CHECK(array_equal(rows, array<float>({3, 3}, itoa(9))));
+
+  auto cols = concat({a, c}, 1);
+  CHECK(cols.shape() == shape_type{2, 5});
+  CHECK(array_equal(cols, array<float>({2, 5}, std::vector<float>{1, 2, 3, 10, 11, 4, 5, 6, 12, 13}.data())));
+
+  // Transposed inputs and a preallocated destination
+  auto dst = sil::zeros<float>({3, 3});
+  concat_into(dst, {a.transpose(), array<float>({3, 1}, itoa(3, 7))}, 1);
+  CHECK(array_equal(dst[0], array<float>{1, 4, 7}));
+  CHECK(array_equal(dst[2], array<float>{3, 6, 9}));
+
+  auto s = stack({a, a * 2.0f}, 1);
+  CHECK(s.shape() == shape_type{2, 2, 3});
+  CHECK(s.at({1, 1, 2}) == 12.0f);
+  CHECK(s.at({0, 0, 1}) == 2.0f);
+
+  // Splits are views into the original storage
+  auto parts = split(cols, {3, 2}, 1);
+  CHECK(parts.size() == 2);
+  CHECK(parts[1].shape() == shape_type{2, 2});
+  CHECK(array_equal(parts[1], c));
+  CHECK(array_equal(parts[0].clone(), a));
+  CHECK(array_equal(parts[0].dot(sil::ones<float>({3, 1})),
+                    array<float>({2, 1}, std::vector<float>{6, 15}.data())));
+  cols.at(3) = 100.0f;
+  CHECK(parts[1].at(0) == 100.0f);
+
+  auto heads = chunk(array<float>({2, 4, 3}, itoa(24)), 2, 1);
+  CHECK(heads[1].shape() == shape_type{2, 2, 3});
+  CHECK(heads[1].at({1, 0, 0}) == 19.0f);
+  CHECK(array_equal(concat(heads, 1), array<float>({2, 4, 3}, itoa(24))));
+
+  CHECK_THROWS(concat({a, c}));
+  CHECK_THROWS(split(a, {1, 2}));
+  CHECK_THROWS(stack({a, b}));
+}
+
+TEST_CASE("concat: strided views in arithmetic and reductions") {
+  auto cols = array<float>({2, 5}, itoa(10));
+  auto parts = split(cols, {3, 2}, 1);
+  auto v = parts[0];
+  auto p = v.clone();
+  auto w = array<float>({2, 3}, itoa(6, 20));
+
+  CHECK(!v.is_contiguous());
+  CHECK(array_equal(v + w, p + w));
+  CHECK(array_equal(w - v, w - p));
+  CHECK(array_equal(v * v, p * p));
+  CHECK(array_equal(v / 2.0f, p / 2.0f));
+  CHECK(array_equal(v + array<float>{1, 2, 3}, p + array<float>{1, 2, 3}));
+
+  CHECK(v.sum() == p.sum());
+  CHECK(array_equal(v.sum(0), p.sum(0)));
+  CHECK(v.min() == p.min());
+  CHECK(v.max() == p.max());
+  CHECK(array_equal(v.softmax(), p.softmax()));
+  CHECK(array_equal(v.argmax(), p.argmax()));
+  CHECK(array_equal(v.relu(), p.relu()));
+
+  // In-place ops on a strided view rebind it rather than write through
+  v += w;
+  CHECK(array_equal(v, p + w));
+  CHECK(cols.at(0) == 1.0f);
+}
+
+TEST_CASE("sort: topk, sort and argsort") {
+  auto a = array<float>{{3, 1, 4, 1, 5}, {9, 2, 6, 5, 3}};
+
+  auto t = topk(a, 2, 1);
+  CHECK(array_equal(t.values, array<float>{{5, 4}, {9, 6}}));
+  CHECK(array_equal(t.indices, array<int>{{4, 2}, {0, 2}}));
+
+  // Ties keep the earlier position; smallest-k works the same way
+  auto low = topk(a, 3, 1, false);
+  CHECK(array_equal(low.values, array<float>{{1, 1, 3}, {2, 3, 5}}));
+  CHECK(array_equal(low.indices, array<int>{{1, 3, 0}, {1, 4, 3}}));
+
+  CHECK(array_equal(sort(a, 1), array<float>{{1, 1, 3, 4, 5}, {2, 3, 5, 6, 9}}));
+  CHECK(array_equal(argsort(a, 1, true), array<int>{{4, 2, 0, 1, 3}, {0, 2, 3, 4, 1}}));
+  CHECK(array_equal(argsort(a, 0), array<int>{{0, 0, 0, 0, 1}, {1, 1, 1, 1, 0}}));
+
+  // Inner axis of a 3D array, through a transposed view
+  auto c = array<int>({2, 3, 2}, std::vector<int>{5, 0, 2, 7, 9, 1, 4, 4, 8, 3, 6, 2}.data());
+  auto cs = sort(c, 1, true);
+  CHECK(array_equal(cs, array<int>({2, 3, 2}, std::vector<int>{9, 7, 5, 1, 2, 0, 8, 4, 6, 3, 4, 2}.data())));
+  CHECK(array_equal(sort(a.transpose(), 0), sort(a, 1).transpose().clone()));
+
+  // NaN ranks above every number
+  auto n = array<float>{2.0f, NAN, -1.0f, 7.0f};
+  CHECK(topk(n, 1, 0).indices.at(0) == 1);
+  CHECK(array_equal(argsort(n, 0), array<int>{2, 0, 3, 1}));
+
+  // Row-parallel path and both selection strategies against std::sort
+  auto logits = sil::random({2000, 300});
+  for (size_t k : {5ul, 64ul, 300ul}) {
+    CAPTURE(k);
+    auto big = topk(logits, k, 1);
+    REQUIRE(big.values.shape() == shape_type{2000, k});
+    for (size_t r = 0; r < 2000; r += 97) {
+      std::vector<float> row(300);
+      for (size_t c = 0; c < 300; c++) row[c] = logits.at(r * 300 + c);
+      std::sort(row.begin(), row.end(), std::greater<>());
+      for (size_t j = 0; j < k; j++) {
+        CHECK(big.values.at(r * k + j) == row[j]);
+        CHECK(logits.at(r * 300 + big.indices.at(r * k + j)) == row[j]);
+      }
+    }
+  }
+  CHECK(array_equal(topk(logits, 300, 1).values, sort(logits, 1, true)));
+
+  CHECK_THROWS(topk(a, 0, 1));
+  CHECK_THROWS(topk(a, 6, 1));
+  CHECK_THROWS(sort(a, 2));
+}
+
+TEST_CASE("scan: cumsum, cumprod and logcumsumexp") {
+  auto a = array<float>{{1, 2, 3}, {4, 5, 6}};
+  CHECK(array_equal(cumsum(a, 1), array<float>{{1, 3, 6}, {4, 9, 15}}));
+  CHECK(array_equal(cumsum(a, 0), array<float>{{1, 2, 3}, {5, 7, 9}}));
+  CHECK(array_equal(cumprod(a, 1), array<float>{{1, 2, 6}, {4, 20, 120}}));
+  CHECK(array_equal(cumprod(a, 0), array<float>{{1, 2, 3}, {4, 10, 18}}));
+  CHECK(array_equal(cumsum(a.transpose(), 1), cumsum(a, 0).transpose().clone()));
+
+  // Middle axis of a 3D int array
+  auto c = array<int>({2, 3, 2}, std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}.data());
+  CHECK(array_equal(cumsum(c, 1), array<int>({2, 3, 2}, std::vector<int>{1, 2, 4, 6, 9, 12, 7, 8, 16, 18, 27, 30}.data())));
+  CHECK(array_equal(cumprod(c, 2), array<int>({2, 3, 2}, std::vector<int>{1, 2, 3, 12, 5, 30, 7, 56, 9, 90, 11, 132}.data())));
+
+  // logcumsumexp matches log(cumsum(exp)) and stays finite where exp overflows
+  auto l = logcumsumexp(a, 1);
+  for (size_t r = 0; r < 2; r++) {
+    double s = 0;
+    for (size_t j = 0; j < 3; j++) {
+      s += std::exp(double(a.at(r * 3 + j)));
+      CHECK(l.at(r * 3 + j) == doctest::Approx(std::log(s)));
+    }
+  }
+  auto big = logcumsumexp(array<float>{1000, 1000, -INFINITY, 999}, 0);
+  CHECK(big.at(0) == 1000.0f);
+  CHECK(big.at(1) == doctest::Approx(1000.0 + std::log(2.0)));
+  CHECK(big.at(2) == big.at(1));
+  CHECK(big.at(3) == doctest::Approx(1000.0 + std::log(2.0 + std::exp(-1.0))));
+
+  // A long line goes through the reduce-then-scan chunks, a wide slice
+  // through several column blocks; both must agree with a serial scan
+  auto ones = array<int>({1 << 20}, 1);
+  auto counts = cumsum(ones, 0);
+  bool ok = true;
+  for (size_t i = 0; i < (1 << 20); i++) ok = ok && counts.at(i) == int(i + 1);
+  CHECK(ok);
+  auto wide = sil::random({3, 5000});
+  auto ws = cumsum(wide, 0);
+  for (size_t j = 0; j < 5000; j += 499) {
+    CHECK(ws.at(2 * 5000 + j) == doctest::Approx(wide.at(j) + wide.at(5000 + j) + wide.at(2 * 5000 + j)));
+  }
+  auto lf = sil::random({1 << 20});
+  auto lc = cumsum(lf, 0);
+  double s = 0;
+  for (size_t i = 0; i < (1 << 20); i++) s += lf.at(i);
+  CHECK(lc.at((1 << 20) - 1) == doctest::Approx(s).epsilon(1e-3));
+
+  CHECK_THROWS(cumsum(a, 2));
+}
+
+TEST_CASE("sparse: csr construction and products") {
+  auto d = array<float>{{0, 2, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 3}};
+  auto s = csr_array<float>(d);
+  CHECK(s.shape() == shape_type{3, 4});
+  CHECK(s.nnz() == 3);
+  CHECK(s.row_offsets() == std::vector<size_t>{0, 1, 1, 3});
+  CHECK(s.col_indices() == std::vector<int>{1, 0, 3});
+  CHECK(array_equal(s.to_dense(), d));
+
+  // Unordered COO triplets; the duplicate (2, 3) entries are summed
+  auto coo = csr_array<float>(3, 4, array<int>{2, 0, 2, 2}, array<int>{3, 1, 0, 3},
+                              array<float>{1, 2, 1, 2});
+  CHECK(coo.col_indices() == s.col_indices());
+  CHECK(coo.values() == s.values());
+  CHECK(array_equal(s.transpose().to_dense(), d.transpose().clone()));
+
+  auto x = array<float>{1, 2, 3, 4};
+  CHECK(array_equal(spmv(s, x), array<float>{4, 0, 13}));
+  CHECK(array_equal(spmv(s, array<float>{1, 2, 3}, true), array<float>{3, 2, 0, 9}));
+  auto b = array<float>{{1, 0}, {0, 1}, {2, 2}, {1, -1}};
+  CHECK(array_equal(spmm(s, b), d.dot(b)));
+  auto dy = array<float>{{1, 2}, {3, 4}, {5, 6}};
+  CHECK(array_equal(spmm(s, dy, true), d.transpose().dot(dy)));
+
+  // Large enough to split rows across cores, with a few dense rows that the
+  // nnz-balanced partition has to spread out
+  auto big = sil::random({2000, 512});
+  float *bp = big.buffer_data();
+  for (size_t i = 0; i < big.element_count(); i++) {
+    if (i / 512 == 7) {
+      bp[i] = 0.125f;
+    } else if (bp[i] < 0.99f) {
+      bp[i] = 0.0f;
+    }
+  }
+  auto sb = csr_array<float>(big);
+  auto w = sil::random({512, 64});
+  CHECK(allclose(spmm(sb, w), big.dot(w)));
+  auto g = sil::random({2000, 64});
+  CHECK(allclose(spmm(sb, g, true), big.transpose().dot(g)));
+  auto v = sil::random({512, 1});
+  auto yv = spmv(sb, array<float>({512}, v.buffer_data()));
+  CHECK(allclose(array<float>({2000, 1}, yv.buffer_data()), big.dot(v)));
+
+  CHECK_THROWS(csr_array<float>(x));
+  CHECK_THROWS(csr_array<float>(2, 2, array<int>{0}, array<int>{2}, array<float>{1}));
+  CHECK_THROWS(spmm(s, dy));
+  CHECK_THROWS(spmv(s, array<float>{1, 2}));
+}
+
+TEST_CASE("data_loader: batches, shuffle and prefetch") {
+  // Row i of x holds 10 * i + column, y holds i
+  size_t n = 103;
+  auto x = array<float>({n, 4}, 0.0f);
+  auto y = array<int>({n}, 0);
+  for (size_t i = 0; i < n; i++) {
+    y.at(i) = static_cast<int>(i);
+    for (size_t c = 0; c < 4; c++) x.at(i * 4 + c) = float(10 * i + c);
+  }
+
+  auto check_epoch = [&](auto &loader, size_t expected_rows) {
+    std::vector<int> seen;
+    size_t batches = 0;
+    while (auto b = loader.next()) {
+      batches++;
+      REQUIRE(b->x.shape()[0] == b->y.shape()[0]);
+      CHECK(b->x.shape()[1] == 4);
+      for (size_t i = 0; i < b->y.shape()[0]; i++) {
+        auto label = b->y.at(i);
+        seen.push_back(label);
+        CHECK(b->x.at(i * 4 + 3) == float(10 * label + 3));
+      }
+    }
+    CHECK(batches == loader.batch_count());
+    CHECK(seen.size() == expected_rows);
+    auto sorted = seen;
+    std::sort(sorted.begin(), sorted.end());
+    CHECK(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    return seen;
+  };
+
+  // In order, with a short last batch
+  auto plain = data_loader(x, y, {.batch_size = 10, .shuffle = false});
+  CHECK(plain.batch_count() == 11);
+  auto order = check_epoch(plain, n);
+  CHECK(order.front() == 0);
+  CHECK(order.back() == 102);
+
+  // Shuffled epochs differ but each covers every full batch exactly once
+  auto shuffled = data_loader(x, y, {.batch_size = 10, .drop_last = true,
+                                     .in_flight = 2, .seed = 1});
+  CHECK(shuffled.batch_count() == 10);
+  auto e1 = check_epoch(shuffled, 100);
+  auto e2 = check_epoch(shuffled, 100);
+  CHECK(e1 != e2);
+
+  // A batch kept past next() keeps its contents; its slot gets new buffers
+  auto kept = std::vector<minibatch<float, int>>();
+  auto loader = data_loader(x, y, {.batch_size = 8, .in_flight = 2});
+  while (auto b = loader.next()) kept.push_back(*b);
+  CHECK(kept.size() == 13);
+  for (auto &b : kept) {
+    for (size_t i = 0; i < b.y.shape()[0]; i++) {
+      CHECK(b.x.at(i * 4) == float(10 * b.y.at(i)));
+    }
+  }
+
+  // A failing fill surfaces from next() on the calling thread
+  auto failing = data_loader<float, int>(
+      n, {4}, [](const size_t *, size_t, float *) {
+        throw std::runtime_error("decode failed");
+      },
+      {}, [](const size_t *, size_t, int *) {});
+  CHECK_THROWS_WITH_AS(failing.next(), "decode failed", std::runtime_error);
+  CHECK_THROWS_WITH_AS(failing.next(), "decode failed", std::runtime_error);
+
+  CHECK_THROWS(data_loader(x, array<int>({5}, 0)));
+  CHECK_THROWS(data_loader(x, y, {.batch_size = 0}));
+}
+
+TEST_CASE("npy: load and save npy/npz") {
+  auto dir = std::filesystem::temp_directory_path();
+  auto path = dir / "sil_npy_test.npy";
+
+  auto a = array<float>({{0, 1.5, 3}, {4.5, 6, 7.5}});
+  save_npy(path, a);
+  auto b = load_npy<float>(path);
+  CHECK(b.shape() == shape_type{2, 3});
+  CHECK(array_equal(a, b));
+
+  // The mapping is copy-on-write
+  b.zeros();
+  CHECK(array_equal(load_npy<float>(path), a));
+
+  // Other element types convert on load
+  CHECK(array_equal(load_npy<int>(path), {{0, 1, 3}, {4, 6, 7}}));
+
+  save_npy(path, array<bool>({true, false, true}));
+  CHECK(array_equal(load_npy<bool>(path), {true, false, true}));
+  save_npy(path, array<int>(7));
+  auto s = load_npy<int>(path);
+  CHECK(s.dimension() == 0);
+  CHECK(s.at(0) == 7);
+
+  // Big-endian float64 in Fortran order, as numpy writes it
+  {
+    auto dict = std::string(
+        "{'descr': '>f8', 'fortran_order': True, 'shape': (2, 3), }");
+    dict.append(63 - (10 + dict.size()) % 64, ' ');
+    dict += '\n';
+    std::ofstream out(path, std::ios::binary);
+    out << std::string("\x93NUMPY\x01\x00", 8) << char(dict.size())
+        << char(dict.size() >> 8) << dict;
+    for (double v : {0, 3, 1, 4, 2, 5}) {
+      auto bits = std::byteswap(std::bit_cast<uint64_t>(v));
+      out.write(reinterpret_cast<const char *>(&bits), sizeof(bits));
+    }
+  }
+  CHECK(array_equal(load_npy<float>(path), {{0, 1, 2}, {3, 4, 5}}));
+
+  // Narrowing conversions throw instead of wrapping
+  auto write_le = [&](const char *descr, auto... values) {
+    auto dict = std::format("{{'descr': '{}', 'fortran_order': False, "
+                            "'shape': ({},), }}", descr, sizeof...(values));
+    dict.append(63 - (10 + dict.size()) % 64, ' ');
+    dict += '\n';
+    std::ofstream out(path, std::ios::binary);
+    out << std::string("\x93NUMPY\x01\x00", 8) << char(dict.size())
+        << char(dict.size() >> 8) << dict;
+    (out.write(reinterpret_cast<const char *>(&values), sizeof(values)), ...);
+  };
+  write_le("<i8", int64_t(-5), int64_t(1) << 31);
+  CHECK_THROWS(load_npy<int>(path));
+  write_le("<i8", int64_t(-5), int64_t(1) << 30);
+  CHECK(array_equal(load_npy<int>(path), {-5, 1 << 30}));
+  write_le("<u8", uint64_t(-1));
+  CHECK_THROWS(load_npy<int>(path));
+  write_le("<f8", 0.1, 1e300);
+  CHECK_THROWS(load_npy<float>(path));
+  CHECK_THROWS(load_npy<int>(path));
+
+  auto archive = dir / "sil_npz_test.npz";
+  save_npz(archive, {{"W1", a}, {"mask", array<bool>({false, true})},
+                     {"step", array<int>({3, 4})}});
+  auto m = load_npz(archive);
+  CHECK(m.size() == 3);
+  CHECK(array_equal(std::get<array<float>>(m["W1"]), a));
+  CHECK(array_equal(std::get<array<bool>>(m["mask"]), {false, true}));
+  CHECK(array_equal(std::get<array<int>>(m["step"]), {3, 4}));
+
+  CHECK_THROWS(load_npz(path));
+  std::filesystem::remove(path);
+  std::filesystem::remove(archive);
+  CHECK_THROWS(load_npy<float>(path));
+}
+
+TEST_CASE("safetensors: weights_writer and weights_file") {
+  auto path = std::filesystem::temp_directory_path() / "sil_weights_test.st";
+  auto w = array<float>({{1, 1.00390625, -2}, {0.5, 3, 1e-3}});
+  auto steps = array<int>({7, -5});
+  {
+    weights_writer out(path,
+                       {{"mask", {2}, "BOOL"},
+                        {"w.bf16", {2, 3}, "BF16"},
+                        {"w.f16", {2, 3}, "F16"},
+                        {"w", {2, 3}},
+                        {"steps", {2}, "I32"}},
+                       {{"epoch", "3"}});
+    out.write("w", w);
+    out.write("w.bf16", w);
+    out.write("w.f16", w);
+    out.write("steps", steps);
+    CHECK_THROWS(out.write("w", steps));
+    CHECK_THROWS(out.write("missing", w));
+    CHECK_THROWS(out.close());
+    out.write("mask", array<bool>({true, false}));
+    out.close();
+  }
+
+  weights_file f(path);
+  CHECK(f.size() == 5);
+  CHECK(f.metadata().at("epoch") == "3");
+  CHECK(f.names() ==
+        std::vector<std::string>{"w", "steps", "w.bf16", "w.f16", "mask"});
+  CHECK(f.dtype("w.bf16") == "BF16");
+  CHECK(f.shape("w") == shape_type{2, 3});
+
+  CHECK(array_equal(f.get("w"), w));
+  CHECK(array_equal(f.get<int>("steps"), {7, -5}));
+  CHECK(array_equal(f.get<bool>("mask"), {true, false}));
+  CHECK(allclose(f.get("w.f16"), w));
+
+  // bfloat16 keeps 8 bits of mantissa, rounding ties to even
+  auto b = f.get("w.bf16");
+  CHECK(b.at(1) == 1.0f);
+  CHECK(b.at(3) == 0.5f);
+  CHECK(allclose(b, w, 1e-2));
+
+  CHECK_THROWS(f.get<int>("w.bf16"));
+  CHECK_THROWS(f.get("missing"));
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("csv: load and save text matrices") {
+  // The second block of the multi-matrix sample file: "W1,784,50" + rows
+  auto w1 = load_csv("sample_weight.csv", {.skip_rows = 3, .max_rows = 784});
+  CHECK(w1.shape() == shape_type{784, 50});
+  CHECK(w1.at(0) == -0.007412489f);
+  CHECK(w1.at(784 * 50 - 1) == -0.040211476f);
+  CHECK_THROWS(load_csv("sample_weight.csv"));  // ragged
+
+  auto path = std::filesystem::temp_directory_path() / "sil_csv_test.csv";
+  array<float> a = random({1000, 7}) * 200.0f - 100.0f;
+  save_csv(path, a);
+  CHECK(array_equal(load_csv(path), a));  // shortest form round-trips
+  CHECK(array_equal(load_csv(path, {.skip_rows = 10, .max_rows = 2}),
+                    a.rows(10, 12)));
+
+  {
+    std::ofstream out(path);
+    out << "1; 2;+3\r\n\n  4;5;6\n7;8;-9";
+  }
+  CHECK(array_equal(load_csv<int>(path, {.delimiter = ';'}),
+                    {{1, 2, 3}, {4, 5, 6}, {7, 8, -9}}));
+
+  save_csv(path, array<int>({3, -1, 4}));
+  CHECK(array_equal(load_csv<int>(path), {{3}, {-1}, {4}}));
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("idx: read, gather and normalizing loader") {
+  auto dir = std::filesystem::temp_directory_path();
+  auto images_path = dir / "sil_idx_test_images";
+  auto labels_path = dir / "sil_idx_test_labels";
+
+  // 50 u8 records of 2 x 3 holding 5 * i + j, and big-endian int32 labels
+  size_t n = 50;
+  auto be32 = [](std::ofstream &out, uint32_t v) {
+    v = std::byteswap(v);
+    out.write(reinterpret_cast<const char *>(&v), 4);
+  };
+  {
+    std::ofstream out(images_path, std::ios::binary);
+    out.write("\0\0\x08\x03", 4);
+    be32(out, n), be32(out, 2), be32(out, 3);
+    for (size_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < 6; j++) out.put(char(5 * i + j));
+    }
+    std::ofstream labels(labels_path, std::ios::binary);
+    labels.write("\0\0\x0C\x01", 4);
+    be32(labels, n);
+    for (size_t i = 0; i < n; i++) be32(labels, uint32_t(i) - 10);
+  }
+
+  idx_file images(images_path), labels(labels_path);
+  CHECK(images.magic() == 0x00000803);
+  CHECK(labels.magic() == 0x00000C01);
+  CHECK(images.shape() == shape_type{50, 2, 3});
+  CHECK(images.record_size() == 6);
+  CHECK(labels.size() == 50);
+
+  auto x = images.read(2, 4, 0.5f, -1.0f);
+  CHECK(x.shape() == shape_type{2, 6});
+  CHECK(x.at(0) == 4.0f);
+  CHECK(x.at(11) == 9.0f);
+  CHECK(array_equal(images.read<int>(49, 50), {{245, 246, 247, 248, 249, 250}}));
+  CHECK(array_equal(labels.read<int>(0, 3), {-10, -9, -8}));
+  CHECK(array_equal(labels.read(9, 11, 2.0f), {-2.0f, 0.0f}));
+
+  size_t rows[] = {7, 0};
+  float out[12];
+  images.gather(rows, 2, out, 2.0f);
+  CHECK(out[0] == 70.0f);
+  CHECK(out[6] == 0.0f);
+
+  auto loader = idx_loader(images, labels, {.batch_size = 16}, 0.5f);
+  size_t seen = 0;
+  while (auto b = loader.next()) {
+    CHECK(b->x.shape()[1] == 6);
+    for (size_t i = 0; i < b->y.shape()[0]; i++, seen++) {
+      auto record = b->y.at(i) + 10;
+      CHECK(b->x.at(i * 6 + 1) == float(5 * record + 1) / 2);
+    }
+  }
+  CHECK(seen == n);
+
+  CHECK_THROWS(images.read(10, 51));
+  CHECK_THROWS(images.read<int>(0, 1, 0.5f));
+  CHECK_THROWS(idx_file("sample_weight.csv"));
+  CHECK_THROWS(idx_loader<int, int>(images, labels, {}, 1.0f / 255));
+  std::filesystem::remove(images_path);
+  std::filesystem::remove(labels_path);
+}
+
+TEST_CASE("checkpoint: async save, copy-on-write capture and restore") {
+  auto path = std::filesystem::temp_directory_path() / "sil_ckpt_test.npz";
+  array<float> w = random({64, 32});
+  auto saved = w.clone();
+  auto step = array<int>({1}, 7);
+
+  // Whether or not the write is still running, the file holds `saved`
+  checkpoint ckpt;
+  ckpt.save(path, {{"w", w}, {"step", step}});
+  CHECK(w.use_count() > 1);
+  w -= array<float>({64, 32}, 1.0f);
+  ckpt.wait();
+  CHECK(!ckpt.pending());
+  CHECK(step.use_count() == 1);
+
+  auto state = load_checkpoint(path);
+  CHECK(array_equal(std::get<array<float>>(state["w"]), saved));
+  CHECK(array_equal(std::get<array<int>>(state["step"]), {7}));
+  CHECK(allclose(w, saved - 1.0f));
+
+  // An in-place update of a captured buffer leaves the captured one alone
+  auto &captures = detail::capture_set::instance();
+  auto alias = w;
+  captures.add(w.buffer_id());
+  w += array<float>({64, 32}, 1.0f);
+  captures.remove(alias.buffer_id());
+  CHECK(w.buffer_id() != alias.buffer_id());
+  CHECK(allclose(alias, saved - 1.0f));
+  CHECK(allclose(w, saved));
+
+  // So does a write through at() or the buffer pointer
+  alias = w;
+  captures.add(w.buffer_id());
+  w.at(0) = -1.0f;
+  w.buffer_data()[1] = -2.0f;
+  captures.remove(alias.buffer_id());
+  CHECK(w.buffer_id() != alias.buffer_id());
+  CHECK(allclose(alias, saved));
+  CHECK(w.at(0) == -1.0f);
+  CHECK(w.at(1) == -2.0f);
+
+  // A flipped payload byte fails the checksum; load_npz doesn't verify
+  {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(1000);  // inside w's payload
+    f.put('x');
+  }
+  CHECK_THROWS(load_checkpoint(path));
+  CHECK(load_npz(path).size() == 2);
+
+  ckpt.save(std::filesystem::temp_directory_path() / "missing" / "x.npz",
+            {{"w", w}});
+  CHECK_THROWS(ckpt.wait());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("interop: DLPack export and import") {
+  array<float> a = random({3, 4});
+  auto *t = to_dlpack(a.transpose());
+  CHECK(t->dl_tensor.device.device_type == kDLCPU);
+  CHECK(t->dl_tensor.dtype.code == kDLFloat);
+  CHECK(t->dl_tensor.ndim == 2);
+  CHECK(t->dl_tensor.shape[0] == 4);
+  CHECK(t->dl_tensor.strides[0] == 1);
+  CHECK(t->dl_tensor.strides[1] == 4);
+  CHECK(t->dl_tensor.data == a.buffer_data());
+  CHECK(a.use_count() == 2);  // the tensor keeps the storage alive
+
+  auto b = from_dlpack(t);
+  CHECK(array_equal(b, a.transpose()));
+  b = array<float>();
+  CHECK(a.use_count() == 1);  // released through the tensor's deleter
+
+  // Foreign column-major int32 memory, released when the array is
+  std::vector<int> v{1, 2, 3, 4, 5, 6};
+  int64_t shape[] = {3, 2}, strides[] = {1, 3};
+  bool freed = false;
+  DLManagedTensor m{{v.data(), {kDLCPU, 0}, 2, {kDLInt, 32, 1}, shape, strides, 0},
+                    &freed,
+                    [](DLManagedTensor *self) {
+                      *static_cast<bool *>(self->manager_ctx) = true;
+                    }};
+  CHECK_THROWS(from_dlpack<float>(&m));
+  CHECK(!freed);
+  {
+    auto x = from_dlpack<int>(&m);
+    CHECK(array_equal(x, {{1, 4}, {2, 5}, {3, 6}}));
+  }
+  CHECK(freed);
+
+  m.dl_tensor.device.device_type = kDLMetal;
+  CHECK_THROWS(from_dlpack<int>(&m));
+}
+
+TEST_CASE("random: philox known answers and reproducibility") {
+  // Random123 known-answer vectors for Philox4x32-10
+  uint32_t c[4] = {0, 0, 0, 0};
+  detail::philox4x32_(c, 0, 0);
+  CHECK(c[0] == 0x6627e8d5);
+  CHECK(c[3] == 0x9b00dbd8);
+  uint32_t d[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+  detail::philox4x32_(d, 0xa4093822, 0x299f31d0);
+  CHECK(d[0] == 0xd16cfe09);
+  CHECK(d[2] == 0x5001e420);
+
+  // Same seed and offset, same values; fills advance the offset
+  philox g1(7), g2(7);
+  auto a = random_normal({1000, 333}, 0.0f, 1.0f, g1);
+  auto b = random_normal({1000, 333}, 0.0f, 1.0f, g2);
+  CHECK(array_equal(a, b));
+  CHECK(g1.offset() == (1000 * 333 + 3) / 4);
+  CHECK(!array_equal(random_normal({1000, 333}, 0.0f, 1.0f, g1), a));
+  CHECK(a.mean() == doctest::Approx(0.0f).epsilon(0.01));
+
+  auto u = random_uniform({100000}, -1.0f, 1.0f, g1);
+  CHECK(u.min() >= -1.0f);
+  CHECK(u.max() < 1.0f);
+
+  auto t = random_truncated_normal({100000}, 0.0f, 1.0f, g1);
+  CHECK(t.min() >= -2.0f);
+  CHECK(t.max() <= 2.0f);
+
+  auto m = random_bernoulli({100000}, 0.25f, g1);
+  CHECK(m.mean() == doctest::Approx(0.25f).epsilon(0.02));
+}
+
+TEST_CASE("random: dropout replays its mask") {
+  philox gen(3);
+  auto x = sil::ones<float>({64, 100});
+  auto offset = gen.offset();
+  auto y = dropout(x, 0.5f, gen);
+
+  CHECK(y.all([](float v) { return v == 0.0f || v == 2.0f; }));
+  auto kept = y.count();
+  CHECK(kept > 2800);
+  CHECK(kept < 3600);
+
+  // Backward: the same offset reproduces the mask on dout
+  gen.set_offset(offset);
+  auto dx = dropout(sil::ones<float>({64, 100}) * 3.0f, 0.5f, gen);
+  CHECK(array_equal(dx, y * 3.0f));
+
+  CHECK(array_equal(dropout(x, 0.0f, gen), x));
+  CHECK(dropout(x, 1.0f, gen).all(0.0f));
+  CHECK_THROWS(dropout(x, 1.5f, gen));
+}
+
+TEST_CASE("array: unary math ops and backward") {
+  auto x = array<float>{-2.0f, -0.5f, 0.0f, 0.75f, 3.0f};
+  auto p = array<float>{0.25f, 1.0f, 2.0f, 9.0f, 100.0f};
+  auto dout = array<float>{1.0f, -2.0f, 0.5f, 3.0f, 1.5f};
+
+  struct unary_case {
+    const char *name;
+    const array<float> &in;
+    std::function<array<float>(const array<float> &)> fwd;
+    std::function<array<float>(const array<float> &, const array<float> &)> bwd;
+    std::function<float(float)> ref;
+  };
+  auto gelu = [](float v) {
+    return 0.5f * v * (1.0f + std::tanh(0.7978845608f * (v + 0.044715f * v * v * v)));
+  };
+  unary_case cases[] = {
+      {"exp", x, [](auto &a) { return a.exp(); },
+       [](auto &a, auto &g) { return a.exp_backward(g); },
+       [](float v) { return std::exp(v); }},
+      {"log", p, [](auto &a) { return a.log(); },
+       [](auto &a, auto &g) { return a.log_backward(g); },
+       [](float v) { return std::log(v); }},
+      {"tanh", x, [](auto &a) { return a.tanh(); },
+       [](auto &a, auto &g) { return a.tanh_backward(g); },
+       [](float v) { return std::tanh(v); }},
+      {"gelu", x, [](auto &a) { return a.gelu(); },
+       [](auto &a, auto &g) { return a.gelu_backward(g); }, gelu},
+      {"silu", x, [](auto &a) { return a.silu(); },
+       [](auto &a, auto &g) { return a.silu_backward(g); },
+       [](float v) { return v / (1.0f + std::exp(-v)); }},
+      {"sqrt", p, [](auto &a) { return a.sqrt(); },
+       [](auto &a, auto &g) { return a.sqrt_backward(g); },
+       [](float v) { return std::sqrt(v); }},
+      {"rsqrt", p, [](auto &a) { return a.rsqrt(); },
+       [](auto &a, auto &g) { return a.rsqrt_backward(g); },
+       [](float v) { return 1.0f / std::sqrt(v); }},
+      {"abs", x, [](auto &a) { return a.abs(); },
+       [](auto &a, auto &g) { return a.abs_backward(g); },
+       [](float v) { return std::fabs(v); }},
+      {"clamp", x, [](auto &a) { return a.clamp(-1.0f, 1.0f); },
+       [](auto &a, auto &g) { return a.clamp_backward(g, -1.0f, 1.0f); },
+       [](float v) { return std::clamp(v, -1.0f, 1.0f); }},
+  };
+
+  for (auto &c : cases) {
+    CAPTURE(c.name);
+    auto y = c.fwd(c.in);
+    auto dx = c.bwd(c.in, dout);
+    REQUIRE(y.shape() == c.in.shape());
+    REQUIRE(dx.shape() == c.in.shape());
+    for (size_t i = 0; i < c.in.element_count(); i++) {
+      auto v = c.in.at(i);
+      CHECK(y.at(i) == doctest::Approx(c.ref(v)).epsilon(1e-5));
+
+      // Central difference (abs is smooth enough away from 0, and at 0
+      // both sides agree on the subgradient 0)
+      auto h = 1e-3f * std::max(1.0f, std::fabs(v));
+      auto slope = (c.ref(v + h) - c.ref(v - h)) / (2.0f * h);
+      CHECK(dx.at(i) == doctest::Approx(dout.at(i) * slope).epsilon(1e-2));
+    }
+  }
+
+  CHECK_THROWS(x.clamp(1.0f, -1.0f));
+  CHECK_THROWS(x.exp_backward(p.rows(0, 2)));
+
+  // Integer input promotes to float
+  auto ints = array<int>{-3, 0, 4};
+  CHECK(array_equal(ints.abs(), array<float>{3.0f, 0.0f, 4.0f}));
+}
+
+TEST_CASE("array: unary ops fuse with scalar arithmetic") {
+  auto x = sil::random({33, 17}) - 0.5f;
+  auto ref = [&](auto f) {
+    auto out = x.clone();
+    for (size_t i = 0; i < out.element_count(); i++) out.at(i) = f(x.at(i));
+    return out;
+  };
+
+  // Prologue and epilogue around one op
+  auto y = (x * 3.0f + 0.5f).tanh() * 2.0f - 1.0f;
+  CHECK(allclose(y, ref([](float v) { return std::tanh(v * 3.0f + 0.5f) * 2.0f - 1.0f; }),
+                 1e-5f));
+
+  // Chained unary ops and a vector operand break the chain but stay correct
+  auto z = (x.exp() + 1.0f).log() * x.silu();
+  CHECK(allclose(z, ref([](float v) {
+                   return std::log(std::exp(v) + 1.0f) * v / (1.0f + std::exp(-v));
+                 }),
+                 1e-5f));
+
+  // The input stays usable and unchanged; lazy results can be reused
+  auto g = x.gelu();
+  auto g2 = g * 2.0f;
+  CHECK(allclose(g2, g + g, 1e-6f));
+
+  // Non-contiguous input
+  auto t = x.transpose().abs();
+  CHECK(t.shape() == shape_type{17, 33});
+  CHECK(t.at({4, 7}) == std::fabs(x.at({7, 4})));
+}